@@ -1,24 +1,11 @@
+#include <chrono>
 #include <iostream>
-#include <fstream>
+#include <random>
 #include <string>
 
 #include <libslic3r/TriangleMesh.hpp>
 #include <libslic3r/AABBTreeIndirect.hpp>
-#include <libslic3r/SLA/EigenMesh3D.hpp>
-
-#ifdef _MSC_VER
-#pragma warning(push)
-#pragma warning(disable: 4244)
-#pragma warning(disable: 4267)
-#endif
-#include <igl/ray_mesh_intersect.h>
-#include <igl/point_mesh_squared_distance.h>
-#include <igl/remove_duplicate_vertices.h>
-#include <igl/signed_distance.h>
-#include <igl/random_dir.h>
-#ifdef _MSC_VER
-#pragma warning(pop)
-#endif
+#include <libslic3r/AABBTreeIndirectWide.hpp>
 
 const std::string USAGE_STR = {
     "Usage: aabb-evaluation stlfilename.stl"
@@ -26,141 +13,101 @@ const std::string USAGE_STR = {
 
 using namespace Slic3r;
 
-void profile(const TriangleMesh &mesh)
+template<typename Fn>
+static double measure_seconds(Fn &&fn)
 {
-    Eigen::MatrixXd V;
-    Eigen::MatrixXi F;
-    Eigen::MatrixXd vertex_normals;
-    sla::to_eigen_mesh(mesh, V, F);
-    igl::per_vertex_normals(V, F, vertex_normals);
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
 
-    static constexpr int num_samples = 100;
-    const int num_vertices = std::min(10000, int(mesh.its.vertices.size()));
-    const Eigen::MatrixXd dirs = igl::random_dir_stratified(num_samples).cast<double>();
-
-    Eigen::MatrixXd occlusion_output0;
-    {
-        AABBTreeIndirect::Tree3f tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(mesh.its.vertices, mesh.its.indices);
-        occlusion_output0.resize(num_vertices, 1);
-        for (int ivertex = 0; ivertex < num_vertices; ++ ivertex) {
-            const Eigen::Vector3d origin = mesh.its.vertices[ivertex].template cast<double>();
-            const Eigen::Vector3d normal = vertex_normals.row(ivertex).template cast<double>();
-            int num_hits = 0;
-            for (int s = 0; s < num_samples; s++) {
-                Eigen::Vector3d d = dirs.row(s);
-                if(d.dot(normal) < 0) {
-                    // reverse ray
-                    d *= -1;
-                }
-                igl::Hit hit;
-                if (AABBTreeIndirect::intersect_ray_first_hit(mesh.its.vertices, mesh.its.indices, tree, (origin + 1e-4 * d).eval(), d, hit))
-                    ++ num_hits;
-            }
-            occlusion_output0(ivertex) = (double)num_hits/(double)num_samples;
-        }
-        occlusion_output0.resize(num_vertices, 1);
-        for (int ivertex = 0; ivertex < num_vertices; ++ ivertex) {
-            const Eigen::Vector3d origin = mesh.its.vertices[ivertex].template cast<double>();
-            const Eigen::Vector3d normal = vertex_normals.row(ivertex).template cast<double>();
-            int num_hits = 0;
-            for (int s = 0; s < num_samples; s++) {
-                Eigen::Vector3d d = dirs.row(s);
-                if(d.dot(normal) < 0) {
-                    // reverse ray
-                    d *= -1;
-                }
-                igl::Hit hit;
-                if (AABBTreeIndirect::intersect_ray_first_hit(mesh.its.vertices, mesh.its.indices, tree, 
-                        Eigen::Vector3f((origin + 1e-4 * d).template cast<float>()),
-                        Eigen::Vector3f(d.template cast<float>()), hit))
-                    ++ num_hits;
-            }
-            occlusion_output0(ivertex) = (double)num_hits/(double)num_samples;
-        }
-    }
+// Ambient occlusion like workload: rays shot from the mesh vertices into the half space of the vertex normal,
+// followed by closest point queries from random points around the mesh. The binary Tree3f is compared
+// against the 4-wide WideTree3f, reporting the build times, query rates and whether the two trees agree.
+void profile(const TriangleMesh &mesh)
+{
+    const indexed_triangle_set &its = mesh.its;
 
-    Eigen::MatrixXd occlusion_output1;
-    {
-        std::vector<Vec3d> vertices;
-        std::vector<Vec3i> triangles;
-        for (int i = 0; i < V.rows(); ++ i)
-            vertices.emplace_back(V.row(i).transpose());
-        for (int i = 0; i < F.rows(); ++ i)
-            triangles.emplace_back(F.row(i).transpose());
-        AABBTreeIndirect::Tree3d tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(vertices, triangles);
-        occlusion_output1.resize(num_vertices, 1);
-        for (int ivertex = 0; ivertex < num_vertices; ++ ivertex) {
-            const Eigen::Vector3d origin = V.row(ivertex).template cast<double>();
-            const Eigen::Vector3d normal = vertex_normals.row(ivertex).template cast<double>();
-            int num_hits = 0;
-            for (int s = 0; s < num_samples; s++) {
-                Eigen::Vector3d d = dirs.row(s);
-                if(d.dot(normal) < 0) {
-                    // reverse ray
-                    d *= -1;
-                }
-                igl::Hit hit;
-                if (AABBTreeIndirect::intersect_ray_first_hit(vertices, triangles, tree, Eigen::Vector3d(origin + 1e-4 * d), d, hit))
-                    ++ num_hits;
-            }
-            occlusion_output1(ivertex) = (double)num_hits/(double)num_samples;
-        }
+    std::vector<Vec3d> vertex_normals(its.vertices.size(), Vec3d::Zero());
+    for (const stl_triangle_vertex_indices &face : its.indices) {
+        Vec3d n = its_face_normal(its, face).cast<double>();
+        for (int i = 0; i < 3; ++ i)
+            vertex_normals[face(i)] += n;
     }
 
-    // Build the AABB accelaration tree
-
-    Eigen::MatrixXd occlusion_output2;
-    {
-        igl::AABB<Eigen::MatrixXd, 3> AABB;
-        AABB.init(V, F);
-        occlusion_output2.resize(num_vertices, 1);
-        for (int ivertex = 0; ivertex < num_vertices; ++ ivertex) {
-            const Eigen::Vector3d origin = V.row(ivertex).template cast<double>();
-            const Eigen::Vector3d normal = vertex_normals.row(ivertex).template cast<double>();
-            int num_hits = 0;
-            for (int s = 0; s < num_samples; s++) {
-                Eigen::Vector3d d = dirs.row(s);
-                if(d.dot(normal) < 0) {
-                    // reverse ray
-                    d *= -1;
-                }
-                igl::Hit hit;
-                if (AABB.intersect_ray(V, F, origin + 1e-4 * d, d, hit))
-                    ++ num_hits;
-            }
-            occlusion_output2(ivertex) = (double)num_hits/(double)num_samples;
+    static constexpr int num_samples = 100;
+    const int num_vertices = std::min(10000, int(its.vertices.size()));
+
+    std::mt19937 rng(0);
+    std::normal_distribution<double> normal;
+    std::vector<Vec3d> dirs(num_samples);
+    for (Vec3d &d : dirs)
+        d = Vec3d(normal(rng), normal(rng), normal(rng)).normalized();
+
+    std::vector<Vec3d> origins, directions;
+    origins.reserve(num_vertices * num_samples);
+    directions.reserve(num_vertices * num_samples);
+    for (int ivertex = 0; ivertex < num_vertices; ++ ivertex)
+        for (Vec3d d : dirs) {
+            if (d.dot(vertex_normals[ivertex]) < 0)
+                // reverse ray
+                d *= -1;
+            origins.emplace_back(its.vertices[ivertex].cast<double>() + 1e-4 * d);
+            directions.emplace_back(d);
         }
-    }
 
-    Eigen::MatrixXd occlusion_output3;
-    {
-        typedef Eigen::Map<const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor | Eigen::DontAlign>> MapMatrixXfUnaligned;
-        typedef Eigen::Map<const Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor | Eigen::DontAlign>> MapMatrixXiUnaligned;
-        igl::AABB<MapMatrixXfUnaligned, 3> AABB;
-        auto vertices = MapMatrixXfUnaligned(mesh.its.vertices.front().data(), mesh.its.vertices.size(), 3);
-        auto faces = MapMatrixXiUnaligned(mesh.its.indices.front().data(), mesh.its.indices.size(), 3);
-        AABB.init(
-            vertices,
-            faces);
-
-        occlusion_output3.resize(num_vertices, 1);
-        for (int ivertex = 0; ivertex < num_vertices; ++ ivertex) {
-            const Eigen::Vector3d origin = mesh.its.vertices[ivertex].template cast<double>();
-            const Eigen::Vector3d normal = vertex_normals.row(ivertex).template cast<double>();
-            int num_hits = 0;
-            for (int s = 0; s < num_samples; s++) {
-                Eigen::Vector3d d = dirs.row(s);
-                if(d.dot(normal) < 0) {
-                    // reverse ray
-                    d *= -1;
-                }
-                igl::Hit hit;
-                if (AABB.intersect_ray(vertices, faces, (origin + 1e-4 * d).eval().template cast<float>(), d.template cast<float>(), hit))
-                    ++ num_hits;
+    const BoundingBoxf3 bb = bounding_box(its);
+    std::vector<Vec3d> points(100000);
+    for (Vec3d &pt : points)
+        for (int i = 0; i < 3; ++ i)
+            pt(i) = std::uniform_real_distribution<double>(bb.min(i) - bb.size()(i), bb.max(i) + bb.size()(i))(rng);
+
+    AABBTreeIndirect::Tree3f     tree;
+    AABBTreeIndirect::WideTree3f wtree;
+    double t_build  = measure_seconds([&]() { tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(its.vertices, its.indices); });
+    double t_wbuild = measure_seconds([&]() { wtree = AABBTreeIndirect::build_wide_aabb_tree_over_indexed_triangle_set(its.vertices, its.indices); });
+
+    auto shoot = [&](const auto &t, std::vector<igl::Hit> &hits) {
+        hits.assign(origins.size(), igl::Hit{ -1, -1, 0.f, 0.f, -1.f });
+        return measure_seconds([&]() {
+            for (size_t i = 0; i < origins.size(); ++ i)
+                AABBTreeIndirect::intersect_ray_first_hit(its.vertices, its.indices, t, origins[i], directions[i], hits[i]);
+        });
+    };
+    std::vector<igl::Hit> hits, whits;
+    double t_rays  = shoot(tree, hits);
+    double t_wrays = shoot(wtree, whits);
+
+    auto distances = [&](const auto &t, std::vector<double> &dist) {
+        dist.assign(points.size(), 0.);
+        return measure_seconds([&]() {
+            for (size_t i = 0; i < points.size(); ++ i) {
+                size_t idx;
+                Vec3d  closest;
+                dist[i] = AABBTreeIndirect::squared_distance_to_indexed_triangle_set(its.vertices, its.indices, t, points[i], idx, closest);
             }
-            occlusion_output3(ivertex) = (double)num_hits/(double)num_samples;
-        }
+        });
+    };
+    std::vector<double> dist, wdist;
+    double t_dist  = distances(tree, dist);
+    double t_wdist = distances(wtree, wdist);
+
+    size_t ray_mismatches = 0, dist_mismatches = 0, num_hits = 0;
+    for (size_t i = 0; i < hits.size(); ++ i) {
+        num_hits += hits[i].id >= 0;
+        if ((hits[i].id >= 0) != (whits[i].id >= 0) || std::abs(hits[i].t - whits[i].t) > 1e-5f * std::max(1.f, hits[i].t))
+            ++ ray_mismatches;
     }
+    for (size_t i = 0; i < dist.size(); ++ i)
+        if (std::abs(dist[i] - wdist[i]) > 1e-6 * std::max(1., dist[i]))
+            ++ dist_mismatches;
+
+    std::cout << "Triangles: " << its.indices.size() << ", rays: " << origins.size() << " (" << num_hits << " hits), closest point queries: " << points.size() << std::endl;
+    std::cout << "Tree3f     build " << t_build  << " s, " << origins.size() / t_rays  * 1e-6 << " Mrays/s, " << points.size() / t_dist  * 1e-6 << " Mqueries/s" << std::endl;
+    std::cout << "WideTree3f build " << t_wbuild << " s, " << origins.size() / t_wrays * 1e-6 << " Mrays/s, " << points.size() / t_wdist * 1e-6 << " Mqueries/s, "
+              << wtree.nodes().size() << " nodes" << std::endl;
+    std::cout << "Speedup: rays " << t_rays / t_wrays << "x, closest point " << t_dist / t_wdist << "x" << std::endl;
+    std::cout << "Mismatches: rays " << ray_mismatches << ", closest point " << dist_mismatches << std::endl;
 }
 
 int main(const int argc, const char *argv[])
@@ -181,7 +128,7 @@ int main(const int argc, const char *argv[])
         return -1;
     }
 
-    profile(mesh);    
+    profile(mesh);
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,63 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <libslic3r/ExPolygon.hpp>
+#include <libslic3r/PrintConfig.hpp>
+#include <libslic3r/Arachne/WallToolPaths.hpp>
+
+const std::string USAGE_STR = {
+    "Usage: arachne_islands_benchmark [islands_per_side]"
+};
+
+using namespace Slic3r;
+
+// A layer of many small islands, as printed when many small objects are on the bed: 5 x 5 mm squares
+// with a 2 x 2 mm hole on an 8 mm grid. Times the generation of three Arachne perimeters.
+void profile(int islands_per_side)
+{
+    ExPolygon island;
+    island.contour = Polygon::new_scale({ { 0., 0. }, { 5., 0. }, { 5., 5. }, { 0., 5. } });
+    island.holes.emplace_back(Polygon::new_scale({ { 1.5, 1.5 }, { 1.5, 3.5 }, { 3.5, 3.5 }, { 3.5, 1.5 } }));
+
+    ExPolygons islands;
+    for (int i = 0; i < islands_per_side; ++ i)
+        for (int j = 0; j < islands_per_side; ++ j) {
+            islands.emplace_back(island);
+            islands.back().translate(scaled<coord_t>(i * 8.), scaled<coord_t>(j * 8.));
+        }
+
+    const coord_t spacing     = 407079;
+    const coord_t inset_count = 3;
+
+    // WallToolPaths keeps a reference to the outline.
+    const Polygons polygons = to_polygons(islands);
+
+    auto start = std::chrono::steady_clock::now();
+    Arachne::WallToolPaths wall_tool_paths(polygons, spacing, spacing, inset_count, 0, 0.2, PrintObjectConfig::defaults(), PrintConfig::defaults());
+    const std::vector<Arachne::VariableWidthLines> &perimeters = wall_tool_paths.getToolPaths();
+    const double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t num_lines = 0;
+    for (const Arachne::VariableWidthLines &lines : perimeters)
+        num_lines += lines.size();
+
+    std::cout << "WallToolPaths of " << islands.size() << " islands: " << num_lines << " extrusions, " << t << " s" << std::endl;
+}
+
+int main(const int argc, const char *argv[])
+{
+    int islands_per_side = 40;
+    if (argc > 1) {
+        try {
+            islands_per_side = std::stoi(argv[1]);
+        } catch (const std::exception &) {
+            std::cout << USAGE_STR << std::endl;
+            return -1;
+        }
+    }
+
+    profile(islands_per_side);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,104 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include <libslic3r/Model.hpp>
+#include <libslic3r/Arrange/Arrange.hpp>
+#include <libslic3r/Arrange/Items/ArrangeItem.hpp>
+#include <libslic3r/Arrange/Tasks/ArrangeTask.hpp>
+#include <libslic3r/Arrange/Tasks/FillBedTask.hpp>
+#include <libslic3r/Arrange/SceneBuilder.hpp>
+
+const std::string USAGE_STR = {
+    "Usage: arrange_benchmark [cube_count]"
+};
+
+using namespace Slic3r;
+
+template<typename Fn>
+static double measure_seconds(Fn &&fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Arranges instances of a 20 mm cube scattered randomly around the plane on a 500 x 500 mm bed, with rotations enabled.
+void arrange_cubes(size_t cube_count)
+{
+    Model model;
+    ModelObject *object = model.add_object();
+    object->name = "20mm_cube";
+    object->add_volume(make_cube(20., 20., 20.))->name = object->name;
+
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> coord(-arr2::UnscaledCoordLimit / 10., arr2::UnscaledCoordLimit / 10.);
+    std::uniform_real_distribution<double> angle(0., 2 * PI);
+    for (size_t i = 0; i < cube_count; ++ i)
+        arr2::transform_instance(*object->add_instance(), Vec2d{ coord(rng), coord(rng) }, angle(rng));
+
+    arr2::ArrangeSettings settings;
+    settings.set_rotation_enabled(true);
+
+    arr2::Scene scene{arr2::SceneBuilder{}
+                          .set_model(model)
+                          .set_arrange_settings(settings)
+                          .set_bed(arr2::RectangleBed{scaled(500.), scaled(500.)})};
+
+    std::unique_ptr<arr2::ArrangeTaskResult> result;
+    double t = measure_seconds([&scene, &result]() {
+        auto task = arr2::ArrangeTask<arr2::ArrangeItem>::create(scene);
+        result    = task->process_native(arr2::DummyCtl{});
+    });
+
+    std::cout << "ArrangeTask of " << result->items.size() << " items: " << t << " s" << std::endl;
+}
+
+// Fills a 250 x 250 mm bed with copies of a 10 mm cube.
+void fill_bed()
+{
+    Model model;
+    ModelObject *object = model.add_object();
+    object->name = "10mm_box";
+    object->add_instance();
+    object->add_volume(make_cube(10., 10., 10.))->name = object->name;
+
+    arr2::ArrangeSettings settings;
+    settings.values().d_obj = 2.;
+    settings.values().d_bed = 0.;
+
+    arr2::FixedSelection sel({{true}});
+
+    arr2::Scene scene{arr2::SceneBuilder{}
+                          .set_model(model)
+                          .set_arrange_settings(settings)
+                          .set_selection(&sel)
+                          .set_bed(arr2::RectangleBed{scaled(250.), scaled(250.)})};
+
+    std::unique_ptr<arr2::FillBedTaskResult> result;
+    double t = measure_seconds([&scene, &result]() {
+        auto task = arr2::FillBedTask<arr2::ArrangeItem>::create(scene);
+        result    = task->process_native(arr2::DummyCtl{});
+    });
+
+    std::cout << "FillBedTask of " << result->to_add.size() + result->arranged_items.size() << " items: " << t << " s" << std::endl;
+}
+
+int main(const int argc, const char *argv[])
+{
+    size_t cube_count = 400;
+    if (argc > 1) {
+        try {
+            cube_count = std::stoul(argv[1]);
+        } catch (const std::exception &) {
+            std::cout << USAGE_STR << std::endl;
+            return -1;
+        }
+    }
+
+    arrange_cubes(cube_count);
+    fill_bed();
+
+    return EXIT_SUCCESS;
+}
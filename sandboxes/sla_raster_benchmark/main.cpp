@@ -0,0 +1,74 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <libslic3r/Model.hpp>
+#include <libslic3r/MTUtils.hpp>
+#include <libslic3r/TriangleMeshSlicer.hpp>
+#include <libslic3r/Execution/ExecutionTBB.hpp>
+#include <libslic3r/SLA/RasterBase.hpp>
+
+const std::string USAGE_STR = {
+    "Usage: sla_raster_benchmark modelfile1 [modelfile2 ...]"
+};
+
+using namespace Slic3r;
+
+// Slices the models by 0.05 mm and rasterizes all the layers for a mono LCD printer with 9K resolution,
+// once by the AGG rasterizer and once by the scanline coverage rasterizer, including the PPM encoding.
+void profile(const std::string &fname, TriangleMesh mesh)
+{
+    const sla::Resolution res{8520, 5320};
+    const sla::PixelDim   pixdim{196.0 / res.width_px, 122.5 / res.height_px};
+    sla::RasterBase::Trafo trafo;
+    trafo.center_x = scaled(98.);
+    trafo.center_y = scaled(61.25);
+
+    mesh.translate(-mesh.bounding_box().center().cast<float>());
+    const BoundingBoxf3 bb = mesh.bounding_box();
+    const std::vector<float> heights = grid(float(bb.min.z()), float(bb.max.z()), 0.05f);
+    const std::vector<ExPolygons> slices = slice_mesh_ex(mesh.its, heights, 0.005f);
+
+    auto rasterize_all = [&slices](auto &&create_raster) {
+        auto start = std::chrono::steady_clock::now();
+        execution::for_each(ex_tbb, size_t(0), slices.size(), [&](size_t idx) {
+            std::unique_ptr<sla::RasterBase> rst = create_raster();
+            for (const ExPolygon &poly : slices[idx])
+                rst->draw(poly);
+            rst->encode(sla::PPMRasterEncoder{});
+        });
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    const double t_agg      = rasterize_all([&]() { return sla::create_raster_grayscale_aa(res, pixdim, 1., trafo); });
+    const double t_scanline = rasterize_all([&]() { return sla::create_raster_grayscale_scanline(res, pixdim, 1., trafo, 4); });
+
+    std::cout << fname << ": " << slices.size() << " layers, AGG: " << t_agg << " s, scanline: " << t_scanline << " s" << std::endl;
+}
+
+int main(const int argc, const char *argv[])
+{
+    if (argc < 2) {
+        std::cout << USAGE_STR << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    for (int i = 1; i < argc; ++ i) {
+        TriangleMesh mesh;
+        try {
+            mesh = Model::read_from_file(argv[i]).mesh();
+        } catch (const std::exception &ex) {
+            std::cerr << "Error loading " << argv[i] << ": " << ex.what() << std::endl;
+            return -1;
+        }
+
+        if (mesh.empty()) {
+            std::cerr << "Error loading " << argv[i] << " . It is empty." << std::endl;
+            return -1;
+        }
+
+        profile(argv[i], std::move(mesh));
+    }
+
+    return EXIT_SUCCESS;
+}
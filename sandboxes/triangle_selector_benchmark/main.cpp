@@ -0,0 +1,72 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <libslic3r/Model.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/TriangleSelector.hpp>
+
+const std::string USAGE_STR = {
+    "Usage: triangle_selector_benchmark [stlfilename.stl]"
+};
+
+using namespace Slic3r;
+
+template<typename Fn>
+static double measure_ms(Fn &&fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Paints a brush stroke on every 97th triangle of the mesh, cycling through enforcers, blockers and an extruder,
+// then times the serialization and the export of the painted facets.
+void profile(const TriangleMesh &mesh)
+{
+    TriangleSelector selector(mesh);
+    const EnforcerBlockerType states[] { EnforcerBlockerType::ENFORCER, EnforcerBlockerType::BLOCKER, EnforcerBlockerType::Extruder3 };
+    const float radius = 0.03f * float(mesh.bounding_box().max_size());
+    int istate = 0;
+    for (int facet_idx = 0; facet_idx < int(mesh.its.indices.size()); facet_idx += 97, ++ istate) {
+        const stl_triangle_vertex_indices &f = mesh.its.indices[facet_idx];
+        const Vec3f center = (mesh.its.vertices[f(0)] + mesh.its.vertices[f(1)] + mesh.its.vertices[f(2)]) / 3.f;
+        const Vec3f normal = its_face_normal(mesh.its, facet_idx);
+        selector.select_patch(facet_idx, std::make_unique<TriangleSelector::Sphere>(center, center + normal, radius, Transform3d::Identity(), TriangleSelector::ClippingPlane{}),
+            states[istate % 3], Transform3d::Identity(), true);
+    }
+
+    std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> data;
+    indexed_triangle_set facets, facets_strict;
+    const double t_serialize     = measure_ms([&selector, &data]() { data = selector.serialize(); });
+    const double t_deserialize   = measure_ms([&mesh, &data]() { TriangleSelector deserialized(mesh); deserialized.deserialize(data); });
+    const double t_facets        = measure_ms([&selector, &facets]() { facets = selector.get_facets(EnforcerBlockerType::ENFORCER); });
+    const double t_facets_strict = measure_ms([&selector, &facets_strict]() { facets_strict = selector.get_facets_strict(EnforcerBlockerType::ENFORCER); });
+
+    std::cout << "TriangleSelector of " << mesh.its.indices.size() << " triangles, serialized to " << data.first.size() << " pairs and "
+              << data.second.size() << " bits, " << facets.indices.size() << " enforcer facets" << std::endl
+              << "serialize " << t_serialize << " ms, deserialize " << t_deserialize << " ms, get_facets " << t_facets
+              << " ms, get_facets_strict " << t_facets_strict << " ms" << std::endl;
+}
+
+int main(const int argc, const char *argv[])
+{
+    TriangleMesh mesh;
+    if (argc < 2) {
+        // 81920 triangles.
+        mesh = make_sphere(50., 2. * PI / 240.);
+    } else if (! mesh.ReadSTLFile(argv[1])) {
+        std::cerr << "Error loading " << argv[1] << std::endl;
+        std::cout << USAGE_STR << std::endl;
+        return -1;
+    }
+
+    if (mesh.empty()) {
+        std::cerr << "Error loading " << argv[1] << " . It is empty." << std::endl;
+        return -1;
+    }
+
+    profile(mesh);
+
+    return EXIT_SUCCESS;
+}
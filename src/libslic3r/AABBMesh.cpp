@@ -5,6 +5,7 @@
 #include "AABBMesh.hpp"
 #include <Execution/ExecutionTBB.hpp>
 
+#include <libslic3r/AABBTreeCache.hpp>
 #include <libslic3r/AABBTreeIndirect.hpp>
 #include <libslic3r/TriangleMesh.hpp>
 
@@ -18,11 +19,13 @@ namespace Slic3r {
 
 class AABBMesh::AABBImpl {
 private:
-    AABBTreeIndirect::Tree3f m_tree;
-    double                   m_triangle_ray_epsilon;
+    // Immutable, thus shared by the copies of AABBMesh and possibly by other users of AABBTreeCache.
+    std::shared_ptr<const AABBTreeIndirect::Tree3f> m_tree;
+    double                                          m_triangle_ray_epsilon;
 
 public:
-    void init(const indexed_triangle_set &its, bool calculate_epsilon)
+    void init(const indexed_triangle_set &its, bool calculate_epsilon,
+              std::shared_ptr<const AABBTreeIndirect::Tree3f> tree = {})
     {
         m_triangle_ray_epsilon = 0.000001;
         if (calculate_epsilon) {
@@ -31,8 +34,10 @@ public:
             if (l > 0)
                 m_triangle_ray_epsilon = 0.000001 * l * l;
         }
-        m_tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(
-            its.vertices, its.indices);
+        m_tree = tree ? std::move(tree) :
+                        std::make_shared<const AABBTreeIndirect::Tree3f>(
+                            AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(
+                                its.vertices, its.indices));
     }
 
     void intersect_ray(const indexed_triangle_set &its,
@@ -41,7 +46,16 @@ public:
                        igl::Hit &                  hit)
     {
         AABBTreeIndirect::intersect_ray_first_hit(its.vertices, its.indices,
-                                                  m_tree, s, dir, hit, m_triangle_ray_epsilon);
+                                                  *m_tree, s, dir, hit, m_triangle_ray_epsilon);
+    }
+
+    void intersect_ray_packet(const indexed_triangle_set &        its,
+                              const AABBMesh::RayPacketPoints &   s,
+                              const AABBMesh::RayPacketPoints &   dir,
+                              std::array<igl::Hit, AABBMesh::RayPacketSize> &hits)
+    {
+        AABBTreeIndirect::intersect_ray_packet_first_hit(its.vertices, its.indices,
+                                                         *m_tree, s, dir, hits, m_triangle_ray_epsilon);
     }
 
     void intersect_ray(const indexed_triangle_set &its,
@@ -50,7 +64,7 @@ public:
                        std::vector<igl::Hit> &     hits)
     {
         AABBTreeIndirect::intersect_ray_all_hits(its.vertices, its.indices,
-                                                 m_tree, s, dir, hits, m_triangle_ray_epsilon);
+                                                 *m_tree, s, dir, hits, m_triangle_ray_epsilon);
     }
 
     double squared_distance(const indexed_triangle_set & its,
@@ -62,7 +76,7 @@ public:
         Vec3d  closest_vec3d(closest);
         double dist =
             AABBTreeIndirect::squared_distance_to_indexed_triangle_set(
-                its.vertices, its.indices, m_tree, point, idx_unsigned,
+                its.vertices, its.indices, *m_tree, point, idx_unsigned,
                 closest_vec3d);
         i       = int(idx_unsigned);
         closest = closest_vec3d;
@@ -94,6 +108,24 @@ AABBMesh::AABBMesh(const TriangleMesh &mesh, bool calculate_epsilon)
     init(mesh, calculate_epsilon);
 }
 
+AABBMesh::AABBMesh(const std::shared_ptr<const TriangleMesh> &mesh, bool calculate_epsilon)
+    : m_tm(&mesh->its)
+    , m_aabb(new AABBImpl())
+    , m_vfidx{mesh->its}
+    , m_fnidx{its_face_neighbors(mesh->its)}
+{
+    m_aabb->init(*m_tm, calculate_epsilon, AABBTreeCache::tree(mesh));
+}
+
+AABBMesh::AABBMesh(const std::shared_ptr<const indexed_triangle_set> &its, bool calculate_epsilon)
+    : m_tm(its.get())
+    , m_aabb(new AABBImpl())
+    , m_vfidx{*its}
+    , m_fnidx{its_face_neighbors(*its)}
+{
+    m_aabb->init(*m_tm, calculate_epsilon, AABBTreeCache::tree(its));
+}
+
 AABBMesh::~AABBMesh() {}
 
 AABBMesh::AABBMesh(const AABBMesh &other)
@@ -181,6 +213,50 @@ AABBMesh::query_ray_hit(const Vec3d &s, const Vec3d &dir) const
     return ret;
 }
 
+AABBMesh::RayPacketHits
+AABBMesh::query_ray_hit_packet(const RayPacketPoints &sources,
+                               const RayPacketPoints &dirs,
+                               size_t                 count) const
+{
+    assert(count > 0 && count <= RayPacketSize);
+
+#ifdef SLIC3R_HOLE_RAYCASTER
+    if (! m_holes.empty()) {
+        RayPacketHits out;
+        for (size_t i = 0; i < count; ++ i)
+            out[i] = query_ray_hit(sources[i], dirs[i]);
+        return out;
+    }
+#endif
+
+    // Fill the unused slots with copies of the first ray, which follow its
+    // path through the tree and thus cost next to nothing.
+    RayPacketPoints s = sources, d = dirs;
+    for (size_t i = count; i < RayPacketSize; ++ i) {
+        s[i] = sources.front();
+        d[i] = dirs.front();
+    }
+
+    std::array<igl::Hit, RayPacketSize> hits;
+    m_aabb->intersect_ray_packet(*m_tm, s, d, hits);
+
+    RayPacketHits out;
+    for (size_t i = 0; i < count; ++ i) {
+        assert(is_approx(d[i].norm(), 1.));
+        hit_result &ret = out[i];
+        ret = hit_result(*this);
+        ret.m_t = double(hits[i].t);
+        ret.m_dir = d[i];
+        ret.m_source = s[i];
+        if(!std::isinf(hits[i].t) && !std::isnan(hits[i].t)) {
+            ret.m_normal = this->normal_by_face_id(hits[i].id);
+            ret.m_face_id = hits[i].id;
+        }
+    }
+
+    return out;
+}
+
 std::vector<AABBMesh::hit_result>
 AABBMesh::query_ray_hits(const Vec3d &s, const Vec3d &dir) const
 {
@@ -5,6 +5,7 @@
 #ifndef PRUSASLICER_AABBMESH_H
 #define PRUSASLICER_AABBMESH_H
 
+#include <array>
 #include <memory>
 #include <vector>
 
@@ -51,6 +52,10 @@ public:
     // If set to false, a default epsilon is used, which works for "reasonable" meshes.
     explicit AABBMesh(const indexed_triangle_set &tmesh, bool calculate_epsilon = false);
     explicit AABBMesh(const TriangleMesh &mesh, bool calculate_epsilon = false);
+    // The AABB tree is shared through AABBTreeCache with other users of the same mesh.
+    // The caller keeps the mesh alive for the lifetime of AABBMesh.
+    explicit AABBMesh(const std::shared_ptr<const TriangleMesh> &mesh, bool calculate_epsilon = false);
+    explicit AABBMesh(const std::shared_ptr<const indexed_triangle_set> &its, bool calculate_epsilon = false);
     
     AABBMesh(const AABBMesh& other);
     AABBMesh& operator=(const AABBMesh&);
@@ -121,6 +126,20 @@ public:
     // Casting a ray on the mesh, returns the distance where the hit occures.
     hit_result query_ray_hit(const Vec3d &s, const Vec3d &dir) const;
     
+    // Number of rays cast together by query_ray_hit_packet().
+    static constexpr size_t RayPacketSize = 8;
+
+    using RayPacketPoints = std::array<Vec3d, RayPacketSize>;
+    using RayPacketHits   = std::array<hit_result, RayPacketSize>;
+
+    // Casting the first count rays of a packet on the mesh, returns the same
+    // results as query_ray_hit() called for each ray. The AABB tree is
+    // traversed once for the whole packet, which is considerably faster for
+    // coherent rays, such as rays sharing an origin or rays of a beam.
+    RayPacketHits query_ray_hit_packet(const RayPacketPoints &sources,
+                                       const RayPacketPoints &dirs,
+                                       size_t count = RayPacketSize) const;
+
     // Casts a ray on the mesh and returns all hits
     std::vector<hit_result> query_ray_hits(const Vec3d &s, const Vec3d &dir) const;
 
@@ -0,0 +1,109 @@
+///|/ Copyright (c) Prusa Research 2023
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include "AABBTreeCache.hpp"
+
+namespace Slic3r {
+
+namespace {
+
+using Cache = LRUCache<std::string, AABBTreeCache::MeshTree>;
+
+Cache& cache()
+{
+    static Cache instance(size_t(512) << 20, [](const std::string &key, const AABBTreeCache::MeshTree &mesh_tree) {
+        return key.size() + mesh_tree.memsize();
+    });
+    return instance;
+}
+
+template<typename T> void append_bytes(std::string &key, const T &data)
+{
+    key.append(reinterpret_cast<const char*>(&data), sizeof(data));
+}
+
+void append_trafo(std::string &key, const Transform3d &trafo)
+{
+    key.append(reinterpret_cast<const char*>(trafo.data()), sizeof(double) * 16);
+}
+
+std::string make_key(ObjectID owner, const std::string &tag, const Transform3d &trafo)
+{
+    std::string key;
+    append_bytes(key, owner.id);
+    key += tag;
+    key.push_back('\0');
+    append_trafo(key, trafo);
+    return key;
+}
+
+} // namespace
+
+size_t AABBTreeCache::MeshTree::memsize() const
+{
+    return sizeof(MeshTree) + this->its.memsize() + this->tree.nodes().capacity() * sizeof(Tree::Node) +
+           this->parts.capacity() * sizeof(size_t);
+}
+
+AABBTreeCache::MeshTreePtr AABBTreeCache::mesh_tree(ObjectID                         owner,
+                                                    const std::string               &tag,
+                                                    const Transform3d               &trafo,
+                                                    const std::vector<Source>       &sources,
+                                                    const std::function<MeshTree()> &build_fn)
+{
+    std::string key = make_key(owner, tag, trafo);
+    for (const Source &src : sources) {
+        append_bytes(key, src.mesh.get());
+        append_trafo(key, src.trafo);
+    }
+
+    Cache::Dependencies meshes;
+    for (const Source &src : sources)
+        meshes.emplace_back(src.mesh);
+
+    return cache().find_or_build(key, build_fn, std::move(meshes));
+}
+
+std::shared_ptr<const AABBTreeCache::Tree> AABBTreeCache::tree(const std::shared_ptr<const TriangleMesh> &mesh)
+{
+    assert(mesh);
+    // The mesh is not copied, only the tree is stored.
+    MeshTreePtr entry = mesh_tree(ObjectID(), "tree", Transform3d::Identity(), { Source{ mesh } }, [&mesh]() {
+        MeshTree out;
+        out.tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(mesh->its.vertices, mesh->its.indices);
+        return out;
+    });
+    // Aliasing constructor, the tree shares the ownership of the entry.
+    return std::shared_ptr<const Tree>(entry, &entry->tree);
+}
+
+std::shared_ptr<const AABBTreeCache::Tree> AABBTreeCache::tree(const std::shared_ptr<const indexed_triangle_set> &its)
+{
+    assert(its);
+    std::string key = make_key(ObjectID(), "its tree", Transform3d::Identity());
+    append_bytes(key, its.get());
+    MeshTreePtr entry = cache().find_or_build(key, [&its]() {
+        MeshTree out;
+        out.tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(its->vertices, its->indices);
+        return out;
+    }, { its });
+    return std::shared_ptr<const Tree>(entry, &entry->tree);
+}
+
+void AABBTreeCache::set_memory_limit(size_t bytes)
+{
+    cache().set_memory_limit(bytes);
+}
+
+AABBTreeCache::Stats AABBTreeCache::stats()
+{
+    return cache().stats();
+}
+
+void AABBTreeCache::clear()
+{
+    cache().clear();
+}
+
+} // namespace Slic3r
@@ -0,0 +1,81 @@
+///|/ Copyright (c) Prusa Research 2023
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef slic3r_AABBTreeCache_hpp_
+#define slic3r_AABBTreeCache_hpp_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AABBTreeIndirect.hpp"
+#include "LRUCache.hpp"
+#include "ObjectID.hpp"
+#include "TriangleMesh.hpp"
+
+namespace Slic3r {
+
+// Process wide cache of AABB trees over triangle meshes.
+//
+// The same model mesh is raycast by the seam placer, by the support painting, by the GUI raycasters
+// etc. Instead of each of them building its own tree, and rebuilding it whenever a step is invalidated,
+// the trees are built lazily on the first request and shared as immutable objects by all the consumers.
+//
+// The source meshes are identified by their address. The cache only keeps weak references to the
+// source meshes, an entry is dropped once any of its source meshes is released, because the address
+// may be reused by another mesh. As ModelVolume replaces its mesh instead of modifying it, an edited
+// mesh never hits a stale entry.
+//
+// The memory of the cached entries is accounted for, see LRUCache.
+class AABBTreeCache
+{
+public:
+    using Tree = AABBTreeIndirect::Tree3f;
+
+    // Triangle mesh derived from the source meshes together with the AABB tree over it.
+    struct MeshTree {
+        indexed_triangle_set its;
+        Tree                 tree;
+        // Optional indices of the first triangles of parts of its, filled in by the builder.
+        std::vector<size_t>  parts;
+
+        size_t memsize() const;
+    };
+    using MeshTreePtr = std::shared_ptr<const MeshTree>;
+
+    // Source mesh and its transformation.
+    struct Source {
+        std::shared_ptr<const TriangleMesh> mesh;
+        Transform3d                         trafo = Transform3d::Identity();
+    };
+
+    using Stats = LRUCacheStats;
+
+    // Tree built over the mesh in its own coordinate system, as if built by
+    // AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(mesh->its.vertices, mesh->its.indices).
+    // The tree does not keep the mesh alive.
+    static std::shared_ptr<const Tree> tree(const std::shared_ptr<const TriangleMesh> &mesh);
+    // Same as above for meshes not owned by a TriangleMesh, for example the SLA mesh to print.
+    static std::shared_ptr<const Tree> tree(const std::shared_ptr<const indexed_triangle_set> &its);
+
+    // Triangle mesh produced from the sources by build_fn and the tree over it, for consumers raycasting
+    // a transformed, merged or otherwise processed mesh. The owner and the tag identify what is being built,
+    // for example the ModelObject and the purpose of the mesh. The key of the entry is formed by the owner,
+    // the tag, the transformation and the sources including their transformations, thus build_fn
+    // shall only depend on these.
+    static MeshTreePtr mesh_tree(ObjectID                        owner,
+                                 const std::string              &tag,
+                                 const Transform3d              &trafo,
+                                 const std::vector<Source>      &sources,
+                                 const std::function<MeshTree()> &build_fn);
+
+    static void  set_memory_limit(size_t bytes);
+    static Stats stats();
+    static void  clear();
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_AABBTreeCache_hpp_
@@ -11,12 +11,19 @@
 #define slic3r_AABBTreeIndirect_hpp_
 
 #include <algorithm>
+#include <array>
 #include <limits>
 #include <type_traits>
 #include <vector>
 
 #include <Eigen/Geometry>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/task_arena.h>
+
 #include "BoundingBox.hpp"
 #include "Utils.hpp" // for next_highest_power_of_2()
 
@@ -101,7 +108,9 @@ public:
 		else {
 			// Allocate enough memory for a full binary tree.
             m_nodes.assign(next_highest_power_of_2(input.size()) * 2 - 1, Node());
-            build_recursive(input, 0, 0, input.size() - 1);
+            // Large trees are built by parallel tasks. Isolate them, so that a thread waiting for its subtrees
+            // does not pick up unrelated tasks, which may wait for a lock held by the caller of build().
+            tbb::this_task_arena::isolate([this, &input]() { build_recursive(input, 0, 0, input.size() - 1); });
 		}
 	}
 
@@ -123,6 +132,10 @@ public:
 	}
 
 private:
+	// Subtrees over at least this number of source entities are built in parallel.
+	// The two halves of a node are independent, thus the tree built in parallel is the same as if built serially.
+	static constexpr size_t ParallelThreshold = 16384;
+
 	// Build a balanced tree by splitting the input sequence by an axis aligned plane at a dimension.
 	template<typename SourceNode>
 	void build_recursive(std::vector<SourceNode> &input, size_t node, const size_t left, const size_t right)
@@ -137,9 +150,7 @@ private:
 		}
 
 		// Calculate bounding box of the input.
-        BoundingBox bbox(input[left].bbox());
-        for (size_t i = left + 1; i <= right; ++ i)
-            bbox.extend(input[i].bbox());
+        BoundingBox bbox = input_bbox(input, left, right);
         int dimension = -1;
         bbox.diagonal().maxCoeff(&dimension);
 
@@ -149,8 +160,29 @@ private:
 		// Insert an inner node into the tree. Inner node does not reference any input entity (triangle, line segment etc).
 		m_nodes[node].idx  = inner;
 		m_nodes[node].bbox = bbox;
-        build_recursive(input, node * 2 + 1, left, center);
-		build_recursive(input, node * 2 + 2, center + 1, right);
+		if (right - left >= ParallelThreshold)
+			tbb::parallel_invoke(
+				[this, &input, node, left, center]() { build_recursive(input, node * 2 + 1, left, center); },
+				[this, &input, node, center, right]() { build_recursive(input, node * 2 + 2, center + 1, right); });
+		else {
+	        build_recursive(input, node * 2 + 1, left, center);
+			build_recursive(input, node * 2 + 2, center + 1, right);
+		}
+	}
+
+	// Bounding box of the input <left, right>.
+	template<typename SourceNode>
+	static BoundingBox input_bbox(const std::vector<SourceNode> &input, const size_t left, const size_t right)
+	{
+		auto extend = [&input](const tbb::blocked_range<size_t> &range, BoundingBox bbox) {
+			for (size_t i = range.begin(); i < range.end(); ++ i)
+				bbox.extend(input[i].bbox());
+			return bbox;
+		};
+		if (right - left < ParallelThreshold)
+			return extend(tbb::blocked_range<size_t>(left, right + 1), input[left].bbox());
+		return tbb::parallel_reduce(tbb::blocked_range<size_t>(left, right + 1, ParallelThreshold / 4), input[left].bbox(), extend,
+			[](BoundingBox a, const BoundingBox &b) { return a.extend(b); });
 	}
 
 	// Partition the input m_nodes <left, right> at "k" and "dimension" using the QuickSelect method:
@@ -696,24 +728,24 @@ inline Tree<3, typename VertexType::Scalar> build_aabb_tree_over_indexed_triangl
         VectorType 	m_centroid;
 	};
 
-	std::vector<InputType> input;
-	input.reserve(faces.size());
+	std::vector<InputType> input(faces.size());
     const VectorType veps(eps, eps, eps);
-	for (size_t i = 0; i < faces.size(); ++ i) {
-        const IndexedFaceType &face = faces[i];
-		const VertexType &v1 = vertices[face(0)];
-		const VertexType &v2 = vertices[face(1)];
-		const VertexType &v3 = vertices[face(2)];
-		InputType n;
-        n.m_idx      = i;
-        n.m_centroid = (1./3.) * (v1 + v2 + v3);
-        n.m_bbox = BoundingBox(v1, v1);
-        n.m_bbox.extend(v2);
-        n.m_bbox.extend(v3);
-        n.m_bbox.min() -= veps;
-        n.m_bbox.max() += veps;
-        input.emplace_back(n);
-	}
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, faces.size(), 4096), [&vertices, &faces, &veps, &input](const tbb::blocked_range<size_t> &range) {
+		for (size_t i = range.begin(); i < range.end(); ++ i) {
+	        const IndexedFaceType &face = faces[i];
+			const VertexType &v1 = vertices[face(0)];
+			const VertexType &v2 = vertices[face(1)];
+			const VertexType &v3 = vertices[face(2)];
+			InputType &n = input[i];
+	        n.m_idx      = i;
+	        n.m_centroid = (1./3.) * (v1 + v2 + v3);
+	        n.m_bbox = BoundingBox(v1, v1);
+	        n.m_bbox.extend(v2);
+	        n.m_bbox.extend(v3);
+	        n.m_bbox.min() -= veps;
+	        n.m_bbox.max() += veps;
+		}
+	});
 
 	TreeType out;
 	out.build(std::move(input));
@@ -791,6 +823,171 @@ inline bool intersect_ray_all_hits(
 	return ! hits.empty();
 }
 
+namespace detail {
+	// Packet of rays traced together, stored as a structure of arrays, so that a bounding box is tested
+	// against all the rays of the packet by the same arithmetic over N consecutive values,
+	// which the compiler turns into SSE / AVX / NEON code.
+	template<typename Scalar, size_t N>
+	struct RayPacket {
+		alignas(32) Scalar origin[3][N];
+		alignas(32) Scalar invdir[3][N];
+		// Parameter of the closest hit found so far, boxes further away are not interesting.
+		alignas(32) Scalar tmax[N];
+	};
+
+	// Slab test of a bounding box against all rays of a packet, active[i] is set to the result for the i-th ray.
+	// Returns the number of rays intersecting the box.
+	// NaN produced for a ray parallel to a slab and starting at its boundary makes the slab to be ignored,
+	// thus such ray is considered to intersect the box, which is conservative.
+	template<typename Scalar, size_t N, typename BoxScalar>
+	inline size_t ray_packet_box_intersect(const RayPacket<Scalar, N> &packet, const Eigen::AlignedBox<BoxScalar, 3> &box, std::array<bool, N> &active)
+	{
+		Scalar tentry[N];
+		Scalar texit[N];
+		for (size_t i = 0; i < N; ++ i) {
+			tentry[i] = Scalar(0);
+			texit[i]  = packet.tmax[i];
+		}
+		for (int axis = 0; axis < 3; ++ axis) {
+			const Scalar bmin = Scalar(box.min()(axis));
+			const Scalar bmax = Scalar(box.max()(axis));
+			for (size_t i = 0; i < N; ++ i) {
+				Scalar t1 = (bmin - packet.origin[axis][i]) * packet.invdir[axis][i];
+				Scalar t2 = (bmax - packet.origin[axis][i]) * packet.invdir[axis][i];
+				Scalar tl = t1 < t2 ? t1 : t2;
+				Scalar th = t1 < t2 ? t2 : t1;
+				tentry[i] = tl > tentry[i] ? tl : tentry[i];
+				texit[i]  = th < texit[i]  ? th : texit[i];
+			}
+		}
+		size_t cnt = 0;
+		for (size_t i = 0; i < N; ++ i) {
+			active[i] = tentry[i] <= texit[i];
+			cnt += active[i];
+		}
+		return cnt;
+	}
+} // namespace detail
+
+// Find the first intersections of a packet of N rays with indexed triangle set.
+// Returns the same hits as intersect_ray_first_hit() called for each ray of the packet, but the tree
+// is traversed just once for the whole packet: a node is visited if any of the rays intersects its
+// bounding box closer than the ray's closest hit found so far, and the node's bounding box is tested
+// against all the rays at once. This pays off for coherent rays, such as rays sharing an origin or
+// rays of a narrow beam, which mostly visit the same nodes.
+// Rays not intersecting the triangle set get igl::Hit::id set to -1 and igl::Hit::t to infinity.
+// Returns true if any of the rays intersects the triangle set.
+template<typename VertexType, typename IndexedFaceType, typename TreeType, typename VectorType, size_t N>
+inline bool intersect_ray_packet_first_hit(
+	// Indexed triangle set - 3D vertices.
+	const std::vector<VertexType> 		&vertices,
+	// Indexed triangle set - triangular faces, references to vertices.
+	const std::vector<IndexedFaceType> 	&faces,
+	// AABBTreeIndirect::Tree over vertices & faces, bounding boxes built with the accuracy of vertices.
+	const TreeType 						&tree,
+	// Origins of the rays.
+	const std::array<VectorType, N>		&origins,
+	// Directions of the rays.
+	const std::array<VectorType, N>		&dirs,
+	// First intersections of the rays with the indexed triangle set.
+	std::array<igl::Hit, N>				&hits,
+	// Epsilon for the ray-triangle intersection, it should be proportional to an average triangle edge length.
+	const double 						 eps = 0.000001)
+{
+	using Scalar = typename VectorType::Scalar;
+	// If at most this number of rays intersect a node, the rays are traced one by one.
+	static constexpr size_t SingleRayThreshold = N / 2;
+
+	detail::RayPacket<Scalar, N> packet;
+	VectorType dir_sum = VectorType::Zero();
+	for (size_t i = 0; i < N; ++ i) {
+		for (int axis = 0; axis < 3; ++ axis) {
+			packet.origin[axis][i] = origins[i](axis);
+			packet.invdir[axis][i] = Scalar(1) / dirs[i](axis);
+		}
+		packet.tmax[i] = std::numeric_limits<Scalar>::infinity();
+		hits[i] = igl::Hit{ -1, -1, 0.f, 0.f, std::numeric_limits<float>::infinity() };
+		dir_sum += dirs[i];
+	}
+	if (tree.empty())
+		return false;
+
+	// The tree is balanced, its depth is bounded by the number of bits of the node index.
+	// A node pushes at most one more node to the stack than it pops.
+	std::array<size_t, 2 * 64> stack;
+	size_t stack_size = 0;
+	stack[stack_size ++] = 0;
+
+	std::array<bool, N> active;
+	bool                any_hit = false;
+	while (stack_size > 0) {
+		const size_t node_idx = stack[-- stack_size];
+		const auto  &node     = tree.node(node_idx);
+		assert(node.is_valid());
+		size_t num_active = detail::ray_packet_box_intersect(packet, node.bbox, active);
+		if (num_active == 0)
+			continue;
+		if (num_active <= SingleRayThreshold && ! node.is_leaf()) {
+			// The rays diverged, testing a bounding box against the whole packet is no more worth it.
+			// Finish the subtree by traversing it with the active rays one by one.
+			for (size_t i = 0; i < N; ++ i)
+				if (active[i]) {
+					auto ray_intersector = detail::RayIntersector<VertexType, IndexedFaceType, TreeType, VectorType> {
+						vertices, faces, tree,
+						origins[i], dirs[i], VectorType(dirs[i].cwiseInverse()),
+						eps
+					};
+					igl::Hit hit;
+					if (detail::intersect_ray_recursive_first_hit(ray_intersector, node_idx, packet.tmax[i], hit) && hit.t < packet.tmax[i]) {
+						hits[i]        = hit;
+						packet.tmax[i] = Scalar(hit.t);
+						any_hit        = true;
+					}
+				}
+		} else if (node.is_leaf()) {
+			auto face = faces[node.idx];
+			for (size_t i = 0; i < N; ++ i)
+				if (active[i]) {
+					double t, u, v;
+					if (detail::intersect_triangle(origins[i], dirs[i], vertices[face(0)], vertices[face(1)], vertices[face(2)], t, u, v, eps)
+						&& t > 0. && t < packet.tmax[i]) {
+						hits[i]        = igl::Hit{ int(node.idx), -1, float(u), float(v), float(t) };
+						packet.tmax[i] = Scalar(t);
+						any_hit        = true;
+					}
+				}
+		} else {
+			// Left / right child node index. The child closer along the average direction of the packet
+			// is visited first, so that the rays get short early and the farther child is likely culled.
+			size_t left  = node_idx * 2 + 1;
+			size_t right = left + 1;
+			const auto &bbox_left  = tree.node(left).bbox;
+			const auto &bbox_right = tree.node(right).bbox;
+			bool left_first = (bbox_right.center() - bbox_left.center()).template cast<Scalar>().dot(dir_sum) > Scalar(0);
+			assert(stack_size + 2 <= stack.size());
+			stack[stack_size ++] = left_first ? right : left;
+			stack[stack_size ++] = left_first ? left : right;
+		}
+	}
+	return any_hit;
+}
+
+// Variant of intersect_ray_packet_first_hit() for rays sharing the same origin.
+template<typename VertexType, typename IndexedFaceType, typename TreeType, typename VectorType, size_t N>
+inline bool intersect_ray_packet_first_hit(
+	const std::vector<VertexType> 		&vertices,
+	const std::vector<IndexedFaceType> 	&faces,
+	const TreeType 						&tree,
+	const VectorType					&origin,
+	const std::array<VectorType, N>		&dirs,
+	std::array<igl::Hit, N>				&hits,
+	const double 						 eps = 0.000001)
+{
+	std::array<VectorType, N> origins;
+	origins.fill(origin);
+	return intersect_ray_packet_first_hit(vertices, faces, tree, origins, dirs, hits, eps);
+}
+
 // Finding a closest triangle, its closest point and squared distance to the closest point
 // on a 3D indexed triangle set using a pre-built AABBTreeIndirect::Tree.
 // Closest point to triangle test will be performed with the accuracy of VectorType::Scalar
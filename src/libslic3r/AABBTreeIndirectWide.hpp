@@ -0,0 +1,518 @@
+///|/ Copyright (c) Prusa Research 2023
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+// 4-wide bounding volume hierarchy built by the Surface Area Heuristic, an alternative to
+// AABBTreeIndirect::Tree for ray casting and closest point queries over indexed triangle sets.
+
+#ifndef slic3r_AABBTreeIndirectWide_hpp_
+#define slic3r_AABBTreeIndirectWide_hpp_
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "AABBTreeIndirect.hpp"
+
+namespace Slic3r {
+namespace AABBTreeIndirect {
+
+// Static 4-wide AABB tree referencing external entities by indices, exposing the same queries
+// as Tree (see the overloads of intersect_ray_first_hit(), intersect_ray_all_hits() and
+// squared_distance_to_indexed_triangle_set() below).
+//
+// Unlike Tree, which splits at the median of the longest axis, the tree is built top-down by
+// binned Surface Area Heuristic, which minimizes the expected number of visited nodes for rays
+// and adapts to unevenly tessellated meshes. Every node stores the bounding boxes of its up to
+// four children in a structure of arrays layout, so that a ray or a point is tested against all
+// four boxes by the same arithmetic over four consecutive values, which the compiler turns into
+// SSE / AVX / NEON code. Leaves reference short runs of entity indices, which reduces the depth
+// of the tree and the number of nodes to be visited.
+template<typename ACoordType>
+class WideTree
+{
+public:
+    static constexpr size_t Width       = 4;
+    static constexpr size_t MaxLeafSize = 4;
+
+    using CoordType   = ACoordType;
+    using VectorType  = Eigen::Matrix<CoordType, 3, 1, Eigen::DontAlign>;
+    using BoundingBox = Eigen::AlignedBox<CoordType, 3>;
+
+    struct Node {
+        // Bounding boxes of the children, indexed [axis][child].
+        alignas(16) CoordType bmin[3][Width];
+        alignas(16) CoordType bmax[3][Width];
+        // Index of the child node for an inner child,
+        // index of the first entity in indices() for a leaf child.
+        uint32_t child[Width];
+        // Number of entities of a leaf child, zero for an inner child.
+        uint32_t count[Width];
+        // Number of the used child slots.
+        uint32_t size = 0;
+
+        bool is_leaf(size_t k) const { return this->count[k] > 0; }
+    };
+
+    void clear() { m_nodes.clear(); m_indices.clear(); }
+
+    // SourceNode has the same interface as for Tree::build().
+    template<typename SourceNode>
+    void build(std::vector<SourceNode> &&input)
+    {
+        this->clear();
+        if (input.empty())
+            return;
+
+        m_nodes.reserve(input.size() / 2 + 1);
+        build_node(input, make_range(input, 0, input.size()), 0);
+
+        m_indices.reserve(input.size());
+        for (const SourceNode &n : input)
+            m_indices.emplace_back(n.idx());
+
+        input.clear();
+    }
+
+    template<typename SourceNode>
+    void build(const std::vector<SourceNode> &input)
+    {
+        std::vector<SourceNode> copy(input);
+        this->build(std::move(copy));
+    }
+
+    const std::vector<Node>&    nodes() const { return m_nodes; }
+    const Node&                 node(size_t idx) const { return m_nodes[idx]; }
+    // Indices of the external entities, referenced by the leaves.
+    const std::vector<size_t>&  indices() const { return m_indices; }
+    bool                        empty() const { return m_nodes.empty(); }
+
+    // Bounding box of the whole tree.
+    BoundingBox bbox() const
+    {
+        BoundingBox out;
+        if (! m_nodes.empty())
+            for (size_t k = 0; k < m_nodes.front().size; ++ k)
+                out.extend(child_bbox(m_nodes.front(), k));
+        return out;
+    }
+
+    static BoundingBox child_bbox(const Node &node, size_t k)
+    {
+        return BoundingBox(VectorType(node.bmin[0][k], node.bmin[1][k], node.bmin[2][k]),
+                           VectorType(node.bmax[0][k], node.bmax[1][k], node.bmax[2][k]));
+    }
+
+private:
+    static constexpr int    NumBins  = 16;
+    // Below this depth the tree is split at the median to keep the depth bounded even for
+    // degenerate inputs, which allows for a fixed size traversal stack.
+    static constexpr size_t MaxDepth = 24;
+
+    struct Range {
+        size_t      begin, end;
+        BoundingBox bbox;
+        BoundingBox centroid_bbox;
+
+        size_t size() const { return end - begin; }
+    };
+
+    static CoordType half_area(const BoundingBox &bb)
+    {
+        if (bb.isEmpty())
+            return CoordType(0);
+        VectorType d = bb.sizes();
+        return d.x() * d.y() + d.y() * d.z() + d.z() * d.x();
+    }
+
+    template<typename SourceNode>
+    static Range make_range(const std::vector<SourceNode> &input, size_t begin, size_t end)
+    {
+        Range r{begin, end, {}, {}};
+        for (size_t i = begin; i < end; ++ i) {
+            r.bbox.extend(input[i].bbox());
+            r.centroid_bbox.extend(input[i].centroid());
+        }
+        return r;
+    }
+
+    // Split the range in two by the binned Surface Area Heuristic along the longest axis of
+    // the centroids, or at the median if SAH is not applicable.
+    template<typename SourceNode>
+    static std::array<Range, 2> split(std::vector<SourceNode> &input, const Range &r, size_t depth)
+    {
+        int        axis   = 0;
+        CoordType  extent = r.centroid_bbox.sizes().maxCoeff(&axis);
+        CoordType  cmin   = r.centroid_bbox.min()(axis);
+        size_t     mid    = r.begin + r.size() / 2;
+
+        if (extent > CoordType(0) && depth < MaxDepth) {
+            struct Bin {
+                BoundingBox bbox;
+                size_t      count = 0;
+            };
+            std::array<Bin, NumBins> bins;
+
+            const CoordType scale = CoordType(NumBins) / extent;
+            auto bin_idx = [&](const SourceNode &n) {
+                return std::min(NumBins - 1, int((n.centroid()(axis) - cmin) * scale));
+            };
+
+            for (size_t i = r.begin; i < r.end; ++ i) {
+                Bin &bin = bins[bin_idx(input[i])];
+                bin.bbox.extend(input[i].bbox());
+                ++ bin.count;
+            }
+
+            // Cost of the split after bin i, the left part sweeps from the left, the right part from the right.
+            std::array<CoordType, NumBins - 1> cost;
+            BoundingBox bb;
+            size_t      cnt = 0;
+            for (int i = 0; i < NumBins - 1; ++ i) {
+                bb.extend(bins[i].bbox);
+                cnt += bins[i].count;
+                cost[i] = half_area(bb) * CoordType(cnt);
+            }
+            bb.setEmpty();
+            cnt = 0;
+            for (int i = NumBins - 1; i > 0; -- i) {
+                bb.extend(bins[i].bbox);
+                cnt += bins[i].count;
+                cost[i - 1] += half_area(bb) * CoordType(cnt);
+            }
+
+            int best = int(std::min_element(cost.begin(), cost.end()) - cost.begin());
+            mid = size_t(std::partition(input.begin() + r.begin, input.begin() + r.end,
+                                        [&](const SourceNode &n) { return bin_idx(n) <= best; }) - input.begin());
+        }
+
+        if (mid == r.begin || mid == r.end) {
+            mid = r.begin + r.size() / 2;
+            std::nth_element(input.begin() + r.begin, input.begin() + mid, input.begin() + r.end,
+                             [axis](const SourceNode &lhs, const SourceNode &rhs) { return lhs.centroid()(axis) < rhs.centroid()(axis); });
+        }
+
+        return {make_range(input, r.begin, mid), make_range(input, mid, r.end)};
+    }
+
+    // Collapse up to two levels of binary splits into a single 4-wide node: the child with the
+    // largest surface area is split until there are four children or no child may be split.
+    template<typename SourceNode>
+    uint32_t build_node(std::vector<SourceNode> &input, const Range &range, size_t depth)
+    {
+        auto node_idx = uint32_t(m_nodes.size());
+        m_nodes.emplace_back();
+
+        std::vector<Range> children{range};
+        while (children.size() < Width) {
+            auto it = children.end();
+            CoordType best_area = -1;
+            for (auto c = children.begin(); c != children.end(); ++ c)
+                if (c->size() > MaxLeafSize && half_area(c->bbox) > best_area) {
+                    best_area = half_area(c->bbox);
+                    it        = c;
+                }
+            if (it == children.end())
+                break;
+            std::array<Range, 2> halves = split(input, *it, depth);
+            *it = halves[0];
+            children.emplace_back(halves[1]);
+        }
+
+        for (size_t k = 0; k < Width; ++ k) {
+            const bool used = k < children.size();
+            for (int a = 0; a < 3; ++ a) {
+                // Unused slots get an inverted box, they are masked out by Node::size anyway.
+                m_nodes[node_idx].bmin[a][k] = used ? children[k].bbox.min()(a) : std::numeric_limits<CoordType>::max();
+                m_nodes[node_idx].bmax[a][k] = used ? children[k].bbox.max()(a) : std::numeric_limits<CoordType>::lowest();
+            }
+            m_nodes[node_idx].child[k] = 0;
+            m_nodes[node_idx].count[k] = 0;
+        }
+        m_nodes[node_idx].size = uint32_t(children.size());
+
+        for (size_t k = 0; k < children.size(); ++ k) {
+            const Range &c = children[k];
+            if (c.size() <= MaxLeafSize) {
+                m_nodes[node_idx].child[k] = uint32_t(c.begin);
+                m_nodes[node_idx].count[k] = uint32_t(c.size());
+            } else {
+                // m_nodes may be reallocated by the recursive call.
+                uint32_t child_idx = build_node(input, c, depth + 1);
+                m_nodes[node_idx].child[k] = child_idx;
+            }
+        }
+
+        return node_idx;
+    }
+
+    std::vector<Node>   m_nodes;
+    std::vector<size_t> m_indices;
+};
+
+using WideTree3f = WideTree<float>;
+using WideTree3d = WideTree<double>;
+
+namespace detail {
+
+    // Item of the explicit traversal stack: an inner node or a leaf run of entities,
+    // and the ray parameter at entry of its bounding box or its squared distance.
+    template<typename Scalar>
+    struct WideStackItem {
+        uint32_t idx;
+        uint32_t count;
+        Scalar   key;
+    };
+
+    // The depth of WideTree is bounded, each level adds at most Width - 1 items.
+    static constexpr size_t WideStackSize = 256;
+
+    // Push the children of a node with finite keys to the stack, the one with the lowest key on top.
+    template<typename NodeType, typename Scalar>
+    inline void wide_push_children(const NodeType &node, const Scalar (&key)[4], WideStackItem<Scalar> *stack, size_t &stack_size)
+    {
+        size_t first = stack_size;
+        for (size_t k = 0; k < node.size; ++ k)
+            if (key[k] < std::numeric_limits<Scalar>::infinity()) {
+                // Insertion sort by descending key.
+                size_t i = stack_size ++;
+                for (; i > first && stack[i - 1].key < key[k]; -- i)
+                    stack[i] = stack[i - 1];
+                stack[i] = { node.child[k], node.count[k], key[k] };
+            }
+        assert(stack_size <= WideStackSize);
+    }
+
+    // Ray parameters at entry of the children boxes of a node, infinity for the boxes not hit
+    // within (0, tmax).
+    template<typename NodeType, typename Scalar>
+    inline void wide_ray_boxes(const NodeType &node, const Scalar (&origin)[3], const Scalar (&invdir)[3], Scalar tmax, Scalar (&tnear)[4])
+    {
+        for (size_t k = 0; k < 4; ++ k) {
+            Scalar t0 = 0;
+            Scalar t1 = tmax;
+            for (int a = 0; a < 3; ++ a) {
+                Scalar tl = (Scalar(node.bmin[a][k]) - origin[a]) * invdir[a];
+                Scalar th = (Scalar(node.bmax[a][k]) - origin[a]) * invdir[a];
+                t0 = std::max(t0, std::min(tl, th));
+                t1 = std::min(t1, std::max(tl, th));
+            }
+            tnear[k] = (k < node.size && t0 <= t1) ? t0 : std::numeric_limits<Scalar>::infinity();
+        }
+    }
+
+    // Squared distances of a point to the children boxes of a node.
+    template<typename NodeType, typename Scalar>
+    inline void wide_point_boxes(const NodeType &node, const Scalar (&point)[3], Scalar (&sqr_dist)[4])
+    {
+        for (size_t k = 0; k < 4; ++ k) {
+            Scalar d2 = 0;
+            for (int a = 0; a < 3; ++ a) {
+                Scalar d = std::max(std::max(Scalar(node.bmin[a][k]) - point[a], point[a] - Scalar(node.bmax[a][k])), Scalar(0));
+                d2 += d * d;
+            }
+            sqr_dist[k] = k < node.size ? d2 : std::numeric_limits<Scalar>::infinity();
+        }
+    }
+
+    // Traverse the tree along a ray, calling leaf_fn(entity_idx) for the entities of the leaves
+    // whose boxes are hit before the current tmax, closer leaves first. leaf_fn updates tmax
+    // to prune the traversal.
+    template<typename CoordType, typename VectorType, typename LeafFn>
+    inline void wide_traverse_ray(const WideTree<CoordType> &tree, const VectorType &origin, const VectorType &dir,
+                                  typename VectorType::Scalar &tmax, LeafFn &&leaf_fn)
+    {
+        using Scalar = typename VectorType::Scalar;
+
+        const Scalar o[3]   = { origin.x(), origin.y(), origin.z() };
+        const Scalar inv[3] = { Scalar(1) / dir.x(), Scalar(1) / dir.y(), Scalar(1) / dir.z() };
+
+        WideStackItem<Scalar> stack[WideStackSize];
+        size_t                stack_size = 0;
+        Scalar                tnear[4];
+
+        stack[stack_size ++] = { 0, 0, Scalar(0) };
+        while (stack_size > 0) {
+            const WideStackItem<Scalar> item = stack[-- stack_size];
+            if (item.key > tmax)
+                continue;
+            if (item.count > 0) {
+                for (uint32_t i = item.idx; i < item.idx + item.count; ++ i)
+                    leaf_fn(tree.indices()[i]);
+            } else {
+                const auto &node = tree.node(item.idx);
+                wide_ray_boxes(node, o, inv, tmax, tnear);
+                wide_push_children(node, tnear, stack, stack_size);
+            }
+        }
+    }
+
+} // namespace detail
+
+// Build a 4-wide SAH tree over an indexed triangle set.
+// Epsilon is applied to the bounding boxes of the tree to cope with numeric inaccuracies
+// during tree traversal.
+template<typename VertexType, typename IndexedFaceType>
+inline WideTree<typename VertexType::Scalar> build_wide_aabb_tree_over_indexed_triangle_set(
+    // Indexed triangle set - 3D vertices.
+    const std::vector<VertexType>       &vertices,
+    // Indexed triangle set - triangular faces, references to vertices.
+    const std::vector<IndexedFaceType>  &faces,
+    const typename VertexType::Scalar    eps = 0)
+{
+    using TreeType    = WideTree<typename VertexType::Scalar>;
+    using VectorType  = typename TreeType::VectorType;
+    using BoundingBox = typename TreeType::BoundingBox;
+
+    struct InputType {
+        size_t              idx()       const { return m_idx; }
+        const BoundingBox&  bbox()      const { return m_bbox; }
+        const VectorType&   centroid()  const { return m_centroid; }
+
+        size_t      m_idx;
+        BoundingBox m_bbox;
+        VectorType  m_centroid;
+    };
+
+    std::vector<InputType> input;
+    input.reserve(faces.size());
+    const VectorType veps(eps, eps, eps);
+    for (size_t i = 0; i < faces.size(); ++ i) {
+        const IndexedFaceType &face = faces[i];
+        const VertexType &v1 = vertices[face(0)];
+        const VertexType &v2 = vertices[face(1)];
+        const VertexType &v3 = vertices[face(2)];
+        InputType n;
+        n.m_idx      = i;
+        n.m_centroid = (1./3.) * (v1 + v2 + v3);
+        n.m_bbox = BoundingBox(v1, v1);
+        n.m_bbox.extend(v2);
+        n.m_bbox.extend(v3);
+        n.m_bbox.min() -= veps;
+        n.m_bbox.max() += veps;
+        input.emplace_back(n);
+    }
+
+    TreeType out;
+    out.build(std::move(input));
+    return out;
+}
+
+// Same as intersect_ray_first_hit() over Tree.
+template<typename VertexType, typename IndexedFaceType, typename CoordType, typename VectorType>
+inline bool intersect_ray_first_hit(
+    const std::vector<VertexType>       &vertices,
+    const std::vector<IndexedFaceType>  &faces,
+    const WideTree<CoordType>           &tree,
+    const VectorType                    &origin,
+    const VectorType                    &dir,
+    igl::Hit                            &hit,
+    const double                         eps = 0.000001)
+{
+    using Scalar = typename VectorType::Scalar;
+
+    if (tree.empty())
+        return false;
+
+    Scalar tmax  = std::numeric_limits<Scalar>::infinity();
+    bool   found = false;
+    detail::wide_traverse_ray(tree, origin, dir, tmax, [&](size_t face_idx) {
+        const IndexedFaceType &face = faces[face_idx];
+        double t, u, v;
+        if (detail::intersect_triangle(origin, dir, vertices[face(0)], vertices[face(1)], vertices[face(2)], t, u, v, eps)
+            && t > 0. && t < tmax) {
+            hit   = igl::Hit{ int(face_idx), -1, float(u), float(v), float(t) };
+            tmax  = Scalar(t);
+            found = true;
+        }
+    });
+    return found;
+}
+
+// Same as intersect_ray_all_hits() over Tree.
+template<typename VertexType, typename IndexedFaceType, typename CoordType, typename VectorType>
+inline bool intersect_ray_all_hits(
+    const std::vector<VertexType>       &vertices,
+    const std::vector<IndexedFaceType>  &faces,
+    const WideTree<CoordType>           &tree,
+    const VectorType                    &origin,
+    const VectorType                    &dir,
+    std::vector<igl::Hit>               &hits,
+    const double                         eps = 0.000001)
+{
+    using Scalar = typename VectorType::Scalar;
+
+    hits.clear();
+    if (tree.empty())
+        return false;
+
+    Scalar tmax = std::numeric_limits<Scalar>::infinity();
+    detail::wide_traverse_ray(tree, origin, dir, tmax, [&](size_t face_idx) {
+        const IndexedFaceType &face = faces[face_idx];
+        double t, u, v;
+        if (detail::intersect_triangle(origin, dir, vertices[face(0)], vertices[face(1)], vertices[face(2)], t, u, v, eps)
+            && t > 0.)
+            hits.emplace_back(igl::Hit{ int(face_idx), -1, float(u), float(v), float(t) });
+    });
+    std::sort(hits.begin(), hits.end(), [](const auto &l, const auto &r) { return l.t < r.t; });
+    return ! hits.empty();
+}
+
+// Same as squared_distance_to_indexed_triangle_set() over Tree.
+template<typename VertexType, typename IndexedFaceType, typename CoordType, typename VectorType>
+inline typename VectorType::Scalar squared_distance_to_indexed_triangle_set(
+    const std::vector<VertexType>       &vertices,
+    const std::vector<IndexedFaceType>  &faces,
+    const WideTree<CoordType>           &tree,
+    const VectorType                    &point,
+    size_t                              &hit_idx_out,
+    Eigen::PlainObjectBase<VectorType>  &hit_point_out)
+{
+    using Scalar = typename VectorType::Scalar;
+
+    if (tree.empty())
+        return Scalar(-1);
+
+    const Scalar p[3] = { point.x(), point.y(), point.z() };
+
+    detail::WideStackItem<Scalar> stack[detail::WideStackSize];
+    size_t                        stack_size = 0;
+    Scalar                        sqr_dist[4];
+    Scalar                        up_sqr_d = std::numeric_limits<Scalar>::infinity();
+
+    stack[stack_size ++] = { 0, 0, Scalar(0) };
+    while (stack_size > 0) {
+        const detail::WideStackItem<Scalar> item = stack[-- stack_size];
+        if (item.key >= up_sqr_d)
+            continue;
+        if (item.count > 0) {
+            for (uint32_t i = item.idx; i < item.idx + item.count; ++ i) {
+                size_t                 face_idx = tree.indices()[i];
+                const IndexedFaceType &face     = faces[face_idx];
+                VectorType c = detail::closest_point_to_triangle<VectorType>(point,
+                    vertices[face(0)].template cast<Scalar>(),
+                    vertices[face(1)].template cast<Scalar>(),
+                    vertices[face(2)].template cast<Scalar>());
+                Scalar d2 = (point - c).squaredNorm();
+                if (d2 < up_sqr_d) {
+                    up_sqr_d      = d2;
+                    hit_idx_out   = face_idx;
+                    hit_point_out = c;
+                }
+            }
+        } else {
+            const auto &node = tree.node(item.idx);
+            detail::wide_point_boxes(node, p, sqr_dist);
+            detail::wide_push_children(node, sqr_dist, stack, stack_size);
+        }
+    }
+
+    return up_sqr_d;
+}
+
+} // namespace AABBTreeIndirect
+} // namespace Slic3r
+
+#endif /* slic3r_AABBTreeIndirectWide_hpp_ */
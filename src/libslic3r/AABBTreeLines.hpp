@@ -312,7 +312,7 @@ public:
         tree = AABBTreeLines::build_aabb_tree_over_indexed_lines(this->lines);
     }
 
-    explicit LinesDistancer(std::vector<LineType> &&lines) : lines(lines)
+    explicit LinesDistancer(std::vector<LineType> &&lines) : lines(std::move(lines))
     {
         tree = AABBTreeLines::build_aabb_tree_over_indexed_lines(this->lines);
     }
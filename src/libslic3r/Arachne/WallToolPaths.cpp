@@ -17,6 +17,8 @@
 
 #include <boost/log/trivial.hpp>
 
+#include <tbb/parallel_for.h>
+
 //#define ARACHNE_STITCH_PATCH_DEBUG
 
 namespace Slic3r::Arachne
@@ -506,17 +508,39 @@ const std::vector<VariableWidthLines> &WallToolPaths::generate()
         );
     const coord_t transition_filter_dist   = scaled<coord_t>(100.f);
     const coord_t allowed_filter_deviation = wall_transition_filter_deviation;
-    SkeletalTrapezoidation wall_maker
-    (
-        prepared_outline,
-        *beading_strat,
-        beading_strat->getTransitioningAngle(),
-        discretization_step_size,
-        transition_filter_dist,
-        allowed_filter_deviation,
-        wall_transition_length
-    );
-    wall_maker.generateToolpaths(toolpaths);
+    auto generate_toolpaths = [&](const Polygons &island_outline, std::vector<VariableWidthLines> &out) {
+        SkeletalTrapezoidation wall_maker
+        (
+            island_outline,
+            *beading_strat,
+            beading_strat->getTransitioningAngle(),
+            discretization_step_size,
+            transition_filter_dist,
+            allowed_filter_deviation,
+            wall_transition_length
+        );
+        wall_maker.generateToolpaths(out);
+    };
+
+    // The Voronoi diagrams of separate islands don't interact inside the islands, thus each island gets its own
+    // skeletal trapezoidation. Many small Voronoi diagrams are cheaper than a single large one and they are built in parallel.
+    if (std::count_if(prepared_outline.begin(), prepared_outline.end(), [](const Polygon &contour) { return contour.is_counter_clockwise(); }) > 1) {
+        const ExPolygons islands = union_ex(prepared_outline);
+        std::vector<std::vector<VariableWidthLines>> islands_toolpaths(islands.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, islands.size()), [&islands, &islands_toolpaths, &generate_toolpaths](const tbb::blocked_range<size_t> &range) {
+            for (size_t island_idx = range.begin(); island_idx < range.end(); ++ island_idx)
+                generate_toolpaths(to_polygons(islands[island_idx]), islands_toolpaths[island_idx]);
+        }); // end of parallel_for
+
+        // Merge the toolpaths by the inset index in the order of the islands.
+        for (std::vector<VariableWidthLines> &island_toolpaths : islands_toolpaths) {
+            if (island_toolpaths.size() > toolpaths.size())
+                toolpaths.resize(island_toolpaths.size());
+            for (size_t inset_idx = 0; inset_idx < island_toolpaths.size(); ++ inset_idx)
+                append(toolpaths[inset_idx], std::move(island_toolpaths[inset_idx]));
+        }
+    } else
+        generate_toolpaths(prepared_outline, toolpaths);
 
     stitchToolPaths(toolpaths, this->bead_width_x);
 
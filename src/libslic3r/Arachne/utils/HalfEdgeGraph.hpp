@@ -8,6 +8,7 @@
 #include <list>
 #include <cassert>
 
+#include <oneapi/tbb/scalable_allocator.h>
 
 
 #include "HalfEdge.hpp"
@@ -21,8 +22,10 @@ class HalfEdgeGraph
 public:
     using edge_t = derived_edge_t;
     using node_t = derived_node_t;
-    using Edges = std::list<edge_t>;
-    using Nodes = std::list<node_t>;
+    // The graph allocates and frees huge numbers of small nodes and edges, possibly from many threads at once.
+    // The TBB scalable allocator serves them from per-thread pools.
+    using Edges = std::list<edge_t, tbb::scalable_allocator<edge_t>>;
+    using Nodes = std::list<node_t, tbb::scalable_allocator<node_t>>;
     Edges edges;
     Nodes nodes;
 };
@@ -16,6 +16,7 @@
 #include "Core/NFP/Kernels/TMArrangeKernel.hpp"
 #include "Core/NFP/Kernels/GravityKernel.hpp"
 #include "Core/NFP/RectangleOverfitPackingStrategy.hpp"
+#include "Core/Raster/PackStrategyRaster.hpp"
 #include "Core/Beds.hpp"
 
 #include "Items/MutableItemTraits.hpp"
@@ -265,6 +266,9 @@ class DefaultArranger: public Arranger<ArrItem> {
 
     static constexpr auto Accuracy = 1.;
 
+    // Pixel size of the bed raster in mm with the asRaster strategy.
+    static constexpr auto RasterPixelSize = .5;
+
     template<class It, class FixIt, class Bed>
     void arrange_(
         const Range<It>     &items,
@@ -299,6 +303,8 @@ class DefaultArranger: public Arranger<ArrItem> {
         default:
             [[fallthrough]];
         case ArrangeSettingsView::asAuto:
+            [[fallthrough]];
+        case ArrangeSettingsView::asRaster:
             if constexpr (std::is_convertible_v<Bed, CircleBed>){
                 basekernel = GravityKernel{};
             } else {
@@ -323,6 +329,20 @@ class DefaultArranger: public Arranger<ArrItem> {
                                                return is_wipe_tower(itm);
                                            });
 
+        // An infinite bed cannot be rasterized, it is arranged with NFPs. So
+        // is the wipe tower and the segmented bed of the XL printers, the
+        // raster strategy does not implement their special placement rules.
+        if constexpr (!std::is_convertible_v<Bed, InfiniteBed> && !IsSegmentedBed<Bed>) {
+            if (!with_wipe_tower &&
+                m_settings.get_arrange_strategy() == ArrangeSettingsView::asRaster) {
+                PackStrategyRaster ps{std::move(kernel), ep,
+                                      scaled(RasterPixelSize), stop_cond};
+
+                arr2::arrange(sel, ps, items, fixed, bed);
+                return;
+            }
+        }
+
         // With rectange bed, and no fixed items, let's use an infinite bed
         // with RectangleOverfitKernelWrapper. It produces better results than
         // a pure RectangleBed with inner-fit polygon calculation.
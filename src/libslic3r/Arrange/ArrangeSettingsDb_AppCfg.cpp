@@ -58,6 +58,9 @@ ArrangeSettingsDb_AppCfg::ArrangeSettingsDb_AppCfg(AppConfig *appcfg) : m_appcfg
     std::string strategy_str =
         m_appcfg->get("arrange", "arrange_strategy");
 
+    std::string incremental_str =
+        m_appcfg->get("arrange", "incremental");
+
     if (!dist_fff_str.empty())
         m_settings_fff.vals.d_obj = string_to_float_decimal_point(dist_fff_str);
 
@@ -129,6 +132,12 @@ ArrangeSettingsDb_AppCfg::ArrangeSettingsDb_AppCfg(AppConfig *appcfg) : m_appcfg
     m_settings_sla.vals.arr_strategy = arr_strategy;
     m_settings_fff.vals.arr_strategy = arr_strategy;
     m_settings_fff_seq.vals.arr_strategy = arr_strategy;
+
+    bool incremental = incremental_str == "1" || incremental_str == "yes";
+
+    m_settings_sla.vals.incremental = incremental;
+    m_settings_fff.vals.incremental = incremental;
+    m_settings_fff_seq.vals.incremental = incremental;
 }
 
 void ArrangeSettingsDb_AppCfg::distance_from_obj_range(float &min,
@@ -198,4 +207,12 @@ arr2::ArrangeSettingsDb& ArrangeSettingsDb_AppCfg::set_arrange_strategy(ArrangeS
     return *this;
 }
 
+arr2::ArrangeSettingsDb& ArrangeSettingsDb_AppCfg::set_incremental(bool v)
+{
+    m_settings_fff.vals.incremental = v;
+    m_appcfg->set("arrange", "incremental", v ? "1" : "0");
+
+    return *this;
+}
+
 } // namespace Slic3r
@@ -11,7 +11,9 @@ class ArrangeSettingsView
 {
 public:
     enum GeometryHandling { ghConvex, ghBalanced, ghAdvanced, ghCount };
-    enum ArrangeStrategy { asAuto, asPullToCenter, asCount };
+    // asRaster trades the accuracy of the arrangement for speed with large
+    // numbers of items.
+    enum ArrangeStrategy { asAuto, asPullToCenter, asRaster, asCount };
     enum XLPivots {
         xlpCenter,
         xlpRearLeft,
@@ -31,6 +33,10 @@ public:
     virtual XLPivots         get_xl_alignment() const      = 0;
     virtual GeometryHandling get_geometry_handling() const = 0;
     virtual ArrangeStrategy  get_arrange_strategy() const  = 0;
+
+    // Keep the objects which were not moved since the previous arrangement
+    // in place and only arrange the new or moved ones around them.
+    virtual bool is_incremental() const = 0;
 };
 
 class ArrangeSettingsDb: public ArrangeSettingsView
@@ -47,6 +53,7 @@ public:
     virtual ArrangeSettingsDb& set_xl_alignment(XLPivots v) = 0;
     virtual ArrangeSettingsDb& set_geometry_handling(GeometryHandling v) = 0;
     virtual ArrangeSettingsDb& set_arrange_strategy(ArrangeStrategy v) = 0;
+    virtual ArrangeSettingsDb& set_incremental(bool v) = 0;
 
     struct Values {
         float d_obj = 6.f, d_bed = 0.f;
@@ -54,6 +61,7 @@ public:
         XLPivots xl_align = XLPivots::xlpFrontLeft;
         GeometryHandling geom_handling = GeometryHandling::ghConvex;
         ArrangeStrategy  arr_strategy = ArrangeStrategy::asAuto;
+        bool incremental = false;
 
         Values() = default;
         Values(const ArrangeSettingsView &sv)
@@ -64,6 +72,7 @@ public:
             geom_handling = sv.get_geometry_handling();
             rotations = sv.is_rotation_enabled();
             xl_align = sv.get_xl_alignment();
+            incremental = sv.is_incremental();
         }
     };
 
@@ -77,6 +86,7 @@ public:
         set_geometry_handling(sv.get_geometry_handling());
         set_rotation_enabled(sv.is_rotation_enabled());
         set_xl_alignment(sv.get_xl_alignment());
+        set_incremental(sv.is_incremental());
 
         return *this;
     }
@@ -102,6 +112,7 @@ public:
     XLPivots get_xl_alignment() const override { return m_v.xl_align; }
     GeometryHandling get_geometry_handling() const override { return m_v.geom_handling; }
     ArrangeStrategy get_arrange_strategy() const override { return m_v.arr_strategy; }
+    bool is_incremental() const override { return m_v.incremental; }
 
     void distance_from_obj_range(float &min, float &max) const override { min = 0.f; max = 100.f; }
     void distance_from_bed_range(float &min, float &max) const override { min = 0.f; max = 100.f; }
@@ -112,6 +123,7 @@ public:
     ArrangeSettings& set_xl_alignment(XLPivots v) override { m_v.xl_align = v; return *this; }
     ArrangeSettings& set_geometry_handling(GeometryHandling v) override { m_v.geom_handling = v; return *this; }
     ArrangeSettings& set_arrange_strategy(ArrangeStrategy v) override { m_v.arr_strategy = v; return *this; }
+    ArrangeSettings& set_incremental(bool v) override { m_v.incremental = v; return *this; }
 
     auto & values() const { return m_v; }
     auto & values() { return m_v; }
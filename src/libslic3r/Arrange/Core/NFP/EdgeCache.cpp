@@ -9,17 +9,18 @@ namespace Slic3r { namespace arr2 {
 
 void EdgeCache::create_cache(const ExPolygon &sh)
 {
-    m_contour.distances.reserve(sh.contour.size());
-    m_holes.reserve(sh.holes.size());
-
+    // The vectors are cleared instead of being released, so that a reset
+    // cache does not allocate unless the new polygon is larger.
     m_contour.poly = &sh.contour;
-
+    m_contour.distances.clear();
     fill_distances(sh.contour, m_contour.distances);
 
-    for (const Polygon &hole : sh.holes) {
-        auto &hc = m_holes.emplace_back();
-        hc.poly = &hole;
-        fill_distances(hole, hc.distances);
+    m_holes.resize(sh.holes.size());
+    for (size_t i = 0; i < sh.holes.size(); ++i) {
+        auto &hc = m_holes[i];
+        hc.poly = &sh.holes[i];
+        hc.distances.clear();
+        fill_distances(sh.holes[i], hc.distances);
     }
 }
 
@@ -31,7 +31,7 @@ Vec2crd coords(const Polygon &poly, const std::vector<double>& distances, double
 // We also have to make this work for the holes of the captured polygon.
 class EdgeCache {
     struct ContourCache {
-        const Polygon *poly;
+        const Polygon *poly = nullptr;
         std::vector<double> distances;
     } m_contour;
 
@@ -43,11 +43,19 @@ class EdgeCache {
 
 public:
 
+    EdgeCache() = default;
+
     explicit EdgeCache(const ExPolygon *sh)
     {
         create_cache(*sh);
     }
 
+    // Recreate the cache for another polygon, reusing the allocated memory.
+    void reset(const ExPolygon *sh)
+    {
+        create_cache(*sh);
+    }
+
     // Given coeff for accuracy <0., 1.>, return the number of vertices to skip
     // when fetching corners.
     static inline size_t stride(const size_t N, double accuracy)
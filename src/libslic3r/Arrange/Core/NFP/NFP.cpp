@@ -18,6 +18,9 @@ namespace Slic3r { using LargeInt = boost::multiprecision::int128_t; }
 #endif
 
 #include <boost/rational.hpp>
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
 
 namespace Slic3r {
 
@@ -417,6 +420,74 @@ Polygon nfp_convex_convex_legacy(const Polygon &fixed, const Polygon &movable)
     return rsh;
 }
 
+namespace {
+
+struct NFPCacheKeyHash
+{
+    size_t operator()(const NFPCache::Key &key) const
+    {
+        size_t seed = 0;
+        boost::hash_combine(seed, key.fixed_id);
+        boost::hash_combine(seed, key.fixed_rotation);
+        boost::hash_combine(seed, key.movable_id);
+        boost::hash_combine(seed, key.movable_rotation);
+        return seed;
+    }
+};
+
+using NFPCacheStorage = LRUCache<NFPCache::Key, Polygons, NFPCacheKeyHash>;
+
+NFPCacheStorage &nfp_cache()
+{
+    static NFPCacheStorage instance(size_t(64) << 20, [](const NFPCache::Key &, const Polygons &nfp) {
+        size_t out = sizeof(NFPCache::Key) + nfp.capacity() * sizeof(Polygon);
+        for (const Polygon &poly : nfp)
+            out += poly.points.capacity() * sizeof(Point);
+        return out;
+    });
+    return instance;
+}
+
+} // namespace
+
+bool NFPCache::get(const Key &key, const Vec2crd &fixed_translation, Polygons &out)
+{
+    NFPCacheStorage::ValuePtr nfp = nfp_cache().find(key);
+    if (!nfp)
+        return false;
+
+    size_t first = out.size();
+    append(out, *nfp);
+    for (size_t i = first; i < out.size(); ++i)
+        out[i].translate(fixed_translation);
+
+    return true;
+}
+
+void NFPCache::put(const Key &key, const Vec2crd &fixed_translation, const Polygons &nfp)
+{
+    Polygons relative = nfp;
+    for (Polygon &poly : relative)
+        poly.translate(Point(-fixed_translation));
+
+    nfp_cache().insert(key, std::move(relative));
+}
+
+void NFPCache::set_memory_limit(size_t bytes)
+{
+    nfp_cache().set_memory_limit(bytes);
+}
+
+NFPCache::Stats NFPCache::stats()
+{
+    return nfp_cache().stats();
+}
+
+void NFPCache::clear()
+{
+    nfp_cache().clear();
+}
+
 } // namespace Slic3r
 
 #endif // NFP_CPP
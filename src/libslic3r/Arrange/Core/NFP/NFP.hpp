@@ -6,6 +6,7 @@
 #define NFP_HPP
 
 #include <libslic3r/ExPolygon.hpp>
+#include <libslic3r/LRUCache.hpp>
 #include <libslic3r/Arrange/Core/Beds.hpp>
 
 namespace Slic3r {
@@ -49,6 +50,51 @@ Vec2crd reference_vertex(const ExPolygons &outline);
 
 Vec2crd min_vertex(const Polygon &outline);
 
+// Process wide cache of the no-fit polygons of a movable shape around a fixed
+// shape, both given as sets of convex polygons.
+//
+// Arranging many copies of the same object, or filling the bed with them,
+// calculates the same NFPs over and over, only at different positions. The
+// shapes are identified by an id, which the caller guarantees to always refer
+// to the same contours, and by their rotation. The NFP only moves together
+// with the fixed shape, the translation of the movable shape does not change
+// it. Thus the NFPs are stored relative to the translation of the fixed shape.
+//
+// The ids are never reused, entries of shapes which are gone are only
+// released once the memory limit is exceeded, see LRUCache.
+class NFPCache
+{
+public:
+    struct Key
+    {
+        uint64_t fixed_id;
+        double   fixed_rotation;
+        uint64_t movable_id;
+        double   movable_rotation;
+
+        bool operator==(const Key &other) const
+        {
+            return fixed_id == other.fixed_id &&
+                   fixed_rotation == other.fixed_rotation &&
+                   movable_id == other.movable_id &&
+                   movable_rotation == other.movable_rotation;
+        }
+    };
+
+    using Stats = LRUCacheStats;
+
+    // Append the cached NFP moved to the translation of the fixed shape to out.
+    // Returns false if there is no such entry.
+    static bool get(const Key &key, const Vec2crd &fixed_translation, Polygons &out);
+
+    // Store the NFP calculated for the fixed shape at fixed_translation.
+    static void put(const Key &key, const Vec2crd &fixed_translation, const Polygons &nfp);
+
+    static void  set_memory_limit(size_t bytes);
+    static Stats stats();
+    static void  clear();
+};
+
 } // namespace Slic3r
 
 #endif // NFP_HPP
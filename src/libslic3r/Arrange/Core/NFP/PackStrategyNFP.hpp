@@ -54,6 +54,11 @@ struct PackStrategyNFP {
     opt::Optimizer<OptMethod> solver;
     StopCond stop_condition;
 
+    // Scratch space of pick_best_spot_on_nfp, kept to reuse the allocations
+    // for all the packed items and their rotations.
+    mutable std::vector<EdgeCache> edge_caches;
+    mutable std::vector<std::vector<ContourLocation>> sample_sets;
+
     PackStrategyNFP(opt::Optimizer<OptMethod> slv,
                     ArrangeKernel k = {},
                     ExecPolicy execpolicy = {},
@@ -149,29 +154,32 @@ double pick_best_spot_on_nfp(ArrItem                        &item,
     Vec2crd translation{0, 0};
     Vec2crd ref_v = reference_vertex(item);
 
-    auto edge_caches = reserve_vector<EdgeCache>(nfp.size());
-    auto sample_sets = reserve_vector<std::vector<ContourLocation>>(
-        nfp.size());
-
-    for (const ExPolygon &expoly : nfp) {
-        edge_caches.emplace_back(EdgeCache{&expoly});
-        edge_caches.back().sample_contour(strategy.accuracy,
-                                          sample_sets.emplace_back());
+    // The caches are only ever grown, the ones beyond nfp.size() keep their
+    // memory for later calls.
+    auto &edge_caches = strategy.edge_caches;
+    auto &sample_sets = strategy.sample_sets;
+    if (edge_caches.size() < nfp.size()) {
+        edge_caches.resize(nfp.size());
+        sample_sets.resize(nfp.size());
     }
 
     auto nthreads = execution::max_concurrency(ex_policy);
 
-    std::vector<CornerResult> gresults(edge_caches.size());
+    std::vector<CornerResult> gresults(nfp.size());
 
     auto resultcmp = [](auto &a, auto &b) {
         return a.oresult.score < b.oresult.score;
     };
 
     execution::for_each(
-        ex_policy, size_t(0), edge_caches.size(),
+        ex_policy, size_t(0), nfp.size(),
         [&](size_t edge_cache_idx) {
             auto &ec_contour = edge_caches[edge_cache_idx];
             auto &corners = sample_sets[edge_cache_idx];
+            ec_contour.reset(&nfp[edge_cache_idx]);
+            corners.clear();
+            ec_contour.sample_contour(strategy.accuracy, corners);
+
             std::vector<CornerResult> results(corners.size());
 
             auto cornerfn = [&](size_t i) {
@@ -0,0 +1,348 @@
+///|/ Copyright (c) Prusa Research 2023
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include "BitRaster.hpp"
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+
+#include <libslic3r/ClipperUtils.hpp>
+#include <libslic3r/Execution/ExecutionTBB.hpp>
+
+namespace Slic3r { namespace arr2 {
+
+using Word = BitRaster::Word;
+static constexpr int WordBits = BitRaster::WordBits;
+
+// The pixels of the bed are enlarged if needed to keep the rasters of large
+// beds within this width and height.
+static constexpr int MaxBedRasterSize = 4096;
+
+static int words_for_bits(int bits) { return (bits + WordBits - 1) / WordBits; }
+
+static int lowest_bit(Word w)
+{
+    assert(w != 0);
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(w);
+#else
+    int ret = 0;
+    for (; !(w & 1); w >>= 1)
+        ++ret;
+    return ret;
+#endif
+}
+
+static int64_t floor_div(int64_t a, int64_t b)
+{
+    int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+BitRaster::BitRaster(const Point &origin, coord_t pixel_size, int width, int height)
+    : m_origin{origin}
+    , m_pixel_size{std::max(coord_t(1), pixel_size)}
+    , m_width{std::max(0, width)}
+    , m_height{std::max(0, height)}
+{
+    m_words_per_row = words_for_bits(m_width);
+    m_bits.assign(size_t(m_words_per_row) * m_height, Word(0));
+}
+
+BitRaster BitRaster::aligned(const BitRaster &other, const BoundingBox &bb)
+{
+    if (!bb.defined)
+        return {};
+
+    Vec2i p0 = other.pixel(bb.min), p1 = other.pixel(bb.max);
+    Point origin{other.origin().x() + coord_t(int64_t(p0.x()) * other.pixel_size()),
+                 other.origin().y() + coord_t(int64_t(p0.y()) * other.pixel_size())};
+
+    return BitRaster{origin, other.pixel_size(), p1.x() - p0.x() + 1, p1.y() - p0.y() + 1};
+}
+
+Vec2i BitRaster::pixel(const Point &p) const
+{
+    return {int(floor_div(int64_t(p.x()) - m_origin.x(), m_pixel_size)),
+            int(floor_div(int64_t(p.y()) - m_origin.y(), m_pixel_size))};
+}
+
+void BitRaster::set_span(int y, int x0, int x1)
+{
+    x0 = std::max(x0, 0);
+    x1 = std::min(x1, m_width - 1);
+    if (y < 0 || y >= m_height || x0 > x1)
+        return;
+
+    Word *r = row(y);
+    int w0 = x0 / WordBits, w1 = x1 / WordBits;
+    Word lo = ~Word(0) << (x0 % WordBits);
+    Word hi = ~Word(0) >> (WordBits - 1 - x1 % WordBits);
+
+    if (w0 == w1) {
+        r[w0] |= lo & hi;
+    } else {
+        r[w0] |= lo;
+        std::fill(r + w0 + 1, r + w1, ~Word(0));
+        r[w1] |= hi;
+    }
+}
+
+namespace {
+
+struct PolygonRange
+{
+    const Polygon *first;
+    size_t         size;
+
+    const Polygon *begin() const { return first; }
+    const Polygon *end() const { return first + size; }
+};
+
+} // namespace
+
+// The pixels of a row are touched by the region where the region crosses the
+// bottom or the top line of the row, or where an edge of the region passes
+// through the row. The region is filled by the even-odd rule.
+static void fill_region_conservative(BitRaster &raster, std::initializer_list<PolygonRange> region)
+{
+    if (raster.empty())
+        return;
+
+    BoundingBox bb;
+    for (const PolygonRange &polys : region)
+        for (const Polygon &poly : polys)
+            bb.merge(get_extents(poly));
+
+    if (!bb.defined)
+        return;
+
+    const double ox = raster.origin().x(), oy = raster.origin().y();
+    const double px = raster.pixel_size();
+
+    auto column = [&raster, ox, px](double x) {
+        return int(std::clamp(std::floor((x - ox) / px), -1., double(raster.width())));
+    };
+
+    auto fill = [&raster, &column](int y, double x0, double x1) {
+        raster.set_span(y, column(std::min(x0, x1)), column(std::max(x0, x1)));
+    };
+
+    int y0 = std::max(raster.pixel(bb.min).y(), 0);
+    int y1 = std::min(raster.pixel(bb.max).y(), raster.height() - 1);
+
+    std::vector<double> crossings;
+    for (int y = y0; y <= y1; ++y) {
+        const double yb = oy + y * px, yt = yb + px;
+
+        for (double yline : {yb, yt}) {
+            crossings.clear();
+            for (const PolygonRange &polys : region)
+                for (const Polygon &poly : polys)
+                    for (size_t i = 0, j = poly.size() - 1; i < poly.size(); j = i++) {
+                        const Point &a = poly[j], &b = poly[i];
+                        if ((a.y() > yline) != (b.y() > yline))
+                            crossings.emplace_back(a.x() + (yline - a.y()) * double(b.x() - a.x()) / double(b.y() - a.y()));
+                    }
+
+            std::sort(crossings.begin(), crossings.end());
+            for (size_t i = 0; i + 1 < crossings.size(); i += 2)
+                fill(y, crossings[i], crossings[i + 1]);
+        }
+
+        for (const PolygonRange &polys : region)
+            for (const Polygon &poly : polys)
+                for (size_t i = 0, j = poly.size() - 1; i < poly.size(); j = i++) {
+                    const Point &a = poly[j], &b = poly[i];
+                    if (std::max(a.y(), b.y()) < yb || std::min(a.y(), b.y()) > yt)
+                        continue;
+
+                    if (a.y() == b.y()) {
+                        fill(y, a.x(), b.x());
+                    } else {
+                        double dy = double(b.y() - a.y());
+                        double t0 = std::clamp((yb - a.y()) / dy, 0., 1.);
+                        double t1 = std::clamp((yt - a.y()) / dy, 0., 1.);
+                        double dx = double(b.x() - a.x());
+                        fill(y, a.x() + t0 * dx, a.x() + t1 * dx);
+                    }
+                }
+    }
+}
+
+void BitRaster::fill_conservative(const Polygon &poly)
+{
+    fill_region_conservative(*this, {PolygonRange{&poly, 1}});
+}
+
+void BitRaster::fill_conservative(const ExPolygon &expoly)
+{
+    fill_region_conservative(*this, {PolygonRange{&expoly.contour, 1},
+                                     PolygonRange{expoly.holes.data(), expoly.holes.size()}});
+}
+
+size_t BitRaster::count() const
+{
+    size_t ret = 0;
+    for (Word w : m_bits)
+        ret += std::bitset<WordBits>(w).count();
+
+    return ret;
+}
+
+static BitRaster bed_grid(const BoundingBox &bb, coord_t pixel_size)
+{
+    Vec2crd sz = bb.size();
+    coord_t maxdim = std::max(sz.x(), sz.y());
+    pixel_size = std::max({pixel_size, coord_t(1), coord_t(maxdim / MaxBedRasterSize + 1)});
+
+    // Only the pixels fully inside the bounding box.
+    return BitRaster{bb.min, pixel_size, int(sz.x() / pixel_size), int(sz.y() / pixel_size)};
+}
+
+static BitRaster rasterize_bed(const ExPolygons &bed, const BoundingBox &bb, coord_t pixel_size)
+{
+    BitRaster ret = bed_grid(bb, pixel_size);
+
+    BoundingBox outer = bb;
+    outer.offset(ret.pixel_size());
+    ExPolygons outside = diff_ex(to_rectangle(outer), bed);
+    for (const ExPolygon &expoly : outside)
+        ret.fill_conservative(expoly);
+
+    return ret;
+}
+
+BitRaster rasterize_bed(const RectangleBed &bed, coord_t pixel_size)
+{
+    return bed_grid(bed.bb, pixel_size);
+}
+
+BitRaster rasterize_bed(const CircleBed &bed, coord_t pixel_size)
+{
+    return rasterize_bed(to_expolygons(bed), bounding_box(bed), pixel_size);
+}
+
+BitRaster rasterize_bed(const IrregularBed &bed, coord_t pixel_size)
+{
+    return rasterize_bed(bed.poly, bounding_box(bed), pixel_size);
+}
+
+// dst[x] |= src[x + k], reading zeros beyond the end of src.
+static void or_shifted(const Word *src, int nsrc, int k, Word *dst, int ndst)
+{
+    int ws = k / WordBits, bs = k % WordBits;
+    for (int w = 0; w < ndst; ++w) {
+        Word lo = w + ws < nsrc ? src[w + ws] : 0;
+        if (bs == 0) {
+            dst[w] |= lo;
+        } else {
+            Word hi = w + ws + 1 < nsrc ? src[w + ws + 1] : 0;
+            dst[w] |= (lo >> bs) | (hi << (WordBits - bs));
+        }
+    }
+}
+
+// dst[x] = src[x] | src[x + 1] | ... | src[x + len - 1] in log(len) steps.
+// Shifting in place is fine, each word only reads the words above it.
+static void spread(const Word *src, int n, int len, Word *dst)
+{
+    std::copy(src, src + n, dst);
+
+    int p = 1;
+    for (; 2 * p <= len; p *= 2)
+        or_shifted(dst, n, p, dst, n);
+
+    if (p < len)
+        or_shifted(dst, n, len - p, dst, n);
+}
+
+std::vector<Vec2i> free_corner_placements(const BitRaster &occupied, const BitRaster &item)
+{
+    std::vector<Vec2i> ret;
+
+    if (occupied.empty() || item.empty())
+        return ret;
+
+    assert(occupied.pixel_size() == item.pixel_size());
+
+    const int wf = occupied.width() - item.width() + 1;
+    const int hf = occupied.height() - item.height() + 1;
+    if (wf <= 0 || hf <= 0)
+        return ret;
+
+    struct Span { int row, x0, len; size_t len_idx; };
+    std::vector<Span> spans;
+    std::vector<int>  lengths;
+    for (int r = 0; r < item.height(); ++r)
+        for (int x = 0; x < item.width();) {
+            if (!item.get(x, r)) {
+                ++x;
+                continue;
+            }
+            int x0 = x;
+            while (x < item.width() && item.get(x, r))
+                ++x;
+            spans.push_back({r, x0, x - x0, 0});
+            lengths.emplace_back(x - x0);
+        }
+
+    std::sort(lengths.begin(), lengths.end());
+    lengths.erase(std::unique(lengths.begin(), lengths.end()), lengths.end());
+    for (Span &s : spans)
+        s.len_idx = std::lower_bound(lengths.begin(), lengths.end(), s.len) - lengths.begin();
+
+    // Rows of the occupied raster, where bit x is set if any of the pixels
+    // x .. x + len - 1 is occupied, for each of the span lengths of the item.
+    const int nwo = occupied.words_per_row();
+    std::vector<std::vector<Word>> dilated(lengths.size(), std::vector<Word>(size_t(occupied.height()) * nwo));
+    execution::for_each(ex_tbb, 0, occupied.height(), [&](int y) {
+        for (size_t l = 0; l < lengths.size(); ++l)
+            spread(occupied.row(y), nwo, lengths[l], dilated[l].data() + size_t(y) * nwo);
+    }, 16);
+
+    // Bit x of row y is set if the item placed at (x, y) would overlap an
+    // occupied pixel. The padding bits are set, the positions are not valid.
+    const int nwf = words_for_bits(wf);
+    const Word padding = wf % WordBits == 0 ? Word(0) : ~Word(0) << (wf % WordBits);
+    std::vector<Word> forbidden(size_t(hf) * nwf);
+    execution::for_each(ex_tbb, 0, hf, [&](int y) {
+        Word *f = forbidden.data() + size_t(y) * nwf;
+        for (const Span &s : spans)
+            or_shifted(dilated[s.len_idx].data() + size_t(y + s.row) * nwo, nwo, s.x0, f, nwf);
+        f[nwf - 1] |= padding;
+    }, 16);
+
+    // The free positions next to a forbidden position or to the border of
+    // the raster both horizontally and vertically.
+    std::vector<std::vector<Vec2i>> row_corners(hf);
+    const std::vector<Word> all_forbidden(nwf, ~Word(0));
+    execution::for_each(ex_tbb, 0, hf, [&](int y) {
+        const Word *f     = forbidden.data() + size_t(y) * nwf;
+        const Word *below = y > 0 ? f - nwf : all_forbidden.data();
+        const Word *above = y + 1 < hf ? f + nwf : all_forbidden.data();
+
+        for (int w = 0; w < nwf; ++w) {
+            Word left  = (f[w] << 1) | (w > 0 ? f[w - 1] >> (WordBits - 1) : Word(1));
+            Word right = (f[w] >> 1) | ((w + 1 < nwf ? f[w + 1] : ~Word(0)) << (WordBits - 1));
+            Word corners = ~f[w] & (left | right) & (below[w] | above[w]);
+
+            for (; corners; corners &= corners - 1)
+                row_corners[y].emplace_back(w * WordBits + lowest_bit(corners), y);
+        }
+    }, 16);
+
+    size_t cnt = 0;
+    for (const auto &rc : row_corners)
+        cnt += rc.size();
+
+    ret.reserve(cnt);
+    for (const auto &rc : row_corners)
+        ret.insert(ret.end(), rc.begin(), rc.end());
+
+    return ret;
+}
+
+}} // namespace Slic3r::arr2
@@ -0,0 +1,97 @@
+///|/ Copyright (c) Prusa Research 2023
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef BITRASTER_HPP
+#define BITRASTER_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <libslic3r/ExPolygon.hpp>
+#include <libslic3r/BoundingBox.hpp>
+#include <libslic3r/Arrange/Core/Beds.hpp>
+
+namespace Slic3r { namespace arr2 {
+
+// Binary raster of a rectangular area with one bit per pixel. Pixel (x, y)
+// covers the square [origin + (x, y) * pixel_size, origin + (x + 1, y + 1) * pixel_size).
+// The rows are stored in whole 64 bit words, so that the rasters can be
+// combined a word at a time.
+class BitRaster
+{
+public:
+    using Word = uint64_t;
+    static constexpr int WordBits = 64;
+
+    BitRaster() = default;
+    BitRaster(const Point &origin, coord_t pixel_size, int width, int height);
+
+    // Empty raster of the pixels of the grid of other, which cover bb.
+    static BitRaster aligned(const BitRaster &other, const BoundingBox &bb);
+
+    const Point &origin() const { return m_origin; }
+    coord_t      pixel_size() const { return m_pixel_size; }
+    int          width() const { return m_width; }
+    int          height() const { return m_height; }
+    int          words_per_row() const { return m_words_per_row; }
+    bool         empty() const { return m_width <= 0 || m_height <= 0; }
+
+    const Word *row(int y) const { return m_bits.data() + size_t(y) * m_words_per_row; }
+    Word       *row(int y) { return m_bits.data() + size_t(y) * m_words_per_row; }
+
+    bool get(int x, int y) const { return (row(y)[x / WordBits] >> (x % WordBits)) & 1; }
+    void set(int x, int y) { row(y)[x / WordBits] |= Word(1) << (x % WordBits); }
+
+    // Set the pixels x0..x1 of row y, both inclusive.
+    void set_span(int y, int x0, int x1);
+
+    // Set all the pixels touched by the polygon, including the ones only
+    // touched by its outline, so that two shapes filled into disjoint sets of
+    // pixels never overlap.
+    void fill_conservative(const Polygon &poly);
+    void fill_conservative(const ExPolygon &expoly);
+
+    // Pixel containing the point p, may be outside of the raster.
+    Vec2i pixel(const Point &p) const;
+
+    size_t count() const;
+
+private:
+    Point             m_origin{0, 0};
+    coord_t           m_pixel_size = 1;
+    int               m_width = 0, m_height = 0, m_words_per_row = 0;
+    std::vector<Word> m_bits;
+};
+
+// Raster of the bounding box of the bed with the pixels not fully inside the
+// bed being set. An infinite bed cannot be rasterized, the raster is empty.
+BitRaster rasterize_bed(const RectangleBed &bed, coord_t pixel_size);
+BitRaster rasterize_bed(const CircleBed &bed, coord_t pixel_size);
+BitRaster rasterize_bed(const IrregularBed &bed, coord_t pixel_size);
+inline BitRaster rasterize_bed(const InfiniteBed &, coord_t) { return {}; }
+
+inline BitRaster rasterize_bed(const ArrangeBed &bed, coord_t pixel_size)
+{
+    BitRaster ret;
+    auto visitor = [&ret, pixel_size](const auto &b) { ret = rasterize_bed(b, pixel_size); };
+    boost::apply_visitor(visitor, bed);
+
+    return ret;
+}
+
+// Positions of the pixel (0, 0) of item in the grid of occupied, where the set
+// pixels of item don't overlap the set pixels of occupied and the item stays
+// within occupied. Out of these, only the corners are returned: the positions
+// which touch an occupied position from the left or right and also from below
+// or above, similarly to the vertices of a no fit polygon. The corners are
+// ordered by rows, then by columns. item has to be aligned to occupied.
+//
+// Instead of testing each position, the occupied rows are dilated by the
+// spans of the item rows with wide shifts and ORs, so that the cost does not
+// depend on the length of the spans much.
+std::vector<Vec2i> free_corner_placements(const BitRaster &occupied, const BitRaster &item);
+
+}} // namespace Slic3r::arr2
+
+#endif // BITRASTER_HPP
@@ -0,0 +1,200 @@
+///|/ Copyright (c) Prusa Research 2023
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef PACKSTRATEGYRASTER_HPP
+#define PACKSTRATEGYRASTER_HPP
+
+#include "BitRaster.hpp"
+
+#include "libslic3r/Arrange/Core/NFP/PackStrategyNFP.hpp"
+#include "libslic3r/Execution/ExecutionTBB.hpp"
+
+namespace Slic3r { namespace arr2 {
+
+struct RasterPackingTag {};
+
+// Packing strategy trading the exactness of PackStrategyNFP for speed when
+// arranging large numbers of items. The bed and the items are rasterized with
+// the given pixel size. The items are dilated to whole pixels, thus they never
+// overlap, but they may be placed up to two pixels further from each other
+// than needed. The candidate positions are the corners of the free area of the
+// raster, ranked by the kernel the same way the vertices of a NFP are.
+template<class ArrangeKernel = DummyArrangeKernel,
+         class ExecPolicy = ExecutionTBB,
+         class StopCond = DefaultStopCondition>
+struct PackStrategyRaster {
+    ArrangeKernel kernel;
+    ExecPolicy ep;
+    coord_t pixel_size;
+    StopCond stop_condition;
+
+    // Only every n-th of the corners is ranked by the kernel above this count.
+    size_t max_candidates = 2048;
+
+    PackStrategyRaster(ArrangeKernel k = {},
+                       ExecPolicy execpolicy = {},
+                       coord_t pxsize = scaled(0.5),
+                       StopCond stop_cond = {})
+        : kernel{std::move(k)},
+          ep{std::move(execpolicy)},
+          pixel_size{pxsize},
+          stop_condition{std::move(stop_cond)}
+    {}
+};
+
+template<class... Args>
+struct PackStrategyTag_<PackStrategyRaster<Args...>>
+{
+    using Tag = RasterPackingTag;
+};
+
+// The default packing context extended with the raster of the occupied area
+// of the bed, updated with each fixed and packed item.
+template<class ArrItem>
+struct RasterPackingContext : public DefaultPackingContext<ArrItem>
+{
+    BitRaster occupied;
+
+    explicit RasterPackingContext(BitRaster bedraster)
+        : occupied{std::move(bedraster)}
+    {}
+
+    template<class Itm> void rasterize(const Itm &itm)
+    {
+        for (const Polygon &poly : fixed_outline(itm))
+            occupied.fill_conservative(poly);
+    }
+};
+
+template<class... Args>
+struct PackStrategyTraits_<PackStrategyRaster<Args...>> {
+    template<class ArrItem> using Context = RasterPackingContext<ArrItem>;
+
+    template<class ArrItem, class Bed>
+    static Context<ArrItem> create_context(PackStrategyRaster<Args...> &ps,
+                                           const Bed &bed,
+                                           int bed_index)
+    {
+        return Context<ArrItem>{rasterize_bed(bed, ps.pixel_size)};
+    }
+};
+
+template<class ArrItem>
+struct PackingContextTraits_<RasterPackingContext<ArrItem>>
+    : public PackingContextTraits_<DefaultPackingContext<ArrItem>>
+{
+    static void add_fixed_item(RasterPackingContext<ArrItem> &ctx, const ArrItem &itm)
+    {
+        ctx.add_fixed_item(itm);
+        ctx.rasterize(itm);
+    }
+
+    static void add_packed_item(RasterPackingContext<ArrItem> &ctx, ArrItem &itm)
+    {
+        ctx.add_packed_item(itm);
+        ctx.rasterize(itm);
+    }
+};
+
+template<class ArrItem, class... Args>
+double pick_best_spot_on_raster(ArrItem                           &item,
+                                const BitRaster                   &occupied,
+                                const PackStrategyRaster<Args...> &strategy)
+{
+    using KernelT = KernelTraits<decltype(strategy.kernel)>;
+
+    auto score = -std::numeric_limits<double>::infinity();
+
+    BitRaster itmraster = BitRaster::aligned(occupied, envelope_bounding_box(item));
+    for (const Polygon &poly : envelope_outline(item))
+        itmraster.fill_conservative(poly);
+
+    std::vector<Vec2i> corners = free_corner_placements(occupied, itmraster);
+    if (corners.empty())
+        return score;
+
+    Vec2i itmpos = occupied.pixel(itmraster.origin());
+    auto translation_to = [&itmpos, &occupied](const Vec2i &corner) {
+        return Vec2crd{(corner - itmpos).cast<coord_t>() * occupied.pixel_size()};
+    };
+
+    size_t stride = corners.size() / strategy.max_candidates + 1;
+    std::vector<double> scores(corners.size() / stride);
+
+    execution::for_each(strategy.ep, size_t(0), scores.size(), [&](size_t i) {
+        scores[i] = KernelT::placement_fitness(strategy.kernel, item,
+                                               translation_to(corners[i * stride]));
+    }, execution::max_concurrency(strategy.ep));
+
+    // The NaN scores are discarded positions, they rank below anything else.
+    auto it = std::max_element(scores.begin(), scores.end(), [](double a, double b) {
+        return std::isnan(a) ? !std::isnan(b) : !std::isnan(b) && a < b;
+    });
+
+    if (it != scores.end() && !std::isnan(*it)) {
+        score = *it;
+        size_t idx = std::distance(scores.begin(), it) * stride;
+        set_translation(item, get_translation(item) + translation_to(corners[idx]));
+    }
+
+    return score;
+}
+
+template<class Strategy, class ArrItem, class Bed, class RemIt>
+bool pack(Strategy &strategy,
+          const Bed &bed,
+          ArrItem &item,
+          const PackStrategyContext<Strategy, ArrItem> &packing_context,
+          const Range<RemIt> &remaining_items,
+          const RasterPackingTag &)
+{
+    using KernelT = KernelTraits<decltype(strategy.kernel)>;
+
+    // The kernel might pack the item immediately
+    bool packed = KernelT::on_start_packing(strategy.kernel, item, bed,
+                                            packing_context, remaining_items);
+
+    double  orig_rot    = get_rotation(item);
+    double  final_rot   = 0.;
+    double  final_score = -std::numeric_limits<double>::infinity();
+    Vec2crd orig_tr     = get_translation(item);
+    Vec2crd final_tr    = orig_tr;
+
+    bool cancelled = strategy.stop_condition();
+    const auto & rotations = allowed_rotations(item);
+
+    for (auto rot_it = rotations.begin();
+         !cancelled && !packed && rot_it != rotations.end(); ++rot_it) {
+
+        double rot = *rot_it;
+
+        set_rotation(item, orig_rot + rot);
+        set_translation(item, orig_tr);
+
+        double score = pick_best_spot_on_raster(item, packing_context.occupied, strategy);
+
+        cancelled = strategy.stop_condition();
+        if (score > final_score) {
+            final_score = score;
+            final_rot   = rot;
+            final_tr    = get_translation(item);
+        }
+    }
+
+    bool is_score_valid = !std::isnan(final_score) && !std::isinf(final_score);
+    packed = !cancelled && (packed || is_score_valid);
+
+    if (packed) {
+        set_translation(item, final_tr);
+        set_rotation(item, orig_rot + final_rot);
+
+        packed = KernelT::on_item_packed(strategy.kernel, item);
+    }
+
+    return packed;
+}
+
+}} // namespace Slic3r::arr2
+
+#endif // PACKSTRATEGYRASTER_HPP
@@ -15,6 +15,12 @@
 
 namespace Slic3r { namespace arr2 {
 
+uint64_t DecomposedShape::next_id()
+{
+    static std::atomic<uint64_t> counter{0};
+    return ++counter;
+}
+
 const Polygons &DecomposedShape::transformed_outline() const
 {
     constexpr auto sc = scaled<double>(1.) * scaled<double>(1.);
@@ -26,6 +26,9 @@
 #include "libslic3r/Arrange/Items/ArbitraryDataStore.hpp"
 
 #include <libslic3r/ClipperUtils.hpp>
+#include <libslic3r/Execution/ExecutionTBB.hpp>
+
+#include <atomic>
 
 namespace Slic3r { namespace arr2 {
 
@@ -48,6 +51,10 @@ class DecomposedShape
 {
     Polygons m_shape;
 
+    // Identifies the contours for caching the NFPs, copies of the shape share
+    // it. Zero for a default constructed shape, which is not cached.
+    uint64_t m_id = 0;
+
     Vec2crd m_translation{0, 0}; // The translation of the poly
     double  m_rotation{0.0};     // The rotation of the poly in radians
 
@@ -69,7 +76,7 @@ class DecomposedShape
 public:
     DecomposedShape() = default;
 
-    explicit DecomposedShape(Polygon sh)
+    explicit DecomposedShape(Polygon sh) : m_id{next_id()}
     {
         m_shape.emplace_back(std::move(sh));
         assert(check_polygons_are_convex(m_shape));
@@ -79,13 +86,19 @@ public:
         : DecomposedShape(Polygon{pts})
     {}
 
-    explicit DecomposedShape(Polygons sh) : m_shape{std::move(sh)}
+    explicit DecomposedShape(Polygons sh)
+        : m_shape{std::move(sh)}, m_id{next_id()}
     {
         assert(check_polygons_are_convex(m_shape));
     }
 
     const Polygons &contours() const { return m_shape; }
 
+    // The contours are never modified, thus two shapes of the same id only
+    // differ in their transformation. Unique for the lifetime of the process.
+    uint64_t id() const { return m_id; }
+    static uint64_t next_id();
+
     const Vec2crd &translation() const { return m_translation; }
     double         rotation() const { return m_rotation; }
 
@@ -281,36 +294,59 @@ template<> struct WritableDataStoreTraits_<ArrangeItem>
     }
 };
 
-template<class FixedIt, class StopCond = DefaultStopCondition>
+// The NFPs of the fixed items are calculated in parallel, each one is united
+// on its own. The partial results are returned in the order of the fixed
+// items without a final union, which is left to the caller, as it clips the
+// result with the bed anyway. The NFPs of identified shapes are shared through
+// NFPCache, so that the copies of an object are only calculated once for each
+// pair of rotations.
+template<class FixedIt, class StopCond = DefaultStopCondition, class ExecPolicy = ExecutionTBB>
 static Polygons calculate_nfp_unnormalized(const ArrangeItem    &item,
                                            const Range<FixedIt> &fixed_items,
-                                           StopCond &&stop_cond = {})
+                                           StopCond &&stop_cond = {},
+                                           const ExecPolicy &ep = {})
 {
-    size_t cap = 0;
+    auto fixed_ptrs = reserve_vector<const ArrangeItem *>(fixed_items.size());
 
+    // The caches of the shapes are not thread safe, they are updated here.
     for (const ArrangeItem &fixitem : fixed_items) {
-        const Polygons &outlines = fixitem.shape().transformed_outline();
-        cap += outlines.size();
+        fixitem.shape().transformed_outline();
+        fixed_ptrs.emplace_back(&fixitem);
     }
 
     const Polygons &item_outlines = item.envelope().transformed_outline();
 
-    auto nfps = reserve_polygons(cap * item_outlines.size());
-
     Vec2crd ref_whole = item.envelope().reference_vertex();
-    Polygon subnfp;
 
-    for (const ArrangeItem &fixed : fixed_items) {
+    std::vector<Polygons> fixed_nfps(fixed_ptrs.size());
+    std::atomic<bool> cancelled = false;
+
+    execution::for_each(ep, size_t(0), fixed_ptrs.size(), [&](size_t fixed_idx) {
+        if (cancelled.load(std::memory_order_relaxed) || stop_cond()) {
+            cancelled.store(true, std::memory_order_relaxed);
+            return;
+        }
+
+        const DecomposedShape &fixed_shape = fixed_ptrs[fixed_idx]->shape();
+        Polygons &nfps = fixed_nfps[fixed_idx];
+
+        NFPCache::Key key{fixed_shape.id(), fixed_shape.rotation(),
+                          item.envelope().id(), item.envelope().rotation()};
+        bool cacheable = key.fixed_id > 0 && key.movable_id > 0;
+        if (cacheable && NFPCache::get(key, fixed_shape.translation(), nfps))
+            return;
+
         // fixed_polys should already be a set of strictly convex polygons,
         // as ArrangeItem stores convex-decomposed polygons
-        const Polygons & fixed_polys = fixed.shape().transformed_outline();
+        const Polygons & fixed_polys = fixed_shape.transformed_outline();
+        nfps.reserve(fixed_polys.size() * item_outlines.size());
 
         for (const Polygon &fixed_poly : fixed_polys) {
             Point max_fixed = Slic3r::reference_vertex(fixed_poly);
             for (size_t mi = 0; mi < item_outlines.size(); ++mi) {
                 const Polygon &movable = item_outlines[mi];
                 const Vec2crd &mref = item.envelope().reference_vertex(mi);
-                subnfp = nfp_convex_convex_legacy(fixed_poly, movable);
+                Polygon subnfp = nfp_convex_convex_legacy(fixed_poly, movable);
 
                 Vec2crd min_movable = item.envelope().min_vertex(mi);
 
@@ -321,19 +357,26 @@ static Polygons calculate_nfp_unnormalized(const ArrangeItem    &item,
 
                 auto d = ref_whole - mref + dnfp;
                 subnfp.translate(d);
-                nfps.emplace_back(subnfp);
+                nfps.emplace_back(std::move(subnfp));
             }
+        }
 
-            if (stop_cond())
-                break;
-
+        if (nfps.size() > 1)
             nfps = union_(nfps);
-        }
 
-        if (stop_cond()) {
-            nfps.clear();
-            break;
-        }
+        if (cacheable)
+            NFPCache::put(key, fixed_shape.translation(), nfps);
+    });
+
+    Polygons nfps;
+    if (!cancelled && !stop_cond()) {
+        size_t cap = 0;
+        for (const Polygons &fnfps : fixed_nfps)
+            cap += fnfps.size();
+
+        nfps.reserve(cap);
+        for (Polygons &fnfps : fixed_nfps)
+            append(nfps, std::move(fnfps));
     }
 
     return nfps;
@@ -5,6 +5,9 @@
 #ifndef ARRANGETASK_HPP
 #define ARRANGETASK_HPP
 
+#include <map>
+
+#include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/Arrange/Arrange.hpp"
 #include "libslic3r/Arrange/Items/TrafoOnlyArrangeItem.hpp"
 
@@ -41,6 +44,121 @@ struct ArrangeTaskResult : public ArrangeResult
     }
 };
 
+// Remembers the items packed by an ArrangeTask together with the outlines
+// their arrangeables will have once the result is applied. Handed to
+// the next ArrangeTask, the items which were not moved since then are kept in
+// place. They are added to the packing contexts as fixed items, reusing their
+// already decomposed shapes, and only the new or moved items are packed around
+// them. Explicitly selected items are arranged as usual. If nothing was added
+// or moved, everything is arranged again. The whole outlines are compared, so
+// mirrored, rotated or edited objects are arranged again as well, even if
+// their bounding box did not change.
+template<class ArrItem> class IncrementalArrangeState
+{
+    struct Entry
+    {
+        ArrItem    item;
+        ExPolygons outline;
+    };
+
+    std::map<ObjectID, Entry>      m_entries, m_prev_entries;
+    std::map<ObjectID, ExPolygons> m_source_outlines;
+
+    ArrangeSettingsDb::Values m_settings;
+    BoundingBox               m_bedbb;
+
+    // The outlines are compared with a tolerance, applying the result of the
+    // arrangement to the model may introduce rounding errors.
+    static constexpr coord_t OutlineTolerance = scaled(0.01);
+
+public:
+    // Called when a new task is created, the remembered items are only valid
+    // with the same settings and bed.
+    void start(const ArrangeSettingsView &settings, const BoundingBox &bedbb)
+    {
+        ArrangeSettingsDb::Values v{settings};
+        bool same = v.d_obj == m_settings.d_obj && v.d_bed == m_settings.d_bed &&
+                    v.rotations == m_settings.rotations &&
+                    v.xl_align == m_settings.xl_align &&
+                    v.geom_handling == m_settings.geom_handling &&
+                    v.arr_strategy == m_settings.arr_strategy &&
+                    bedbb.min == m_bedbb.min && bedbb.max == m_bedbb.max;
+
+        m_prev_entries.clear();
+        if (same)
+            m_prev_entries.swap(m_entries);
+
+        m_entries.clear();
+        m_source_outlines.clear();
+        m_settings = v;
+        m_bedbb    = bedbb;
+    }
+
+    // The outline of arrbl which is compared with the remembered one. Only
+    // the convex hull matters for the arrangement with ghConvex.
+    ExPolygons outline(const Arrangeable &arrbl) const
+    {
+        if (m_settings.geom_handling == ArrangeSettingsView::ghConvex) {
+            Polygon chull = arrbl.convex_outline();
+            return chull.empty() ? ExPolygons{} : ExPolygons{ExPolygon{std::move(chull)}};
+        }
+
+        return arrbl.full_outline();
+    }
+
+    // Returns the remembered item of arrbl if it was not moved since, nullptr
+    // otherwise. outline is the current outline of arrbl, see outline().
+    const ArrItem *keep_if_unchanged(const Arrangeable &arrbl, const ExPolygons &outline)
+    {
+        auto it = m_prev_entries.find(arrbl.id());
+        if (it == m_prev_entries.end() || outline.empty() ||
+            get_bed_index(it->second.item) != arrbl.get_bed_index())
+            return nullptr;
+
+        const ExPolygons &prev = it->second.outline;
+        if (!diff(outline, offset(prev, float(OutlineTolerance))).empty() ||
+            !diff(prev, offset(outline, float(OutlineTolerance))).empty())
+            return nullptr;
+
+        return &m_entries.insert(m_prev_entries.extract(it)).position->second.item;
+    }
+
+    // Outline of the arrangeable of an item before arranging it.
+    void set_source_outline(const ObjectID &id, ExPolygons outline)
+    {
+        m_source_outlines[id] = std::move(outline);
+    }
+
+    // Remember an item after it was arranged.
+    void remember(const ArrItem &itm)
+    {
+        auto id = retrieve_id(itm);
+        if (!id || !is_arranged(itm))
+            return;
+
+        auto it = m_source_outlines.find(*id);
+        if (it == m_source_outlines.end() || it->second.empty())
+            return;
+
+        ExPolygons outline = it->second;
+        for (ExPolygon &expoly : outline) {
+            expoly.rotate(get_rotation(itm));
+            expoly.translate(get_translation(itm));
+        }
+
+        m_entries.insert_or_assign(*id, Entry{itm, std::move(outline)});
+    }
+
+    size_t size() const noexcept { return m_entries.size(); }
+
+    void clear()
+    {
+        m_entries.clear();
+        m_prev_entries.clear();
+        m_source_outlines.clear();
+    }
+};
+
 template<class ArrItem> struct ArrangeTask : public ArrangeTaskBase
 {
     struct ArrangeSet
@@ -51,14 +169,19 @@ template<class ArrItem> struct ArrangeTask : public ArrangeTaskBase
     ExtendedBed     bed;
     ArrangeSettings settings;
 
+    // Optional, see IncrementalArrangeState. Updated by process_native().
+    std::shared_ptr<IncrementalArrangeState<ArrItem>> incremental_state;
+
     static std::unique_ptr<ArrangeTask> create(
         const Scene                        &sc,
-        const ArrangeableToItemConverter<ArrItem> &converter);
+        const ArrangeableToItemConverter<ArrItem> &converter,
+        std::shared_ptr<IncrementalArrangeState<ArrItem>> state = {});
 
-    static std::unique_ptr<ArrangeTask> create(const Scene &sc)
+    static std::unique_ptr<ArrangeTask> create(
+        const Scene &sc, std::shared_ptr<IncrementalArrangeState<ArrItem>> state = {})
     {
         auto conv = ArrangeableToItemConverter<ArrItem>::create(sc);
-        return create(sc, *conv);
+        return create(sc, *conv, std::move(state));
     }
 
     std::unique_ptr<ArrangeResult> process(Ctl &ctl) override
@@ -14,18 +14,34 @@
 namespace Slic3r { namespace arr2 {
 
 // Prepare the selected and unselected items separately. If nothing is
-// selected, behaves as if everything would be selected.
+// selected, behaves as if everything would be selected. With an incremental
+// state, the items not moved since the previous arrangement stay fixed then.
 template<class ArrItem>
 void extract_selected(ArrangeTask<ArrItem> &task,
                       const ArrangeableModel &mdl,
                       const ArrangeableToItemConverter<ArrItem> &itm_conv)
 {
+    IncrementalArrangeState<ArrItem> *state = task.incremental_state.get();
+
+    // Items kept from the previous arrangement of the incremental state
+    std::vector<ArrItem> kept_printable, kept_unprintable;
+
     // Go through the objects and check if inside the selection
     mdl.for_each_arrangeable(
-        [&task, &itm_conv](const Arrangeable &arrbl) {
+        [&task, &itm_conv, state, &kept_printable, &kept_unprintable](const Arrangeable &arrbl) {
             bool selected = arrbl.is_selected();
             bool printable = arrbl.is_printable();
 
+            ExPolygons outline;
+            if (state) {
+                outline = state->outline(arrbl);
+                if (const ArrItem *itm = selected ? nullptr : state->keep_if_unchanged(arrbl, outline)) {
+                    (printable ? kept_printable : kept_unprintable).emplace_back(*itm);
+                    state->set_source_outline(arrbl.id(), std::move(outline));
+                    return;
+                }
+            }
+
             try {
                 auto itm = itm_conv.convert(arrbl, selected ? 0 : -SCALED_EPSILON);
 
@@ -37,22 +53,44 @@ void extract_selected(ArrangeTask<ArrItem> &task,
                                        container_parent.unselected;
 
                 container.emplace_back(std::move(itm));
+
+                if (state)
+                    state->set_source_outline(arrbl.id(), std::move(outline));
             } catch (const EmptyItemOutlineError &ex) {
                 BOOST_LOG_TRIVIAL(error)
                     << "ObjectID " << std::to_string(arrbl.id().id) << ": " << ex.what();
             }
         });
 
+    bool nothing_selected = task.printable.selected.empty() &&
+                            task.unprintable.selected.empty();
+
+    bool anything_changed = !task.printable.unselected.empty() ||
+                            !task.unprintable.unselected.empty();
+
     // If the selection was empty arrange everything
-    if (task.printable.selected.empty() && task.unprintable.selected.empty()) {
+    if (nothing_selected) {
         task.printable.selected.swap(task.printable.unselected);
         task.unprintable.selected.swap(task.unprintable.unselected);
     }
+
+    // The kept items are fixed, unless there is nothing else to arrange
+    auto add_kept = [nothing_selected, anything_changed](auto &set, std::vector<ArrItem> &kept) {
+        auto &container = nothing_selected && !anything_changed ? set.selected :
+                                                                  set.unselected;
+
+        std::move(kept.begin(), kept.end(), std::back_inserter(container));
+    };
+
+    add_kept(task.printable, kept_printable);
+    add_kept(task.unprintable, kept_unprintable);
 }
 
 template<class ArrItem>
 std::unique_ptr<ArrangeTask<ArrItem>> ArrangeTask<ArrItem>::create(
-    const Scene &sc, const ArrangeableToItemConverter<ArrItem> &converter)
+    const Scene &sc,
+    const ArrangeableToItemConverter<ArrItem> &converter,
+    std::shared_ptr<IncrementalArrangeState<ArrItem>> state)
 {
     auto task = std::make_unique<ArrangeTask<ArrItem>>();
 
@@ -60,6 +98,11 @@ std::unique_ptr<ArrangeTask<ArrItem>> ArrangeTask<ArrItem>::create(
 
     task->bed = get_corrected_bed(sc.bed(), converter);
 
+    if (state) {
+        state->start(task->settings, bounding_box(task->bed));
+        task->incremental_state = std::move(state);
+    }
+
     extract_selected(*task, sc.model(), converter);
 
     return task;
@@ -153,6 +196,14 @@ ArrangeTask<ArrItem>::process_native(Ctl &ctl)
         result->add_item(itm);
     }
 
+    if (incremental_state) {
+        for (auto &itm : printable.selected)
+            incremental_state->remember(itm);
+
+        for (auto &itm : unprintable.selected)
+            incremental_state->remember(itm);
+    }
+
     return result;
 }
 
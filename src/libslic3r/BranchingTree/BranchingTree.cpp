@@ -8,6 +8,7 @@
 #include <numeric>
 #include <optional>
 #include <algorithm>
+#include <map>
 
 #include "libslic3r/TriangleMesh.hpp"
 
@@ -197,4 +198,114 @@ ExPolygon make_bed_poly(const indexed_triangle_set &its)
     return ret;
 }
 
+// Groups of the given leafs, where each leaf is closer in XY than 'reach' to
+// some other leaf of its group. Union-find over a grid of cells of size
+// 'reach'. The groups are sorted by their first leaf, provided the input
+// indices are sorted.
+static std::vector<std::vector<size_t>> cluster_leafs(const std::vector<Node>   &leafs,
+                                                      const std::vector<size_t> &indices,
+                                                      float                      reach)
+{
+    std::vector<size_t> parent(indices.size());
+    std::iota(parent.begin(), parent.end(), size_t(0));
+    auto find_root = [&parent](size_t i) {
+        while (parent[i] != i)
+            i = parent[i] = parent[parent[i]];
+        return i;
+    };
+
+    using Cell = std::pair<long long, long long>;
+    std::map<Cell, std::vector<size_t>> grid;
+    for (size_t i = 0; i < indices.size(); ++i) {
+        const Vec3f &p = leafs[indices[i]].pos;
+        grid[{ (long long)std::floor(p.x() / reach), (long long)std::floor(p.y() / reach) }].emplace_back(i);
+    }
+
+    const float reach2 = reach * reach;
+    for (const auto &[cell, cell_leafs] : grid)
+        for (long long dx = -1; dx <= 1; ++dx)
+            for (long long dy = -1; dy <= 1; ++dy) {
+                auto it = grid.find({ cell.first + dx, cell.second + dy });
+                if (it == grid.end())
+                    continue;
+                for (size_t i : cell_leafs)
+                    for (size_t j : it->second)
+                        if (size_t ri = find_root(i), rj = find_root(j); ri != rj &&
+                            (leafs[indices[i]].pos.head<2>() - leafs[indices[j]].pos.head<2>()).squaredNorm() < reach2)
+                            parent[std::max(ri, rj)] = std::min(ri, rj);
+            }
+
+    std::vector<std::vector<size_t>> ret;
+    std::vector<size_t> group_of_root(indices.size(), size_t(-1));
+    for (size_t i = 0; i < indices.size(); ++i) {
+        size_t &group = group_of_root[find_root(i)];
+        if (group == size_t(-1)) {
+            group = ret.size();
+            ret.emplace_back();
+        }
+        ret[group].emplace_back(indices[i]);
+    }
+
+    return ret;
+}
+
+LeafPartitions partition_leafs(const std::vector<Node> &leafs,
+                               const Properties        &properties,
+                               size_t                   max_partition_size)
+{
+    LeafPartitions ret;
+
+    const auto  brlen = float(properties.max_branch_length());
+    const float reach = 2.f * brlen;
+
+    std::vector<size_t> all(leafs.size());
+    std::iota(all.begin(), all.end(), size_t(0));
+
+    for (std::vector<size_t> &group : cluster_leafs(leafs, all, reach)) {
+        if (group.size() <= std::max(max_partition_size, size_t(1))) {
+            ret.parts.emplace_back(std::move(group));
+            continue;
+        }
+
+        Vec2f bbmin = leafs[group.front()].pos.head<2>(), bbmax = bbmin;
+        for (size_t idx : group) {
+            bbmin = bbmin.cwiseMin(leafs[idx].pos.head<2>());
+            bbmax = bbmax.cwiseMax(leafs[idx].pos.head<2>());
+        }
+
+        // Tiles holding max_partition_size leafs on average, but large
+        // enough for the seams not to cover most of them.
+        Vec2f size = bbmax - bbmin;
+        float tile = std::max(4.f * reach, std::sqrt(size.x() * size.y() * max_partition_size / group.size()));
+        int   nx   = std::max(1, int(std::ceil(size.x() / tile)));
+        int   ny   = std::max(1, int(std::ceil(size.y() / tile)));
+        if (nx == 1 && ny == 1) {
+            ret.parts.emplace_back(std::move(group));
+            continue;
+        }
+
+        // The inner leafs of neighboring tiles are at least 'reach' apart.
+        std::map<std::pair<int, int>, std::vector<size_t>> tiles;
+        std::vector<size_t> seam;
+        for (size_t idx : group) {
+            Vec2f d  = leafs[idx].pos.head<2>() - bbmin;
+            int   tx = std::min(int(d.x() / tile), nx - 1);
+            int   ty = std::min(int(d.y() / tile), ny - 1);
+            float fx = d.x() - tx * tile;
+            float fy = d.y() - ty * tile;
+            bool  on_seam = (tx > 0 && fx < brlen) || (tx < nx - 1 && tile - fx < brlen) ||
+                            (ty > 0 && fy < brlen) || (ty < ny - 1 && tile - fy < brlen);
+            (on_seam ? seam : tiles[{ tx, ty }]).emplace_back(idx);
+        }
+
+        for (auto &[tile_idx, tile_leafs] : tiles)
+            ret.parts.emplace_back(std::move(tile_leafs));
+
+        for (std::vector<size_t> &seam_group : cluster_leafs(leafs, seam, reach))
+            ret.seams.emplace_back(std::move(seam_group));
+    }
+
+    return ret;
+}
+
 }} // namespace Slic3r::branchingtree
@@ -153,6 +153,25 @@ inline void build_tree(const indexed_triangle_set &its,
 // Helper function to derive a bed polygon only from the model bounding box.
 ExPolygon make_bed_poly(const indexed_triangle_set &its);
 
+// Spatial partitioning of the support leafs for building the tree in parts
+// concurrently. Leafs farther apart in XY than twice the max branch length
+// can not merge, thus groups of leafs separated by such gaps are routed
+// independently of each other. Groups larger than max_partition_size are
+// further split by a grid of XY tiles. The leafs closer to the inner tile
+// borders than the max branch length form the seams, which are grouped the
+// same way and are to be routed after the parts, ending on their branches
+// where possible (see make_partition_cloud()).
+// The partitions only depend on the input, the leaf indices are sorted.
+struct LeafPartitions
+{
+    std::vector<std::vector<size_t>> parts;
+    std::vector<std::vector<size_t>> seams;
+};
+
+LeafPartitions partition_leafs(const std::vector<Node> &leafs,
+                               const Properties        &properties,
+                               size_t                   max_partition_size);
+
 }} // namespace Slic3r::branchingtree
 
 #endif // SUPPORTTREEBRANCHING_HPP
@@ -106,7 +106,8 @@ PointCloud::PointCloud(const indexed_triangle_set &M,
 PointCloud::PointCloud(std::vector<Node> meshpts,
                        std::vector<Node> bedpts,
                        std::vector<Node> support_leafs,
-                       const Properties &props)
+                       const Properties &props,
+                       size_t            num_branchpts)
     : m_leafs{std::move(support_leafs)}
     , m_meshpoints{std::move(meshpts)}
     , m_bedpoints{std::move(bedpts)}
@@ -114,6 +115,7 @@ PointCloud::PointCloud(std::vector<Node> meshpts,
     , cos2bridge_slope{std::cos(props.max_slope()) *
                        std::abs(std::cos(props.max_slope()))}
     , MESHPTS_BEGIN{m_bedpoints.size()}
+    , BRANCHPTS_END{MESHPTS_BEGIN + std::min(num_branchpts, m_meshpoints.size())}
     , LEAFS_BEGIN{MESHPTS_BEGIN + m_meshpoints.size()}
     , JUNCTIONS_BEGIN{LEAFS_BEGIN + m_leafs.size()}
     , m_searchable_indices(JUNCTIONS_BEGIN + m_junctions.size(), true)
@@ -141,6 +143,37 @@ PointCloud::PointCloud(std::vector<Node> meshpts,
     }
 }
 
+PointCloud make_partition_cloud(const std::vector<Node>   &meshpts,
+                                const std::vector<Node>   &bedpts,
+                                const std::vector<Node>   &leafs,
+                                const std::vector<size_t> &partition,
+                                const Properties          &props,
+                                const std::vector<Node>   &branchpts)
+{
+    auto part_leafs = reserve_vector<Node>(partition.size());
+    for (size_t idx : partition)
+        part_leafs.emplace_back(leafs[idx]);
+
+    // Same XY reach as the query box of PointCloud::foreach_reachable()
+    BoundingBox3Base<Vec3f> bb;
+    for (const Node &n : part_leafs)
+        bb.merge(n.pos);
+
+    auto brln = float(2 * props.max_branch_length());
+    auto in_reach = [&bb, brln](const Node &n) {
+        return n.pos.x() >= bb.min.x() - brln && n.pos.x() <= bb.max.x() + brln &&
+               n.pos.y() >= bb.min.y() - brln && n.pos.y() <= bb.max.y() + brln;
+    };
+
+    std::vector<Node> part_meshpts, part_bedpts;
+    std::copy_if(branchpts.begin(), branchpts.end(), std::back_inserter(part_meshpts), in_reach);
+    size_t num_branchpts = part_meshpts.size();
+    std::copy_if(meshpts.begin(), meshpts.end(), std::back_inserter(part_meshpts), in_reach);
+    std::copy_if(bedpts.begin(), bedpts.end(), std::back_inserter(part_bedpts), in_reach);
+
+    return PointCloud{std::move(part_meshpts), std::move(part_bedpts), std::move(part_leafs), props, num_branchpts};
+}
+
 float PointCloud::get_distance(const Vec3f &p, size_t node_id) const
 {
     auto t = get_type(node_id);
@@ -55,7 +55,7 @@ class PointCloud {
     const branchingtree::Properties &m_props;
 
     const double cos2bridge_slope;
-    const size_t MESHPTS_BEGIN, LEAFS_BEGIN, JUNCTIONS_BEGIN;
+    const size_t MESHPTS_BEGIN, BRANCHPTS_END, LEAFS_BEGIN, JUNCTIONS_BEGIN;
 
 private:
 
@@ -124,10 +124,13 @@ public:
                std::vector<Node>           support_leafs,
                const Properties           &props);
 
+    // The first num_branchpts of meshpts are points on the branches of a
+    // tree routed before, see make_partition_cloud().
     PointCloud(std::vector<Node> meshpts,
                std::vector<Node> bedpts,
                std::vector<Node> support_leafs,
-               const Properties &props);
+               const Properties &props,
+               size_t            num_branchpts = 0);
 
     PtType get_type(size_t node_id) const
     {
@@ -163,6 +166,12 @@ public:
                    Node::ID_NONE;
     }
 
+    // Whether the node of type MESH is a point on a branch routed before
+    bool is_branch_point(size_t node_id) const
+    {
+        return node_id >= MESHPTS_BEGIN && node_id < BRANCHPTS_END;
+    }
+
     size_t get_queue_idx(size_t node_id) const { return m_queue_indices[node_id]; }
 
     float get_distance(const Vec3f &p, size_t node) const;
@@ -288,6 +297,19 @@ template<class PC, class Fn> void traverse(PC &&pc, size_t root, Fn &&fn)
     }
 }
 
+// Point cloud for routing a partition of the support leafs on its own (see
+// partition_leafs()): the leafs of the partition and copies of the mesh and
+// bed points within their reach. Leaf i of the cloud is leafs[partition[i]].
+// The branch points are points on the branches of the partitions routed
+// before. Those within reach are added to the mesh points, so that the leafs
+// may end on these branches like on the model, see is_branch_point().
+PointCloud make_partition_cloud(const std::vector<Node>   &meshpts,
+                                const std::vector<Node>   &bedpts,
+                                const std::vector<Node>   &leafs,
+                                const std::vector<size_t> &partition,
+                                const Properties          &props,
+                                const std::vector<Node>   &branchpts = {});
+
 void build_tree(PointCloud &pcloud, Builder &builder);
 
 inline void build_tree(PointCloud &&pc, Builder &builder)
@@ -11,6 +11,7 @@
 #include <iostream>
 
 #include "FillGyroid.hpp"
+#include "FillPatternCache.hpp"
 
 namespace Slic3r {
 
@@ -174,12 +175,25 @@ void FillGyroid::_fill_surface_single(
     bb.merge(align_to_grid(bb.min, Point(2*M_PI*distance, 2*M_PI*distance)));
 
     // generate pattern
-    Polylines polylines = make_gyroid_waves(
-        scale_(this->z),
-        density_adjusted,
-        this->spacing,
-        ceil(bb.size()(0) / distance) + 1.,
-        ceil(bb.size()(1) / distance) + 1.);
+    // With the pattern cache, the size of the pattern is rounded up to whole periods, so that the surfaces
+    // of a similar size share the pattern. The pattern is periodic along z, thus only the phase of z is
+    // kept, rounded to whole scaled units. The objects and regions at the same height share the pattern, the layers only share it if the
+    // layer height divides the period along z, which is rare.
+    const bool   cached = FillPatternCache::enabled();
+    auto pattern_size = [cached](double size) { return cached ? 2. * M_PI * ceil(size / (2. * M_PI)) : size; };
+    const double z_period = 2. * M_PI * scale_(this->spacing) / density_adjusted;
+    const double grid_z = cached ? std::round(std::fmod(scale_(this->z), z_period)) : scale_(this->z);
+    const double width  = pattern_size(ceil(bb.size()(0) / distance) + 1.);
+    const double height = pattern_size(ceil(bb.size()(1) / distance) + 1.);
+    std::string  key    = "gyroid";
+    append_to_key(key, grid_z);
+    append_to_key(key, density_adjusted);
+    append_to_key(key, this->spacing);
+    append_to_key(key, width);
+    append_to_key(key, height);
+    Polylines polylines = *FillPatternCache::polylines(key, [grid_z, density_adjusted, spacing = this->spacing, width, height]() {
+        return make_gyroid_waves(grid_z, density_adjusted, spacing, width, height);
+    });
 
 	// shift the polyline to the grid origin
 	for (Polyline &pl : polylines)
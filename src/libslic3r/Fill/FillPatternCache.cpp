@@ -0,0 +1,63 @@
+///|/ Copyright (c) Prusa Research 2023
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include "FillPatternCache.hpp"
+
+#include <atomic>
+
+namespace Slic3r {
+
+namespace {
+
+using Cache = LRUCache<std::string, Polylines>;
+
+std::atomic<bool> cache_enabled { true };
+
+size_t memsize(const std::string &key, const Polylines &polylines)
+{
+    size_t out = key.size() + polylines.capacity() * sizeof(Polyline);
+    for (const Polyline &polyline : polylines)
+        out += polyline.points.capacity() * sizeof(Point);
+    return out;
+}
+
+Cache& cache()
+{
+    static Cache instance(size_t(64) << 20, memsize);
+    return instance;
+}
+
+} // namespace
+
+FillPatternCache::PolylinesPtr FillPatternCache::polylines(const std::string &key, const std::function<Polylines()> &generate_fn)
+{
+    return cache_enabled ? cache().find_or_build(key, generate_fn) : std::make_shared<const Polylines>(generate_fn());
+}
+
+void FillPatternCache::set_enabled(bool enabled)
+{
+    cache_enabled = enabled;
+}
+
+bool FillPatternCache::enabled()
+{
+    return cache_enabled;
+}
+
+void FillPatternCache::set_memory_limit(size_t bytes)
+{
+    cache().set_memory_limit(bytes);
+}
+
+FillPatternCache::Stats FillPatternCache::stats()
+{
+    return cache().stats();
+}
+
+void FillPatternCache::clear()
+{
+    cache().clear();
+}
+
+} // namespace Slic3r
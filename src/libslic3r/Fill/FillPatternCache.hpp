@@ -0,0 +1,53 @@
+///|/ Copyright (c) Prusa Research 2023
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef slic3r_FillPatternCache_hpp_
+#define slic3r_FillPatternCache_hpp_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "../LRUCache.hpp"
+#include "../Polyline.hpp"
+
+namespace Slic3r {
+
+// Process wide cache of unclipped infill patterns.
+//
+// An infill pattern only depends on its parameters and on the area it covers, not on the surface
+// being filled. The layers of similar objects on the plate, or the layers repeating the phase of
+// the pattern, thus generate the same pattern again and again. Instead, the pattern is generated
+// on the first request and shared as immutable polylines, the consumers clip their own copy.
+//
+// The memory of the cached patterns is accounted for, see LRUCache.
+class FillPatternCache
+{
+public:
+    using PolylinesPtr = std::shared_ptr<const Polylines>;
+
+    using Stats = LRUCacheStats;
+
+    // Pattern produced by generate_fn. The key is formed by the caller from the name of the pattern
+    // and from all the parameters generate_fn depends on.
+    static PolylinesPtr polylines(const std::string &key, const std::function<Polylines()> &generate_fn);
+
+    // When disabled, the patterns are generated for each request and the fillers don't adjust them for sharing.
+    static void set_enabled(bool enabled);
+    static bool enabled();
+
+    static void  set_memory_limit(size_t bytes);
+    static Stats stats();
+    static void  clear();
+};
+
+// Helper for forming the keys.
+template<typename T> inline void append_to_key(std::string &key, const T &data)
+{
+    key.append(reinterpret_cast<const char*>(&data), sizeof(data));
+}
+
+} // namespace Slic3r
+
+#endif // slic3r_FillPatternCache_hpp_
@@ -48,6 +48,51 @@ public:
             execution::max_concurrency(ep));
     }
 
+    // Same as draw_layers, but each layer is drawn knowing the raster of
+    // the previous one, so that only the difference has to be drawn. The
+    // layers are split into contiguous chunks which are processed in
+    // parallel, the layers of a chunk are drawn sequentially.
+    // Fn have to be thread safe:
+    //   bool(sla::RasterBase& raster, const sla::RasterBase *prev, size_t lyrid);
+    // prev is null for the first layer of a chunk. Returning true means that
+    // the layer is identical with the previous one, nothing was drawn and
+    // the encoded previous layer is reused.
+    template<class Fn, class CancelFn, class EP = ExecutionTBB>
+    void draw_layers_incremental(
+        size_t     layer_num,
+        Fn &&      drawfn,
+        CancelFn cancelfn = []() { return false; },
+        const EP & ep       = {})
+    {
+        m_layers.resize(layer_num);
+
+        // A few chunks per thread for load balancing, but long enough for
+        // the differential drawing to pay off.
+        size_t chunks = std::max(size_t(1), 4 * execution::max_concurrency(ep));
+        size_t chunk_len = std::max(size_t(8), (layer_num + chunks - 1) / chunks);
+        chunks = (layer_num + chunk_len - 1) / chunk_len;
+
+        execution::for_each(
+            ep, size_t(0), chunks,
+            [this, &drawfn, &cancelfn, chunk_len, layer_num](size_t chunk) {
+                std::unique_ptr<sla::RasterBase> prev;
+
+                size_t end = std::min(layer_num, (chunk + 1) * chunk_len);
+                for (size_t idx = chunk * chunk_len; idx < end; ++idx) {
+                    if (cancelfn()) return;
+
+                    auto rst = create_raster();
+                    if (drawfn(*rst, prev.get(), idx) && prev) {
+                        m_layers[idx] = m_layers[idx - 1];
+                    } else {
+                        m_layers[idx] = rst->encode(get_encoder());
+                        prev = std::move(rst);
+                    }
+                }
+            },
+            1);
+    }
+
     // Export the print into an archive using the provided filename.
     virtual void export_print(const std::string     fname,
                               const SLAPrint       &print,
@@ -16,6 +16,7 @@
 #include <algorithm>
 #include <queue>
 
+#include "libslic3r/AABBTreeCache.hpp"
 #include "libslic3r/AABBTreeLines.hpp"
 #include "libslic3r/KDTreeIndirect.hpp"
 #include "libslic3r/ExtrusionEntity.hpp"
@@ -171,20 +172,30 @@ std::vector<float> raycast_visibility(const AABBTreeIndirect::Tree<3, float> &ra
                     Frame f;
                     f.set_from_z(normal);
 
-                    for (const auto &dir : precomputed_sample_directions) {
-                        Vec3f final_ray_dir = (f.to_world(dir));
-                        if (!model_contains_negative_parts) {
-                            igl::Hit hitpoint;
-                            // FIXME: This AABBTTreeIndirect query will not compile for float ray origin and
-                            // direction.
-                            Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
-                            Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
-                            bool hit = AABBTreeIndirect::intersect_ray_first_hit(triangles.vertices,
-                                    triangles.indices, raycasting_tree, ray_origin_d, final_ray_dir_d, hitpoint);
-                            if (hit && its_face_normal(triangles, hitpoint.id).dot(final_ray_dir) <= 0) {
-                                result[s_idx] -= decrease_step;
+                    if (!model_contains_negative_parts) {
+                        // The rays share the origin, they are cast in packets sharing the traversal of the AABB tree.
+                        constexpr size_t packet_size = 8;
+                        Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
+                        for (size_t first = 0; first < precomputed_sample_directions.size(); first += packet_size) {
+                            size_t count = std::min(packet_size, precomputed_sample_directions.size() - first);
+                            std::array<Vec3f, packet_size> final_ray_dirs;
+                            std::array<Vec3d, packet_size> final_ray_dirs_d;
+                            for (size_t k = 0; k < packet_size; ++k) {
+                                // Unused slots of the last packet repeat its first ray.
+                                final_ray_dirs[k] = f.to_world(precomputed_sample_directions[first + (k < count ? k : 0)]);
+                                final_ray_dirs_d[k] = final_ray_dirs[k].cast<double>();
                             }
-                        } else { //TODO improve logic for order based boolean operations - consider order of volumes
+                            std::array<igl::Hit, packet_size> hitpoints;
+                            AABBTreeIndirect::intersect_ray_packet_first_hit(triangles.vertices,
+                                    triangles.indices, raycasting_tree, ray_origin_d, final_ray_dirs_d, hitpoints);
+                            for (size_t k = 0; k < count; ++k)
+                                if (hitpoints[k].id >= 0 && its_face_normal(triangles, hitpoints[k].id).dot(final_ray_dirs[k]) <= 0) {
+                                    result[s_idx] -= decrease_step;
+                                }
+                        }
+                    } else { //TODO improve logic for order based boolean operations - consider order of volumes
+                        for (const auto &dir : precomputed_sample_directions) {
+                            Vec3f final_ray_dir = (f.to_world(dir));
                             bool casting_from_negative_volume = samples.triangle_indices[s_idx]
                                     >= negative_volumes_start_index;
 
@@ -298,27 +309,26 @@ struct GlobalModelInfo {
     KDTreeIndirect<3, float, CoordinateFunctor> mesh_samples_tree { CoordinateFunctor { } };
     float mesh_samples_radius;
 
-    indexed_triangle_set enforcers;
-    indexed_triangle_set blockers;
-    AABBTreeIndirect::Tree<3, float> enforcers_tree;
-    AABBTreeIndirect::Tree<3, float> blockers_tree;
+    // Painted enforcers and blockers together with the AABB trees over them, shared through AABBTreeCache.
+    AABBTreeCache::MeshTreePtr enforcers;
+    AABBTreeCache::MeshTreePtr blockers;
 
     bool is_enforced(const Vec3f &position, float radius) const {
-        if (enforcers.empty()) {
+        if (!enforcers || enforcers->its.empty()) {
             return false;
         }
         float radius_sqr = radius * radius;
-        return AABBTreeIndirect::is_any_triangle_in_radius(enforcers.vertices, enforcers.indices,
-                enforcers_tree, position, radius_sqr);
+        return AABBTreeIndirect::is_any_triangle_in_radius(enforcers->its.vertices, enforcers->its.indices,
+                enforcers->tree, position, radius_sqr);
     }
 
     bool is_blocked(const Vec3f &position, float radius) const {
-        if (blockers.empty()) {
+        if (!blockers || blockers->its.empty()) {
             return false;
         }
         float radius_sqr = radius * radius;
-        return AABBTreeIndirect::is_any_triangle_in_radius(blockers.vertices, blockers.indices,
-                blockers_tree, position, radius_sqr);
+        return AABBTreeIndirect::is_any_triangle_in_radius(blockers->its.vertices, blockers->its.indices,
+                blockers->tree, position, radius_sqr);
     }
 
     float calculate_point_visibility(const Vec3f &position) const {
@@ -624,40 +634,63 @@ std::pair<size_t, size_t> find_previous_and_next_perimeter_point(const std::vect
 // Computes all global model info - transforms object, performs raycasting
 void compute_global_occlusion(GlobalModelInfo &result, const PrintObject *po,
         std::function<void(void)> throw_if_canceled) {
-    BOOST_LOG_TRIVIAL(debug)
-    << "SeamPlacer: gather occlusion meshes: start";
     auto obj_transform = po->trafo_centered();
-    indexed_triangle_set triangle_set;
-    indexed_triangle_set negative_volumes_set;
-    //add all parts
-    for (const ModelVolume *model_volume : po->model_object()->volumes) {
-        if (model_volume->type() == ModelVolumeType::MODEL_PART
-                || model_volume->type() == ModelVolumeType::NEGATIVE_VOLUME) {
-            auto model_transformation = model_volume->get_matrix();
-            indexed_triangle_set model_its = model_volume->mesh().its;
-            its_transform(model_its, model_transformation);
-            if (model_volume->type() == ModelVolumeType::MODEL_PART) {
-                its_merge(triangle_set, model_its);
-            } else {
-                its_merge(negative_volumes_set, model_its);
-            }
-        }
-    }
-    throw_if_canceled();
-
-    BOOST_LOG_TRIVIAL(debug)
-    << "SeamPlacer: gather occlusion meshes: end";
+    // Model parts first, negative volumes second. The number of the model parts is a part of the cache key,
+    // as a change of a volume type does not change the volume's mesh and transformation.
+    std::vector<AABBTreeCache::Source> sources;
+    for (ModelVolumeType type : { ModelVolumeType::MODEL_PART, ModelVolumeType::NEGATIVE_VOLUME })
+        for (const ModelVolume *model_volume : po->model_object()->volumes)
+            if (model_volume->type() == type)
+                sources.push_back({ model_volume->mesh_ptr(), model_volume->get_matrix() });
+    size_t num_model_parts = std::count_if(po->model_object()->volumes.begin(), po->model_object()->volumes.end(),
+            [](const ModelVolume *model_volume) { return model_volume->type() == ModelVolumeType::MODEL_PART; });
+
+    // Decimated occlusion mesh and the AABB tree over it are shared by all PrintObjects of the same ModelObject
+    // and reused when the G-code is regenerated.
+    AABBTreeCache::MeshTreePtr occlusion_mesh = AABBTreeCache::mesh_tree(po->model_object()->id(),
+            "SeamPlacer occlusion " + std::to_string(num_model_parts), obj_transform, sources,
+            [&sources, num_model_parts, &obj_transform]() {
+                BOOST_LOG_TRIVIAL(debug)
+                << "SeamPlacer: gather occlusion meshes: start";
+                indexed_triangle_set triangle_set;
+                indexed_triangle_set negative_volumes_set;
+                //add all parts
+                for (size_t i = 0; i < sources.size(); ++i) {
+                    indexed_triangle_set model_its = sources[i].mesh->its;
+                    its_transform(model_its, sources[i].trafo);
+                    if (i < num_model_parts) {
+                        its_merge(triangle_set, model_its);
+                    } else {
+                        its_merge(negative_volumes_set, model_its);
+                    }
+                }
+                BOOST_LOG_TRIVIAL(debug)
+                << "SeamPlacer: gather occlusion meshes: end";
 
-    BOOST_LOG_TRIVIAL(debug)
-    << "SeamPlacer: decimate: start";
-    its_short_edge_collpase(triangle_set, SeamPlacer::fast_decimation_triangle_count_target);
-    its_short_edge_collpase(negative_volumes_set, SeamPlacer::fast_decimation_triangle_count_target);
+                BOOST_LOG_TRIVIAL(debug)
+                << "SeamPlacer: decimate: start";
+                its_short_edge_collpase(triangle_set, SeamPlacer::fast_decimation_triangle_count_target);
+                its_short_edge_collpase(negative_volumes_set, SeamPlacer::fast_decimation_triangle_count_target);
+
+                AABBTreeCache::MeshTree out;
+                out.parts = { 0, triangle_set.indices.size() };
+                its_merge(triangle_set, negative_volumes_set);
+                its_transform(triangle_set, obj_transform);
+                BOOST_LOG_TRIVIAL(debug)
+                << "SeamPlacer: decimate: end";
 
-    size_t negative_volumes_start_index = triangle_set.indices.size();
-    its_merge(triangle_set, negative_volumes_set);
-    its_transform(triangle_set, obj_transform);
-    BOOST_LOG_TRIVIAL(debug)
-    << "SeamPlacer: decimate: end";
+                BOOST_LOG_TRIVIAL(debug)
+                << "SeamPlacer: build AABB tree: start";
+                out.tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(triangle_set.vertices,
+                        triangle_set.indices);
+                out.its = std::move(triangle_set);
+                BOOST_LOG_TRIVIAL(debug)
+                << "SeamPlacer: build AABB tree: end";
+                return out;
+            });
+    const indexed_triangle_set &triangle_set = occlusion_mesh->its;
+    size_t negative_volumes_start_index = occlusion_mesh->parts[1];
+    throw_if_canceled();
 
     BOOST_LOG_TRIVIAL(debug)
     << "SeamPlacer: Compute visibility sample points: start";
@@ -689,15 +722,7 @@ void compute_global_occlusion(GlobalModelInfo &result, const PrintObject *po,
     BOOST_LOG_TRIVIAL(debug)
     << "SeamPlacer: Mesh sample raidus: " << result.mesh_samples_radius;
 
-    BOOST_LOG_TRIVIAL(debug)
-    << "SeamPlacer: build AABB tree: start";
-    auto raycasting_tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(triangle_set.vertices,
-            triangle_set.indices);
-
-    throw_if_canceled();
-    BOOST_LOG_TRIVIAL(debug)
-    << "SeamPlacer: build AABB tree: end";
-    result.mesh_samples_visibility = raycast_visibility(raycasting_tree, triangle_set, result.mesh_samples,
+    result.mesh_samples_visibility = raycast_visibility(occlusion_mesh->tree, triangle_set, result.mesh_samples,
             negative_volumes_start_index);
     throw_if_canceled();
 #ifdef DEBUG_FILES
@@ -706,32 +731,41 @@ void compute_global_occlusion(GlobalModelInfo &result, const PrintObject *po,
 }
 
 void gather_enforcers_blockers(GlobalModelInfo &result, const PrintObject *po) {
-    BOOST_LOG_TRIVIAL(debug)
-    << "SeamPlacer: build AABB trees for raycasting enforcers/blockers: start";
-
     auto obj_transform = po->trafo_centered();
 
-    for (const ModelVolume *mv : po->model_object()->volumes) {
+    // The painted volumes are the sources. The timestamps of their seam facets are a part of the cache key,
+    // as repainting does not change the volume's mesh and transformation.
+    std::vector<const ModelVolume*> painted;
+    std::vector<AABBTreeCache::Source> sources;
+    std::string timestamps;
+    for (const ModelVolume *mv : po->model_object()->volumes)
         if (mv->is_seam_painted()) {
-            auto model_transformation = obj_transform * mv->get_matrix();
-
-            indexed_triangle_set enforcers = mv->seam_facets.get_facets(*mv, EnforcerBlockerType::ENFORCER);
-            its_transform(enforcers, model_transformation);
-            its_merge(result.enforcers, enforcers);
-
-            indexed_triangle_set blockers = mv->seam_facets.get_facets(*mv, EnforcerBlockerType::BLOCKER);
-            its_transform(blockers, model_transformation);
-            its_merge(result.blockers, blockers);
+            painted.emplace_back(mv);
+            sources.push_back({ mv->mesh_ptr(), mv->get_matrix() });
+            timestamps += " " + std::to_string(mv->seam_facets.timestamp());
         }
-    }
 
-    result.enforcers_tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(result.enforcers.vertices,
-            result.enforcers.indices);
-    result.blockers_tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(result.blockers.vertices,
-            result.blockers.indices);
+    auto gather = [po, &painted, &sources, &timestamps, &obj_transform](EnforcerBlockerType type, const char *name) {
+        return AABBTreeCache::mesh_tree(po->model_object()->id(), std::string("SeamPlacer ") + name + timestamps,
+                obj_transform, sources, [&painted, &obj_transform, type, name]() {
+                    BOOST_LOG_TRIVIAL(debug)
+                    << "SeamPlacer: build AABB tree for raycasting " << name << ": start";
+                    AABBTreeCache::MeshTree out;
+                    for (const ModelVolume *mv : painted) {
+                        indexed_triangle_set facets = mv->seam_facets.get_facets(*mv, type);
+                        its_transform(facets, obj_transform * mv->get_matrix());
+                        its_merge(out.its, facets);
+                    }
+                    out.tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(out.its.vertices,
+                            out.its.indices);
+                    BOOST_LOG_TRIVIAL(debug)
+                    << "SeamPlacer: build AABB tree for raycasting " << name << ": end";
+                    return out;
+                });
+    };
 
-    BOOST_LOG_TRIVIAL(debug)
-    << "SeamPlacer: build AABB trees for raycasting enforcers/blockers: end";
+    result.enforcers = gather(EnforcerBlockerType::ENFORCER, "enforcers");
+    result.blockers  = gather(EnforcerBlockerType::BLOCKER, "blockers");
 }
 
 struct SeamComparator {
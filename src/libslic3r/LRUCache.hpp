@@ -0,0 +1,254 @@
+///|/ Copyright (c) Prusa Research 2023
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef slic3r_LRUCache_hpp_
+#define slic3r_LRUCache_hpp_
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <tbb/task_arena.h>
+
+namespace Slic3r {
+
+struct LRUCacheStats {
+    size_t entries      = 0;
+    size_t memory       = 0;
+    size_t memory_limit = 0;
+    size_t hits         = 0;
+    size_t misses       = 0;
+    size_t evictions    = 0;
+};
+
+// Thread safe cache of immutable values, shared by the consumers through reference counting.
+//
+// The memory of the cached values is accounted for by memsize_fn. If it exceeds the limit, the least
+// recently used entries are released. A released value lives as long as someone is using it.
+//
+// A value may be derived from data identified only by its address, for example a mesh. Such an entry
+// keeps weak references to the data and it is dropped once any of them is released, because the address
+// may be reused.
+template<class Key, class Value, class Hash = std::hash<Key>>
+class LRUCache
+{
+public:
+    using ValuePtr     = std::shared_ptr<const Value>;
+    using MemsizeFn    = std::function<size_t(const Key&, const Value&)>;
+    using Dependencies = std::vector<std::weak_ptr<const void>>;
+    using Stats        = LRUCacheStats;
+
+    LRUCache(size_t memory_limit, MemsizeFn memsize_fn) : m_memsize_fn(std::move(memsize_fn))
+    {
+        m_stats.memory_limit = memory_limit;
+    }
+
+    // Returns the cached value or nullptr. Waits if the value is being built by another thread.
+    ValuePtr find(const Key &key)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto it = this->find_valid(key);
+        if (it == m_slots.end()) {
+            ++ m_stats.misses;
+            return {};
+        }
+        ++ m_stats.hits;
+        this->touch(it->second);
+        std::shared_future<ValuePtr> entry = it->second.entry;
+        // Wait outside of the lock.
+        lock.unlock();
+        return entry.get();
+    }
+
+    // Stores the value unless there already is one, for example calculated by another thread in the meantime.
+    ValuePtr insert(const Key &key, Value value, Dependencies deps = {})
+    {
+        auto out = std::make_shared<const Value>(std::move(value));
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (auto it = this->find_valid(key); it != m_slots.end()) {
+            std::shared_future<ValuePtr> entry = it->second.entry;
+            lock.unlock();
+            return entry.get();
+        }
+        std::promise<ValuePtr> promise;
+        promise.set_value(out);
+        Slot &slot = this->add_slot(key, promise.get_future().share(), std::move(deps));
+        this->account(slot, key, *out);
+        return out;
+    }
+
+    // Returns the cached value, builds it by build_fn on the first request. The other threads requesting
+    // the same key meanwhile wait for the value instead of building it again.
+    ValuePtr find_or_build(const Key &key, const std::function<Value()> &build_fn, Dependencies deps = {})
+    {
+        std::promise<ValuePtr> promise;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (auto it = this->find_valid(key); it != m_slots.end()) {
+                ++ m_stats.hits;
+                this->touch(it->second);
+                std::shared_future<ValuePtr> entry = it->second.entry;
+                // Wait outside of the lock, the entry may still be being built by another thread.
+                lock.unlock();
+                return entry.get();
+            }
+            ++ m_stats.misses;
+            this->add_slot(key, promise.get_future().share(), std::move(deps));
+        }
+
+        ValuePtr out;
+        try {
+            // Isolated, so that the thread does not pick up a task waiting for this very entry
+            // while waiting for the parallel tasks of the builder.
+            tbb::this_task_arena::isolate([&build_fn, &out]() { out = std::make_shared<const Value>(build_fn()); });
+        } catch (...) {
+            // Let the waiting consumers know and forget the slot, so that the next request tries again.
+            promise.set_exception(std::current_exception());
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (auto it = m_slots.find(key); it != m_slots.end() && it->second.memsize == 0)
+                this->erase(it);
+            throw;
+        }
+        promise.set_value(out);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // The slot may have been cleared or evicted meanwhile.
+        if (auto it = m_slots.find(key); it != m_slots.end() && it->second.memsize == 0)
+            this->account(it->second, key, *out);
+        return out;
+    }
+
+    void set_memory_limit(size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.memory_limit = bytes;
+        this->shrink();
+    }
+
+    Stats stats()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Don't report the entries of released data.
+        this->drop_expired();
+        return m_stats;
+    }
+
+    // Entries being built are kept, their builders will account for them.
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_slots.begin(); it != m_slots.end();)
+            if (it->second.memsize > 0)
+                this->erase(it ++);
+            else
+                ++ it;
+    }
+
+private:
+    using LRUList = std::list<Key>;
+
+    struct Slot {
+        std::shared_future<ValuePtr>  entry;
+        Dependencies                  deps;
+        // Position in m_lru, the most recently used entries are at the front.
+        typename LRUList::iterator    lru;
+        // Zero until the value is built.
+        size_t                        memsize = 0;
+
+        bool expired() const
+        {
+            return std::any_of(deps.begin(), deps.end(), [](const auto &d) { return d.expired(); });
+        }
+    };
+
+    using Slots = std::unordered_map<Key, Slot, Hash>;
+
+    std::mutex m_mutex;
+    Slots      m_slots;
+    LRUList    m_lru;
+    // Number of the slots with dependencies, the other slots never expire.
+    size_t     m_num_dependent = 0;
+    Stats      m_stats;
+    MemsizeFn  m_memsize_fn;
+
+    typename Slots::iterator find_valid(const Key &key)
+    {
+        auto it = m_slots.find(key);
+        if (it != m_slots.end() && it->second.expired()) {
+            this->erase(it);
+            it = m_slots.end();
+        }
+        return it;
+    }
+
+    void touch(Slot &slot) { m_lru.splice(m_lru.begin(), m_lru, slot.lru); }
+
+    Slot& add_slot(const Key &key, std::shared_future<ValuePtr> entry, Dependencies deps)
+    {
+        Slot &slot = m_slots[key];
+        slot.entry = std::move(entry);
+        slot.deps  = std::move(deps);
+        slot.lru   = m_lru.insert(m_lru.begin(), key);
+        if (! slot.deps.empty())
+            ++ m_num_dependent;
+        m_stats.entries = m_slots.size();
+        return slot;
+    }
+
+    void account(Slot &slot, const Key &key, const Value &value)
+    {
+        // Never zero, which marks the entries being built.
+        slot.memsize = std::max<size_t>(1, m_memsize_fn(key, value));
+        m_stats.memory += slot.memsize;
+        this->drop_expired();
+        this->shrink();
+    }
+
+    void erase(typename Slots::iterator it)
+    {
+        m_stats.memory -= it->second.memsize;
+        if (! it->second.deps.empty())
+            -- m_num_dependent;
+        m_lru.erase(it->second.lru);
+        m_slots.erase(it);
+        m_stats.entries = m_slots.size();
+    }
+
+    void drop_expired()
+    {
+        if (m_num_dependent == 0)
+            return;
+        for (auto it = m_slots.begin(); it != m_slots.end();)
+            if (it->second.expired())
+                this->erase(it ++);
+            else
+                ++ it;
+    }
+
+    // Release the least recently used entries over the memory limit.
+    void shrink()
+    {
+        for (auto lru = m_lru.end(); m_stats.memory > m_stats.memory_limit && lru != m_lru.begin();) {
+            auto it = m_slots.find(*(-- lru));
+            assert(it != m_slots.end());
+            // Entries being built are not accounted for yet.
+            if (it->second.memsize > 0) {
+                // The list node of lru is released by erase, continue from its successor.
+                lru = std::next(lru);
+                this->erase(it);
+                ++ m_stats.evictions;
+            }
+        }
+    }
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_LRUCache_hpp_
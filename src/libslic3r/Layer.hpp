@@ -39,6 +39,10 @@ namespace FillLightning {
     class Generator;
 };
 
+namespace PerimeterGenerator {
+    class Cache;
+}
+
 // Range of indices, providing support for range based loops.
 template<typename T>
 class IndexRange
@@ -159,7 +163,9 @@ public:
         // All fill areas produced for all input slices above.
         ExPolygons                                             &fill_expolygons,
         // Ranges of fill areas above per input slice.
-        std::vector<ExPolygonRange>                            &fill_expolygons_ranges);
+        std::vector<ExPolygonRange>                            &fill_expolygons_ranges,
+        // Memo of the perimeters shared by the layers of the object, may be null.
+        PerimeterGenerator::Cache                              *cache = nullptr);
     void    process_external_surfaces(const Layer *lower_layer, const Polygons *lower_layer_covered);
     double  infill_area_threshold() const;
     // Trim surfaces by trimming polygons. Used by the elephant foot compensation at the 1st layer.
@@ -376,7 +382,8 @@ public:
         for (const LayerRegion *layerm : m_regions) if (layerm->slices().any_bottom_contains(item)) return true;
         return false;
     }
-    void                    make_perimeters();
+    // The memo of the perimeters may be shared by the layers of the object, it may be null.
+    void                    make_perimeters(PerimeterGenerator::Cache *cache = nullptr);
     // Phony version of make_fills() without parameters for Perl integration only.
     void                    make_fills() { this->make_fills(nullptr, nullptr, nullptr); }
     void                    make_fills(FillAdaptive::Octree     *adaptive_fill_octree,
@@ -78,7 +78,9 @@ void LayerRegion::make_perimeters(
     // All fill areas produced for all input slices above.
     ExPolygons                                             &fill_expolygons,
     // Ranges of fill areas above per input slice.
-    std::vector<ExPolygonRange>                            &fill_expolygons_ranges)
+    std::vector<ExPolygonRange>                            &fill_expolygons_ranges,
+    // Memo of the perimeters shared by the layers of the object, may be null.
+    PerimeterGenerator::Cache                              *cache)
 {
     m_perimeters.clear();
     m_thin_fills.clear();
@@ -108,6 +110,7 @@ void LayerRegion::make_perimeters(
         print_config,
         spiral_vase
     );
+    params.cache = cache;
 
     // Cummulative sum of polygons over all the regions.
     const ExPolygons *lower_slices = this->layer()->lower_layer ? &this->layer()->lower_layer->lslices : nullptr;
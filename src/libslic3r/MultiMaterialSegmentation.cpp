@@ -87,7 +87,7 @@ struct PaintedLine
 
 struct PaintedLineVisitor
 {
-    PaintedLineVisitor(const EdgeGrid::Grid &grid, std::vector<PaintedLine> &painted_lines, std::mutex &painted_lines_mutex, size_t reserve) : grid(grid), painted_lines(painted_lines), painted_lines_mutex(painted_lines_mutex)
+    PaintedLineVisitor(const EdgeGrid::Grid &grid, std::vector<PaintedLine> &painted_lines, size_t reserve) : grid(grid), painted_lines(painted_lines)
     {
         painted_lines_set.reserve(reserve);
     }
@@ -129,10 +129,7 @@ struct PaintedLineVisitor
                             line_to_test_projected.reverse();
 
                         painted_lines_set.insert(*it_contour_and_segment);
-                        {
-                            boost::lock_guard<std::mutex> lock(painted_lines_mutex);
-                            painted_lines.push_back({it_contour_and_segment->first, it_contour_and_segment->second, line_to_test_projected, this->color});
-                        }
+                        painted_lines.push_back({it_contour_and_segment->first, it_contour_and_segment->second, line_to_test_projected, this->color});
                     }
                 }
             }
@@ -143,7 +140,6 @@ struct PaintedLineVisitor
 
     const EdgeGrid::Grid                                                                 &grid;
     std::vector<PaintedLine>                                                             &painted_lines;
-    std::mutex                                                                           &painted_lines_mutex;
     Line                                                                                  line_to_test;
     std::unordered_set<std::pair<size_t, size_t>, boost::hash<std::pair<size_t, size_t>>> painted_lines_set;
     int                                                                                   color             = -1;
@@ -1120,9 +1116,11 @@ static inline Polygon to_polygon(const std::vector<Linef> &lines)
 static std::vector<ExPolygons> extract_colored_segments(const MMU_Graph &graph, const size_t num_extruders)
 {
     std::vector<bool> used_arcs(graph.arcs.size(), false);
+    // Scratch buffer reused by all calls of get_next().
+    std::vector<std::pair<const MMU_Graph::Arc *, double>> sorted_arcs;
     // When there is no next arc, then is returned original_arc or edge with is marked as used
-    auto get_next = [&graph, &used_arcs](const Linef &process_line, const MMU_Graph::Arc &original_arc) -> const MMU_Graph::Arc & {
-        std::vector<std::pair<const MMU_Graph::Arc *, double>> sorted_arcs;
+    auto get_next = [&graph, &used_arcs, &sorted_arcs](const Linef &process_line, const MMU_Graph::Arc &original_arc) -> const MMU_Graph::Arc & {
+        sorted_arcs.clear();
         for (const size_t &arc_idx : graph.nodes[original_arc.to_idx].arc_idxs) {
             const MMU_Graph::Arc &arc = graph.arcs[arc_idx];
             if (graph.nodes[arc.to_idx].point == process_line.a || used_arcs[arc_idx])
@@ -1158,6 +1156,7 @@ static std::vector<ExPolygons> extract_colored_segments(const MMU_Graph &graph,
     };
 
     std::vector<ExPolygons> expolygons_segments(num_extruders + 1);
+    std::vector<Linef>      face_lines;
     for (size_t node_idx = 0; node_idx < graph.all_border_points; ++node_idx) {
         const MMU_Graph::Node &node = graph.nodes[node_idx];
 
@@ -1169,7 +1168,7 @@ static std::vector<ExPolygons> extract_colored_segments(const MMU_Graph &graph,
             Linef process_line(node.point, graph.nodes[arc.to_idx].point);
             used_arcs[arc_idx] = true;
 
-            std::vector<Linef> face_lines;
+            face_lines.clear();
             face_lines.emplace_back(process_line);
             Vec2d start_p = process_line.a;
 
@@ -1691,6 +1690,222 @@ static bool has_layer_only_one_color(const std::vector<std::vector<ColoredLine>>
     return true;
 }
 
+// A painted triangle transformed into the coordinate system of the PrintObject, with its vertices sorted by z.
+struct PaintedFacet
+{
+    std::array<Vec3f, 3> vertices;
+    int                  color;
+};
+
+// A painted triangle sliced at slice_z of a layer, not yet projected onto the contours of the layer.
+struct PaintedFacetSlice
+{
+    size_t layer_idx;
+    Line   line;
+    int    color;
+};
+
+// Collect the painted triangles of a model part, transformed by tr and sorted by their lowest z.
+static std::vector<PaintedFacet> collect_painted_facets(const ModelVolume &mv, const Transform3f &tr, const size_t num_extruders, const std::function<void()> &throw_on_cancel_callback)
+{
+    std::vector<std::vector<PaintedFacet>> extruders_facets(num_extruders + 1);
+    tbb::parallel_for(tbb::blocked_range<size_t>(1, num_extruders + 1), [&mv, &tr, &extruders_facets, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+        for (size_t extruder_idx = range.begin(); extruder_idx < range.end(); ++extruder_idx) {
+            throw_on_cancel_callback();
+            const indexed_triangle_set custom_facets = mv.mmu_segmentation_facets.get_facets(mv, EnforcerBlockerType(extruder_idx));
+            std::vector<PaintedFacet> &facets        = extruders_facets[extruder_idx];
+            facets.reserve(custom_facets.indices.size());
+            for (const stl_triangle_vertex_indices &face : custom_facets.indices) {
+                PaintedFacet &facet = facets.emplace_back();
+                for (int p_idx = 0; p_idx < 3; ++p_idx)
+                    facet.vertices[p_idx] = tr * custom_facets.vertices[face(p_idx)];
+
+                // Sort the vertices by z-axis for simplification of projected_facet on slices
+                std::sort(facet.vertices.begin(), facet.vertices.end(), [](const Vec3f &p1, const Vec3f &p2) { return p1.z() < p2.z(); });
+                facet.color = int(extruder_idx);
+            }
+        }
+    }); // end of parallel_for
+
+    std::vector<PaintedFacet> painted_facets;
+    for (std::vector<PaintedFacet> &facets : extruders_facets)
+        append(painted_facets, std::move(facets));
+
+    // Stable, so that the triangles starting at the same height stay in the order of the extruders.
+    std::stable_sort(painted_facets.begin(), painted_facets.end(), [](const PaintedFacet &l, const PaintedFacet &r) { return l.vertices[0].z() < r.vertices[0].z(); });
+    return painted_facets;
+}
+
+// Slice the painted triangles facets_idxs at slice_z of the layers <layer_begin, layer_end) they span.
+// The triangles are sliced in parallel in chunks of a fixed size. The slices of each chunk are sorted by layers,
+// so that the slices of a single layer could be later retrieved from all the chunks without any locking
+// and in an order not depending on the scheduling.
+static std::vector<std::vector<PaintedFacetSlice>> slice_painted_facets(const std::vector<PaintedFacet>    &painted_facets,
+                                                                        const std::vector<size_t>          &facets_idxs,
+                                                                        const SpanOfConstPtrs<Layer>        layers,
+                                                                        const size_t                        layer_begin,
+                                                                        const size_t                        layer_end,
+                                                                        const std::vector<ExPolygons>      &input_expolygons,
+                                                                        const Point                        &center_offset,
+                                                                        const std::function<void()>        &throw_on_cancel_callback)
+{
+    constexpr size_t                            chunk_size = 16384;
+    std::vector<std::vector<PaintedFacetSlice>> chunks_slices((facets_idxs.size() + chunk_size - 1) / chunk_size);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, chunks_slices.size()), [&painted_facets, &facets_idxs, &layers, layer_begin, layer_end, &input_expolygons, &center_offset, &chunks_slices, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+        for (size_t chunk_idx = range.begin(); chunk_idx < range.end(); ++chunk_idx) {
+            throw_on_cancel_callback();
+            std::vector<PaintedFacetSlice> &slices = chunks_slices[chunk_idx];
+            for (size_t idx = chunk_idx * chunk_size; idx < std::min(facets_idxs.size(), (chunk_idx + 1) * chunk_size); ++idx) {
+                const size_t                facet_idx = facets_idxs[idx];
+                const std::array<Vec3f, 3> &facet     = painted_facets[facet_idx].vertices;
+
+                // Find lowest slice not below the triangle.
+                auto first_layer = std::upper_bound(layers.begin() + layer_begin, layers.begin() + layer_end, float(facet[0].z() - EPSILON),
+                                                    [](float z, const Layer *l1) { return z < l1->slice_z; });
+                auto last_layer  = std::upper_bound(layers.begin() + layer_begin, layers.begin() + layer_end, float(facet[2].z() + EPSILON),
+                                                   [](float z, const Layer *l1) { return z < l1->slice_z; });
+
+                for (auto layer_it = first_layer; layer_it != last_layer; ++layer_it) {
+                    const Layer *layer     = *layer_it;
+                    size_t       layer_idx = layer_it - layers.begin();
+                    if (input_expolygons[layer_idx].empty() || facet[0].z() > layer->slice_z || layer->slice_z > facet[2].z())
+                        continue;
+
+                    // https://kandepet.com/3d-printing-slicing-3d-objects/
+                    float t            = (float(layer->slice_z) - facet[0].z()) / (facet[2].z() - facet[0].z());
+                    Vec3f line_start_f = facet[0] + t * (facet[2] - facet[0]);
+                    Vec3f line_end_f;
+
+                    if (facet[1].z() > layer->slice_z) {
+                        // [P0, P2] and [P0, P1]
+                        float t1   = (float(layer->slice_z) - facet[0].z()) / (facet[1].z() - facet[0].z());
+                        line_end_f = facet[0] + t1 * (facet[1] - facet[0]);
+                    } else {
+                        // [P0, P2] and [P1, P2]
+                        float t2   = (float(layer->slice_z) - facet[1].z()) / (facet[2].z() - facet[1].z());
+                        line_end_f = facet[1] + t2 * (facet[2] - facet[1]);
+                    }
+
+                    Line line(Point(scale_(line_start_f.x()), scale_(line_start_f.y())), Point(scale_(line_end_f.x()), scale_(line_end_f.y())));
+                    line.translate(-center_offset);
+                    slices.push_back({layer_idx, line, painted_facets[facet_idx].color});
+                }
+            }
+
+            // Stable, so that the slices of a layer stay in the order of the triangles.
+            std::stable_sort(slices.begin(), slices.end(), [](const PaintedFacetSlice &l, const PaintedFacetSlice &r) { return l.layer_idx < r.layer_idx; });
+        }
+    }); // end of parallel_for
+
+    return chunks_slices;
+}
+
+// Project the slices of the painted triangles onto the contours of the layers <layer_begin, layer_end).
+static void project_painted_facets_slices(const std::vector<std::vector<PaintedFacetSlice>> &painted_facets_slices,
+                                          const size_t                                       layer_begin,
+                                          const size_t                                       layer_end,
+                                          const std::vector<EdgeGrid::Grid>                 &edge_grids,
+                                          std::vector<std::vector<PaintedLine>>             &painted_lines,
+                                          const std::function<void()>                       &throw_on_cancel_callback)
+{
+    tbb::parallel_for(tbb::blocked_range<size_t>(layer_begin, layer_end), [&edge_grids, &painted_lines, &painted_facets_slices, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
+            throw_on_cancel_callback();
+            const EdgeGrid::Grid &edge_grid = edge_grids[layer_idx];
+            PaintedLineVisitor    visitor(edge_grid, painted_lines[layer_idx], 16);
+            for (const std::vector<PaintedFacetSlice> &slices : painted_facets_slices) {
+                auto slices_begin = std::lower_bound(slices.begin(), slices.end(), layer_idx, [](const PaintedFacetSlice &slice, size_t idx) { return slice.layer_idx < idx; });
+                for (auto slice_it = slices_begin; slice_it != slices.end() && slice_it->layer_idx == layer_idx; ++slice_it) {
+                    Line line_to_test = slice_it->line;
+
+                    // BoundingBoxes for EdgeGrids are computed from printable regions. It is possible that the painted line (line_to_test) could
+                    // be outside EdgeGrid's BoundingBox, for example, when the negative volume is used on the painted area (GH #7618).
+                    // To ensure that the painted line is always inside EdgeGrid's BoundingBox, it is clipped by EdgeGrid's BoundingBox in cases
+                    // when any of the endpoints of the line are outside the EdgeGrid's BoundingBox.
+                    if (const BoundingBox &edge_grid_bbox = edge_grid.bbox(); !edge_grid_bbox.contains(line_to_test.a) || !edge_grid_bbox.contains(line_to_test.b)) {
+                        // If the painted line (line_to_test) is entirely outside EdgeGrid's BoundingBox, skip this painted line.
+                        if (!edge_grid_bbox.overlap(BoundingBox(Points{line_to_test.a, line_to_test.b})) ||
+                            !line_to_test.clip_with_bbox(edge_grid_bbox))
+                            continue;
+                    }
+
+                    visitor.reset();
+                    visitor.line_to_test = line_to_test;
+                    visitor.color        = slice_it->color;
+                    edge_grid.visit_cells_intersecting_line(line_to_test.a, line_to_test.b, visitor);
+                }
+            }
+        }
+    }); // end of parallel_for
+}
+
+// Segment a single layer given the colorized contours of input_expolygons, ordered the same way as the contours
+// of an EdgeGrid created over input_expolygons. Inside of an expolygon, the Voronoi diagram of all the contours
+// of the layer is the same as the Voronoi diagram of just the contours of the expolygon, thus the expolygons
+// (islands) are segmented independently of each other and in parallel. Besides that, several smaller Voronoi
+// diagrams and graphs are cheaper to build and to walk than a single large one.
+static std::vector<ExPolygons> segment_colorized_layer(const size_t                            layer_idx,
+                                                       const ExPolygons                       &input_expolygons,
+                                                       std::vector<std::vector<ColoredLine>> &&color_poly,
+                                                       const size_t                            num_extruders)
+{
+    auto segment_island = [layer_idx, num_extruders](std::vector<std::vector<ColoredLine>> &island_color_poly, const ExPolygons &island_expolygons) {
+        assert(!island_color_poly.empty());
+        assert(!island_color_poly.front().empty());
+        std::vector<ExPolygons> segmented_regions(num_extruders + 1);
+        if (has_layer_only_one_color(island_color_poly)) {
+            // If the whole island is painted using the same color, it is not needed to construct a Voronoi diagram for its segmentation.
+            segmented_regions[size_t(island_color_poly.front().front().color)] = island_expolygons;
+        } else {
+            MMU_Graph graph = build_graph(layer_idx, island_color_poly);
+            remove_multiple_edges_in_vertices(graph, island_color_poly);
+            graph.remove_nodes_with_one_arc();
+
+#ifdef MMU_SEGMENTATION_DEBUG_GRAPH
+            {
+                static int iRun = 0;
+                export_graph_to_svg(debug_out_path("mm-graph-final-%d-%d.svg", layer_idx, iRun++), graph, island_expolygons);
+            }
+#endif // MMU_SEGMENTATION_DEBUG_GRAPH
+
+            segmented_regions = extract_colored_segments(graph, num_extruders);
+        }
+        return segmented_regions;
+    };
+
+    // Index of the first contour of each island, the same way as EdgeGrid::Grid::create() orders the contours.
+    std::vector<size_t> island_first_contour;
+    island_first_contour.reserve(input_expolygons.size() + 1);
+    island_first_contour.emplace_back(0);
+    for (const ExPolygon &expoly : input_expolygons)
+        island_first_contour.emplace_back(island_first_contour.back() + (expoly.contour.empty() ? 0 : 1) +
+                                          std::count_if(expoly.holes.begin(), expoly.holes.end(), [](const Polygon &hole) { return !hole.empty(); }));
+    assert(island_first_contour.back() == color_poly.size());
+
+    if (input_expolygons.size() <= 1 || island_first_contour.back() != color_poly.size())
+        return segment_island(color_poly, input_expolygons);
+
+    std::vector<std::vector<ExPolygons>> segmented_islands(input_expolygons.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, input_expolygons.size()), [&segment_island, &input_expolygons, &color_poly, &island_first_contour, &segmented_islands](const tbb::blocked_range<size_t> &range) {
+        for (size_t island_idx = range.begin(); island_idx < range.end(); ++island_idx) {
+            if (island_first_contour[island_idx] == island_first_contour[island_idx + 1])
+                continue;
+
+            std::vector<std::vector<ColoredLine>> island_color_poly(std::make_move_iterator(color_poly.begin() + island_first_contour[island_idx]),
+                                                                    std::make_move_iterator(color_poly.begin() + island_first_contour[island_idx + 1]));
+            segmented_islands[island_idx] = segment_island(island_color_poly, ExPolygons{input_expolygons[island_idx]});
+        }
+    }); // end of parallel_for
+
+    // Merged in the order of the islands, so that the result does not depend on the scheduling.
+    std::vector<ExPolygons> segmented_regions(num_extruders + 1);
+    for (std::vector<ExPolygons> &segmented_island : segmented_islands)
+        for (size_t color_idx = 0; color_idx < segmented_island.size(); ++color_idx)
+            append(segmented_regions[color_idx], std::move(segmented_island[color_idx]));
+
+    return segmented_regions;
+}
+
 std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback)
 {
     const size_t                          num_extruders = print_object.print()->config().nozzle_diameter.size();
@@ -1698,7 +1913,6 @@ std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(con
     std::vector<std::vector<ExPolygons>>  segmented_regions(num_layers);
     segmented_regions.assign(num_layers, std::vector<ExPolygons>(num_extruders + 1));
     std::vector<std::vector<PaintedLine>> painted_lines(num_layers);
-    std::array<std::mutex, 64>            painted_lines_mutex;
     std::vector<EdgeGrid::Grid>           edge_grids(num_layers);
     const SpanOfConstPtrs<Layer>          layers = print_object.layers();
     std::vector<ExPolygons>               input_expolygons(num_layers);
@@ -1760,85 +1974,35 @@ std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(con
     }
 
     BOOST_LOG_TRIVIAL(debug) << "MMU segmentation - projection of painted triangles - begin";
+    // The painted triangles are sliced and projected in bands of layers, so that only the slices of a single band are kept at once.
+    constexpr size_t layers_per_band = 64;
     for (const ModelVolume *mv : print_object.model_object()->volumes) {
-        tbb::parallel_for(tbb::blocked_range<size_t>(1, num_extruders + 1), [&mv, &print_object, &layers, &edge_grids, &painted_lines, &painted_lines_mutex, &input_expolygons, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
-            for (size_t extruder_idx = range.begin(); extruder_idx < range.end(); ++extruder_idx) {
-                throw_on_cancel_callback();
-                const indexed_triangle_set custom_facets = mv->mmu_segmentation_facets.get_facets(*mv, EnforcerBlockerType(extruder_idx));
-                if (!mv->is_model_part() || custom_facets.indices.empty())
-                    continue;
-
-                const Transform3f tr = print_object.trafo().cast<float>() * mv->get_matrix().cast<float>();
-                tbb::parallel_for(tbb::blocked_range<size_t>(0, custom_facets.indices.size()), [&tr, &custom_facets, &print_object, &layers, &edge_grids, &input_expolygons, &painted_lines, &painted_lines_mutex, &extruder_idx](const tbb::blocked_range<size_t> &range) {
-                    for (size_t facet_idx = range.begin(); facet_idx < range.end(); ++facet_idx) {
-                        float min_z = std::numeric_limits<float>::max();
-                        float max_z = std::numeric_limits<float>::lowest();
-
-                        std::array<Vec3f, 3> facet;
-                        for (int p_idx = 0; p_idx < 3; ++p_idx) {
-                            facet[p_idx] = tr * custom_facets.vertices[custom_facets.indices[facet_idx](p_idx)];
-                            max_z        = std::max(max_z, facet[p_idx].z());
-                            min_z        = std::min(min_z, facet[p_idx].z());
-                        }
-
-                        // Sort the vertices by z-axis for simplification of projected_facet on slices
-                        std::sort(facet.begin(), facet.end(), [](const Vec3f &p1, const Vec3f &p2) { return p1.z() < p2.z(); });
-
-                        // Find lowest slice not below the triangle.
-                        auto first_layer = std::upper_bound(layers.begin(), layers.end(), float(min_z - EPSILON),
-                                                            [](float z, const Layer *l1) { return z < l1->slice_z; });
-                        auto last_layer  = std::upper_bound(layers.begin(), layers.end(), float(max_z + EPSILON),
-                                                           [](float z, const Layer *l1) { return z < l1->slice_z; });
-                        --last_layer;
-
-                        for (auto layer_it = first_layer; layer_it != (last_layer + 1); ++layer_it) {
-                            const Layer *layer     = *layer_it;
-                            size_t       layer_idx = layer_it - layers.begin();
-                            if (input_expolygons[layer_idx].empty() || facet[0].z() > layer->slice_z || layer->slice_z > facet[2].z())
-                                continue;
-
-                            // https://kandepet.com/3d-printing-slicing-3d-objects/
-                            float t            = (float(layer->slice_z) - facet[0].z()) / (facet[2].z() - facet[0].z());
-                            Vec3f line_start_f = facet[0] + t * (facet[2] - facet[0]);
-                            Vec3f line_end_f;
-
-                            if (facet[1].z() > layer->slice_z) {
-                                // [P0, P2] and [P0, P1]
-                                float t1   = (float(layer->slice_z) - facet[0].z()) / (facet[1].z() - facet[0].z());
-                                line_end_f = facet[0] + t1 * (facet[1] - facet[0]);
-                            } else {
-                                // [P0, P2] and [P1, P2]
-                                float t2   = (float(layer->slice_z) - facet[1].z()) / (facet[2].z() - facet[1].z());
-                                line_end_f = facet[1] + t2 * (facet[2] - facet[1]);
-                            }
-
-                            Line line_to_test(Point(scale_(line_start_f.x()), scale_(line_start_f.y())),
-                                              Point(scale_(line_end_f.x()), scale_(line_end_f.y())));
-                            line_to_test.translate(-print_object.center_offset());
-
-                            // BoundingBoxes for EdgeGrids are computed from printable regions. It is possible that the painted line (line_to_test) could
-                            // be outside EdgeGrid's BoundingBox, for example, when the negative volume is used on the painted area (GH #7618).
-                            // To ensure that the painted line is always inside EdgeGrid's BoundingBox, it is clipped by EdgeGrid's BoundingBox in cases
-                            // when any of the endpoints of the line are outside the EdgeGrid's BoundingBox.
-                            if (const BoundingBox &edge_grid_bbox = edge_grids[layer_idx].bbox(); !edge_grid_bbox.contains(line_to_test.a) || !edge_grid_bbox.contains(line_to_test.b)) {
-                                // If the painted line (line_to_test) is entirely outside EdgeGrid's BoundingBox, skip this painted line.
-                                if (!edge_grid_bbox.overlap(BoundingBox(Points{line_to_test.a, line_to_test.b})) ||
-                                    !line_to_test.clip_with_bbox(edge_grid_bbox))
-                                    continue;
-                            }
+        if (!mv->is_model_part() || num_layers == 0)
+            continue;
 
-                            size_t mutex_idx = layer_idx & 0x3F;
-                            assert(mutex_idx < painted_lines_mutex.size());
+        const Transform3f               tr             = print_object.trafo().cast<float>() * mv->get_matrix().cast<float>();
+        const std::vector<PaintedFacet> painted_facets = collect_painted_facets(*mv, tr, num_extruders, throw_on_cancel_callback);
+        // Indices of the triangles reaching the current band, in the order of painted_facets.
+        std::vector<size_t>             band_facets;
+        size_t                          next_facet     = 0;
+        for (size_t band_begin = 0; band_begin < num_layers && (next_facet < painted_facets.size() || !band_facets.empty()); band_begin += layers_per_band) {
+            const size_t band_end    = std::min(band_begin + layers_per_band, num_layers);
+            const float  band_bottom = float(layers[band_begin]->slice_z - EPSILON);
+            const float  band_top    = float(layers[band_end - 1]->slice_z + EPSILON);
+
+            band_facets.erase(std::remove_if(band_facets.begin(), band_facets.end(), [&painted_facets, band_bottom](size_t facet_idx) { return painted_facets[facet_idx].vertices[2].z() < band_bottom; }), band_facets.end());
+            for (; next_facet < painted_facets.size() && painted_facets[next_facet].vertices[0].z() <= band_top; ++next_facet)
+                if (painted_facets[next_facet].vertices[2].z() >= band_bottom)
+                    band_facets.emplace_back(next_facet);
+
+            if (band_facets.empty())
+                continue;
 
-                            PaintedLineVisitor visitor(edge_grids[layer_idx], painted_lines[layer_idx], painted_lines_mutex[mutex_idx], 16);
-                            visitor.line_to_test = line_to_test;
-                            visitor.color        = int(extruder_idx);
-                            edge_grids[layer_idx].visit_cells_intersecting_line(line_to_test.a, line_to_test.b, visitor);
-                        }
-                    }
-                }); // end of parallel_for
-            }
-        }); // end of parallel_for
+            const std::vector<std::vector<PaintedFacetSlice>> painted_facets_slices =
+                slice_painted_facets(painted_facets, band_facets, layers, band_begin, band_end, input_expolygons, print_object.center_offset(), throw_on_cancel_callback);
+            throw_on_cancel_callback();
+            project_painted_facets_slices(painted_facets_slices, band_begin, band_end, edge_grids, painted_lines, throw_on_cancel_callback);
+        }
     }
     BOOST_LOG_TRIVIAL(debug) << "MMU segmentation - projection of painted triangles - end";
     BOOST_LOG_TRIVIAL(debug) << "MMU segmentation - painted layers count: "
@@ -1874,25 +2038,7 @@ std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(con
                 }
 #endif // MMU_SEGMENTATION_DEBUG_COLORIZED_POLYGONS
 
-                assert(!color_poly.empty());
-                assert(!color_poly.front().empty());
-                if (has_layer_only_one_color(color_poly)) {
-                    // If the whole layer is painted using the same color, it is not needed to construct a Voronoi diagram for the segmentation of this layer.
-                    segmented_regions[layer_idx][size_t(color_poly.front().front().color)] = input_expolygons[layer_idx];
-                } else {
-                    MMU_Graph graph = build_graph(layer_idx, color_poly);
-                    remove_multiple_edges_in_vertices(graph, color_poly);
-                    graph.remove_nodes_with_one_arc();
-
-#ifdef MMU_SEGMENTATION_DEBUG_GRAPH
-                    {
-                        static int iRun = 0;
-                        export_graph_to_svg(debug_out_path("mm-graph-final-%d-%d.svg", layer_idx, iRun++), graph, input_expolygons[layer_idx]);
-                    }
-#endif // MMU_SEGMENTATION_DEBUG_GRAPH
-
-                    segmented_regions[layer_idx] = extract_colored_segments(graph, num_extruders);
-                }
+                segmented_regions[layer_idx] = segment_colorized_layer(layer_idx, input_expolygons[layer_idx], std::move(color_poly), num_extruders);
 
 #ifdef MMU_SEGMENTATION_DEBUG_REGIONS
                 {
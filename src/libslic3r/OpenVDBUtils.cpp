@@ -308,4 +308,9 @@ bool is_grid_empty(const VoxelGrid &grid)
     return grid.grid.empty();
 }
 
+size_t active_voxel_count(const VoxelGrid &grid)
+{
+    return size_t(grid.grid.activeVoxelCount());
+}
+
 } // namespace Slic3r
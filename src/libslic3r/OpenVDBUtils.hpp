@@ -83,6 +83,8 @@ void grid_intersection(VoxelGrid &grid, VoxelGrid &arg);
 
 bool is_grid_empty(const VoxelGrid &grid);
 
+size_t active_voxel_count(const VoxelGrid &grid);
+
 } // namespace Slic3r
 
 #endif // OPENVDBUTILS_HPP
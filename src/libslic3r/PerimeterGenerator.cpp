@@ -43,6 +43,7 @@
 #include <limits>
 #include <list>
 #include <math.h>
+#include <mutex>
 #include <ostream>
 #include <stack>
 #include <string>
@@ -1077,6 +1078,223 @@ std::tuple<std::vector<ExtrusionPaths>, Polygons> generate_extra_perimeters_over
     return {extra_perims, diff(inset_overhang_area, inset_overhang_area_left_unfilled)};
 }
 
+struct PerimeterGenerator::Cache::ClassicIsland
+{
+    // Number of the loops actually generated, -1 if none.
+    int                         loop_number { -1 };
+    // Loops nested into the external loops.
+    PerimeterGeneratorLoops     loops;
+    ThickPolylines              thin_walls;
+    ExtrusionEntityCollection   gap_fill;
+    // Infill areas before the extra perimeters over overhangs are cut out of them.
+    ExPolygons                  infill_areas;
+};
+
+struct PerimeterGenerator::Cache::ArachneIsland
+{
+    // Number of the loops actually generated, -1 if none.
+    int                                      loop_number { -1 };
+    std::vector<Arachne::VariableWidthLines> perimeters;
+    // Infill areas before the extra perimeters over overhangs are cut out of them.
+    ExPolygons                               infill_areas;
+};
+
+static size_t memsize(const PerimeterGeneratorLoops &loops)
+{
+    size_t out = loops.capacity() * sizeof(PerimeterGeneratorLoop);
+    for (const PerimeterGeneratorLoop &loop : loops)
+        out += loop.polygon.size() * sizeof(Point) + memsize(loop.children);
+    return out;
+}
+
+static size_t memsize(const PerimeterGenerator::Cache::ClassicIsland &island)
+{
+    size_t out = sizeof(island) + memsize(island.loops);
+    for (const ThickPolyline &thin_wall : island.thin_walls)
+        out += thin_wall.size() * (sizeof(Point) + 2 * sizeof(coordf_t));
+    for (const ExtrusionEntity *gap_fill : island.gap_fill.entities)
+        out += gap_fill->as_polyline().size() * sizeof(Point);
+    for (const ExPolygon &expoly : island.infill_areas)
+        out += count_points(expoly) * sizeof(Point);
+    return out;
+}
+
+static size_t memsize(const PerimeterGenerator::Cache::ArachneIsland &island)
+{
+    size_t out = sizeof(island);
+    for (const Arachne::VariableWidthLines &lines : island.perimeters)
+        for (const Arachne::ExtrusionLine &line : lines)
+            out += sizeof(line) + line.size() * sizeof(Arachne::ExtrusionJunction);
+    for (const ExPolygon &expoly : island.infill_areas)
+        out += count_points(expoly) * sizeof(Point);
+    return out;
+}
+
+struct PerimeterGenerator::Cache::Impl
+{
+    // The cache stops growing above this limit, the islands above it are just generated.
+    static constexpr size_t memory_limit = size_t(256) << 20;
+
+    std::mutex                                                             mutex;
+    std::unordered_map<std::string, std::shared_ptr<const ClassicIsland>>  classic;
+    std::unordered_map<std::string, std::shared_ptr<const ArachneIsland>>  arachne;
+    size_t                                                                 memory = 0;
+    size_t                                                                 hits   = 0;
+
+    template<typename Island>
+    std::shared_ptr<const Island> find_or_generate(std::unordered_map<std::string, std::shared_ptr<const Island>> &islands,
+                                                   std::string &&key, const std::function<Island()> &generate)
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (auto it = islands.find(key); it != islands.end()) {
+                ++ this->hits;
+                return it->second;
+            }
+        }
+        // Generated outside of the lock. If another layer generates the same island meanwhile, the first one stored wins.
+        auto   island = std::make_shared<const Island>(generate());
+        size_t size   = memsize(*island) + key.size();
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (this->memory + size <= memory_limit)
+            if (auto [it, inserted] = islands.emplace(std::move(key), island); inserted)
+                this->memory += size;
+        return island;
+    }
+};
+
+PerimeterGenerator::Cache::Cache() : m_impl(std::make_unique<Impl>()) {}
+PerimeterGenerator::Cache::~Cache() = default;
+
+std::shared_ptr<const PerimeterGenerator::Cache::ClassicIsland> PerimeterGenerator::Cache::classic(std::string &&key, const std::function<ClassicIsland()> &generate)
+{
+    return m_impl->find_or_generate(m_impl->classic, std::move(key), generate);
+}
+
+std::shared_ptr<const PerimeterGenerator::Cache::ArachneIsland> PerimeterGenerator::Cache::arachne(std::string &&key, const std::function<ArachneIsland()> &generate)
+{
+    return m_impl->find_or_generate(m_impl->arachne, std::move(key), generate);
+}
+
+size_t PerimeterGenerator::Cache::hits() const
+{
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    return m_impl->hits;
+}
+
+template<typename T> static void append_key(std::string &key, const T &data)
+{
+    key.append(reinterpret_cast<const char*>(&data), sizeof(data));
+}
+
+static void append_key(std::string &key, const Polygon &polygon)
+{
+    append_key(key, polygon.size());
+    key.append(reinterpret_cast<const char*>(polygon.points.data()), polygon.size() * sizeof(Point));
+}
+
+static void append_key(std::string &key, const Flow &flow)
+{
+    append_key(key, flow.width());
+    append_key(key, flow.height());
+    append_key(key, flow.nozzle_diameter());
+}
+
+// Key of the perimeters of an island in PerimeterGenerator::Cache, made of everything the island depends on
+// except for the layers around: the outline and the parameters varying between the layers and regions of an object.
+static std::string island_key(const PerimeterGenerator::Parameters &params, int loop_number)
+{
+    std::string key;
+    // The region config is alive and unique for the region during the whole perimeter generation.
+    append_key(key, &params.config);
+    append_key(key, params.layer_height);
+    // The fuzzy skin is not applied to the first layer.
+    append_key(key, params.layer_id > 0);
+    append_key(key, params.spiral_vase);
+    append_key(key, params.perimeter_flow);
+    append_key(key, params.ext_perimeter_flow);
+    append_key(key, params.solid_infill_flow);
+    append_key(key, loop_number);
+    return key;
+}
+
+static std::string classic_island_key(const PerimeterGenerator::Parameters &params, const ExPolygons &outline, int loop_number)
+{
+    std::string key = island_key(params, loop_number);
+    for (const ExPolygon &expoly : outline) {
+        append_key(key, expoly.holes.size());
+        append_key(key, expoly.contour);
+        for (const Polygon &hole : expoly.holes)
+            append_key(key, hole);
+    }
+    return key;
+}
+
+static std::string arachne_island_key(const PerimeterGenerator::Parameters &params, const Polygons &outline, int loop_number)
+{
+    std::string key = island_key(params, loop_number);
+    for (const Polygon &polygon : outline)
+        append_key(key, polygon);
+    return key;
+}
+
+// Perimeters of an island generated by Arachne, which don't depend on the layers around.
+static PerimeterGenerator::Cache::ArachneIsland generate_arachne_island(const PerimeterGenerator::Parameters &params, const Polygons &last_p, int loop_number)
+{
+    PerimeterGenerator::Cache::ArachneIsland island;
+    // other perimeters
+    coord_t perimeter_spacing      = params.perimeter_flow.scaled_spacing();
+    // external perimeters
+    coord_t ext_perimeter_spacing  = params.ext_perimeter_flow.scaled_spacing();
+    coord_t ext_perimeter_spacing2 = scaled<coord_t>(0.5f * (params.ext_perimeter_flow.spacing() + params.perimeter_flow.spacing()));
+    // solid infill
+    coord_t solid_infill_spacing   = params.solid_infill_flow.scaled_spacing();
+
+    Arachne::WallToolPaths wallToolPaths(last_p, ext_perimeter_spacing, perimeter_spacing, coord_t(loop_number + 1), 0, params.layer_height, params.object_config, params.print_config);
+    island.perimeters = wallToolPaths.getToolPaths();
+    loop_number = int(island.perimeters.size()) - 1;
+
+#ifdef ARACHNE_DEBUG
+    {
+        static int iRun = 0;
+        export_perimeters_to_svg(debug_out_path("arachne-perimeters-%d-%d.svg", layer_id, iRun++), last_p, island.perimeters, union_ex(wallToolPaths.getInnerContour()));
+    }
+#endif
+
+    ExPolygons    infill_contour = union_ex(wallToolPaths.getInnerContour());
+    const coord_t spacing        = (island.perimeters.size() == 1) ? ext_perimeter_spacing2 : perimeter_spacing;
+    if (offset_ex(infill_contour, -float(spacing / 2.)).empty())
+        infill_contour.clear(); // Infill region is too small, so let's filter it out.
+
+    // create one more offset to be used as boundary for fill
+    // we offset by half the perimeter spacing (to get to the actual infill boundary)
+    // and then we offset back and forth by half the infill spacing to only consider the
+    // non-collapsing regions
+    coord_t inset =
+        (loop_number < 0) ? 0 :
+        (loop_number == 0) ?
+                            // one loop
+            ext_perimeter_spacing:
+            // two or more loops?
+            perimeter_spacing;
+
+    inset = coord_t(scale_(params.config.get_abs_value("infill_overlap", unscale<double>(inset))));
+    Polygons pp;
+    for (ExPolygon &ex : infill_contour)
+        ex.simplify_p(params.scaled_resolution, &pp);
+    // collapse too narrow infill areas
+    const auto    min_perimeter_infill_spacing = coord_t(solid_infill_spacing * (1. - INSET_OVERLAP_TOLERANCE));
+    // append infill areas to fill_surfaces
+    island.infill_areas =
+        offset2_ex(
+            union_ex(pp),
+            float(- min_perimeter_infill_spacing / 2.),
+            float(inset + min_perimeter_infill_spacing / 2.));
+
+    island.loop_number = loop_number;
+    return island;
+}
+
 // Thanks, Cura developers, for implementing an algorithm for generating perimeters with variable width (Arachne) that is based on the paper
 // "A framework for adaptive width control of dense contour-parallel toolpaths in fused deposition modeling"
 void PerimeterGenerator::process_arachne(
@@ -1094,14 +1312,9 @@ void PerimeterGenerator::process_arachne(
     // Infills without the gap fills
     ExPolygons                 &out_fill_expolygons)
 {
-    // other perimeters
-    coord_t perimeter_spacing     = params.perimeter_flow.scaled_spacing();
     // external perimeters
     coord_t ext_perimeter_width    = params.ext_perimeter_flow.scaled_width();
     coord_t ext_perimeter_spacing  = params.ext_perimeter_flow.scaled_spacing();
-    coord_t ext_perimeter_spacing2 = scaled<coord_t>(0.5f * (params.ext_perimeter_flow.spacing() + params.perimeter_flow.spacing()));
-    // solid infill
-    coord_t solid_infill_spacing  = params.solid_infill_flow.scaled_spacing();
 
     // prepare grown lower layer slices for overhang detection
     if (params.config.overhangs && lower_slices != nullptr && lower_slices_polygons_cache.empty()) {
@@ -1119,16 +1332,15 @@ void PerimeterGenerator::process_arachne(
     ExPolygons last        = offset_ex(surface.expolygon.simplify_p(params.scaled_resolution), - float(ext_perimeter_width / 2. - ext_perimeter_spacing / 2.));
     Polygons   last_p      = to_polygons(last);
 
-    Arachne::WallToolPaths wallToolPaths(last_p, ext_perimeter_spacing, perimeter_spacing, coord_t(loop_number + 1), 0, params.layer_height, params.object_config, params.print_config);
-    std::vector<Arachne::VariableWidthLines> perimeters = wallToolPaths.getToolPaths();
-    loop_number = int(perimeters.size()) - 1;
+    std::shared_ptr<const Cache::ArachneIsland> island;
+    if (params.cache)
+        island = params.cache->arachne(arachne_island_key(params, last_p, loop_number),
+            [&params, &last_p, loop_number]() { return generate_arachne_island(params, last_p, loop_number); });
+    else
+        island = std::make_shared<const Cache::ArachneIsland>(generate_arachne_island(params, last_p, loop_number));
 
-#ifdef ARACHNE_DEBUG
-    {
-        static int iRun = 0;
-        export_perimeters_to_svg(debug_out_path("arachne-perimeters-%d-%d.svg", layer_id, iRun++), to_polygons(last), perimeters, union_ex(wallToolPaths.getInnerContour()));
-    }
-#endif
+    std::vector<Arachne::VariableWidthLines> perimeters = island->perimeters;
+    loop_number = island->loop_number;
 
     // All closed ExtrusionLine should have the same the first and the last point.
     // But in rare cases, Arachne produce ExtrusionLine marked as closed but without
@@ -1273,36 +1485,7 @@ void PerimeterGenerator::process_arachne(
     if (ExtrusionEntityCollection extrusion_coll = traverse_extrusions(params, lower_slices_polygons_cache, ordered_extrusions); !extrusion_coll.empty())
         out_loops.append(extrusion_coll);
 
-    ExPolygons    infill_contour = union_ex(wallToolPaths.getInnerContour());
-    const coord_t spacing        = (perimeters.size() == 1) ? ext_perimeter_spacing2 : perimeter_spacing;
-    if (offset_ex(infill_contour, -float(spacing / 2.)).empty())
-        infill_contour.clear(); // Infill region is too small, so let's filter it out.
-
-    // create one more offset to be used as boundary for fill
-    // we offset by half the perimeter spacing (to get to the actual infill boundary)
-    // and then we offset back and forth by half the infill spacing to only consider the
-    // non-collapsing regions
-    coord_t inset =
-        (loop_number < 0) ? 0 :
-        (loop_number == 0) ?
-                            // one loop
-            ext_perimeter_spacing:
-            // two or more loops?
-            perimeter_spacing;
-
-    inset = coord_t(scale_(params.config.get_abs_value("infill_overlap", unscale<double>(inset))));
-    Polygons pp;
-    for (ExPolygon &ex : infill_contour)
-        ex.simplify_p(params.scaled_resolution, &pp);
-    // collapse too narrow infill areas
-    const auto    min_perimeter_infill_spacing = coord_t(solid_infill_spacing * (1. - INSET_OVERLAP_TOLERANCE));
-    // append infill areas to fill_surfaces
-    ExPolygons infill_areas =
-        offset2_ex(
-            union_ex(pp),
-            float(- min_perimeter_infill_spacing / 2.),
-            float(inset + min_perimeter_infill_spacing / 2.));
-
+    ExPolygons infill_areas = island->infill_areas;
     if (lower_slices != nullptr && params.config.overhangs && params.config.extra_perimeters_on_overhangs &&
         params.config.perimeters > 0 && params.layer_id > params.object_config.raft_layers) {
         // Generate extra perimeters on overhang areas, and cut them to these parts only, to save print time and material
@@ -1325,21 +1508,10 @@ void PerimeterGenerator::process_arachne(
     append(out_fill_expolygons, std::move(infill_areas));
 }
 
-void PerimeterGenerator::process_classic(
-    // Inputs:
-    const Parameters           &params,
-    const Surface              &surface,
-    const ExPolygons           *lower_slices,
-    // Cache:
-    Polygons                   &lower_slices_polygons_cache,
-    // Output:
-    // Loops with the external thin walls
-    ExtrusionEntityCollection  &out_loops,
-    // Gaps without the thin walls
-    ExtrusionEntityCollection  &out_gap_fill,
-    // Infills without the gap fills
-    ExPolygons                 &out_fill_expolygons)
+// Perimeters of an island generated by the classic perimeter generator, which don't depend on the layers around.
+static PerimeterGenerator::Cache::ClassicIsland generate_classic_island(const PerimeterGenerator::Parameters &params, ExPolygons last, int loop_number)
 {
+    PerimeterGenerator::Cache::ClassicIsland island;
     // other perimeters
     coord_t perimeter_width         = params.perimeter_flow.scaled_width();
     coord_t perimeter_spacing       = params.perimeter_flow.scaled_spacing();
@@ -1364,20 +1536,6 @@ void PerimeterGenerator::process_classic(
     coord_t ext_min_spacing     = coord_t(ext_perimeter_spacing  * (1 - INSET_OVERLAP_TOLERANCE));
     bool    has_gap_fill 		= params.config.gap_fill_enabled.value && params.config.gap_fill_speed.value > 0;
 
-    // prepare grown lower layer slices for overhang detection
-    if (params.config.overhangs && lower_slices != nullptr && lower_slices_polygons_cache.empty()) {
-        // We consider overhang any part where the entire nozzle diameter is not supported by the
-        // lower layer, so we take lower slices and offset them by half the nozzle diameter used 
-        // in the current layer
-        double nozzle_diameter = params.print_config.nozzle_diameter.get_at(params.config.perimeter_extruder-1);
-        lower_slices_polygons_cache = offset(*lower_slices, float(scale_(+nozzle_diameter/2)));
-    }
-
-    // we need to process each island separately because we might have different
-    // extra perimeters for each one
-    // detect how many perimeters must be generated for this island
-    int        loop_number = params.config.perimeters + surface.extra_perimeters - 1;  // 0-indexed loops
-    ExPolygons last        = union_ex(surface.expolygon.simplify_p(params.scaled_resolution));
     ExPolygons gaps;
     if (loop_number >= 0) {
         // In case no perimeters are to be generated, loop_number will equal to -1.
@@ -1531,16 +1689,8 @@ void PerimeterGenerator::process_classic(
             }
         }
         // at this point, all loops should be in contours[0]
-        ExtrusionEntityCollection entities = traverse_loops_classic(params, lower_slices_polygons_cache, contours.front(), thin_walls);
-        // if brim will be printed, reverse the order of perimeters so that
-        // we continue inwards after having finished the brim
-        // TODO: add test for perimeter order
-        if (params.config.external_perimeters_first || 
-            (params.layer_id == 0 && params.object_config.brim_width.value > 0))
-            entities.reverse();
-        // append perimeters for this slice as a collection
-        if (! entities.empty())
-            out_loops.append(entities);
+        island.loops      = std::move(contours.front());
+        island.thin_walls = std::move(thin_walls);
     } // for each loop of an island
 
     // fill gaps
@@ -1567,7 +1717,7 @@ void PerimeterGenerator::process_classic(
             //FIXME Vojtech: This grows by a rounded extrusion width, not by line spacing,
             // therefore it may cover the area, but no the volume.
             last = diff_ex(last, gap_fill.polygons_covered_by_width(10.f));
-			out_gap_fill.append(std::move(gap_fill.entities));
+			island.gap_fill = std::move(gap_fill);
 		}
     }
 
@@ -1592,12 +1742,73 @@ void PerimeterGenerator::process_classic(
     // collapse too narrow infill areas
     coord_t min_perimeter_infill_spacing = coord_t(solid_infill_spacing * (1. - INSET_OVERLAP_TOLERANCE));
     // append infill areas to fill_surfaces
-    ExPolygons infill_areas =
+    island.infill_areas =
         offset2_ex(
             union_ex(pp),
             float(- inset - min_perimeter_infill_spacing / 2.),
             float(min_perimeter_infill_spacing / 2.));
 
+    island.loop_number = loop_number;
+    return island;
+}
+
+void PerimeterGenerator::process_classic(
+    // Inputs:
+    const Parameters           &params,
+    const Surface              &surface,
+    const ExPolygons           *lower_slices,
+    // Cache:
+    Polygons                   &lower_slices_polygons_cache,
+    // Output:
+    // Loops with the external thin walls
+    ExtrusionEntityCollection  &out_loops,
+    // Gaps without the thin walls
+    ExtrusionEntityCollection  &out_gap_fill,
+    // Infills without the gap fills
+    ExPolygons                 &out_fill_expolygons)
+{
+    // prepare grown lower layer slices for overhang detection
+    if (params.config.overhangs && lower_slices != nullptr && lower_slices_polygons_cache.empty()) {
+        // We consider overhang any part where the entire nozzle diameter is not supported by the
+        // lower layer, so we take lower slices and offset them by half the nozzle diameter used 
+        // in the current layer
+        double nozzle_diameter = params.print_config.nozzle_diameter.get_at(params.config.perimeter_extruder-1);
+        lower_slices_polygons_cache = offset(*lower_slices, float(scale_(+nozzle_diameter/2)));
+    }
+
+    // we need to process each island separately because we might have different
+    // extra perimeters for each one
+    // detect how many perimeters must be generated for this island
+    int        loop_number = params.config.perimeters + surface.extra_perimeters - 1;  // 0-indexed loops
+    ExPolygons last        = union_ex(surface.expolygon.simplify_p(params.scaled_resolution));
+    std::shared_ptr<const Cache::ClassicIsland> island;
+    if (params.cache)
+        island = params.cache->classic(classic_island_key(params, last, loop_number),
+            [&params, &last, loop_number]() { return generate_classic_island(params, last, loop_number); });
+    else
+        island = std::make_shared<const Cache::ClassicIsland>(generate_classic_island(params, std::move(last), loop_number));
+
+    if (loop_number >= 0) {
+        // The thin walls are consumed by the traversal.
+        ThickPolylines thin_walls = island->thin_walls;
+        ExtrusionEntityCollection entities = traverse_loops_classic(params, lower_slices_polygons_cache, island->loops, thin_walls);
+        // if brim will be printed, reverse the order of perimeters so that
+        // we continue inwards after having finished the brim
+        // TODO: add test for perimeter order
+        if (params.config.external_perimeters_first || 
+            (params.layer_id == 0 && params.object_config.brim_width.value > 0))
+            entities.reverse();
+        // append perimeters for this slice as a collection
+        if (! entities.empty())
+            out_loops.append(entities);
+    }
+    // The number of loops actually generated.
+    loop_number = island->loop_number;
+
+    if (! island->gap_fill.empty())
+        out_gap_fill.append(island->gap_fill.entities);
+
+    ExPolygons infill_areas = island->infill_areas;
     if (lower_slices != nullptr && params.config.overhangs && params.config.extra_perimeters_on_overhangs &&
         params.config.perimeters > 0 && params.layer_id > params.object_config.raft_layers) {
         // Generate extra perimeters on overhang areas, and cut them to these parts only, to save print time and material
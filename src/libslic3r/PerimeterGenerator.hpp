@@ -8,6 +8,9 @@
 #define slic3r_PerimeterGenerator_hpp_
 
 #include "libslic3r.h"
+#include <functional>
+#include <memory>
+#include <string>
 #include <vector>
 #include "ExtrusionEntityCollection.hpp"
 #include "Flow.hpp"
@@ -20,6 +23,31 @@ namespace Slic3r {
 namespace PerimeterGenerator
 {
 
+// Memo of the perimeters of the islands of a single PrintObject, shared by its layers processed in parallel.
+// Prismatic objects produce many layers with exactly the same islands. The perimeters of such an island
+// are generated just once, only the steps depending on the layers around, like the overhang detection, are repeated.
+class Cache
+{
+public:
+    Cache();
+    ~Cache();
+
+    // Perimeters of an island not depending on the layers around, defined in PerimeterGenerator.cpp.
+    struct ClassicIsland;
+    struct ArachneIsland;
+
+    // Return the island of the given key, call generate() if it is not cached yet.
+    std::shared_ptr<const ClassicIsland> classic(std::string &&key, const std::function<ClassicIsland()> &generate);
+    std::shared_ptr<const ArachneIsland> arachne(std::string &&key, const std::function<ArachneIsland()> &generate);
+
+    // Number of the islands served from the cache.
+    size_t hits() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
 struct Parameters {    
     Parameters(
         double                      layer_height,
@@ -67,6 +95,9 @@ struct Parameters {
     double                       mm3_per_mm;
     double                       mm3_per_mm_overhang;
 
+    // Memo of the perimeters shared by the layers of the object, may be null.
+    Cache                       *cache { nullptr };
+
 private:
     Parameters() = delete;
 };
@@ -945,9 +945,24 @@ void Print::process()
         }
     }, tbb::simple_partitioner());
 
-    // The following step writes to m_shared_regions, it should not run in parallel.
-    for (PrintObject *obj : m_objects)
-        obj->generate_support_spots();
+    // The following step writes to m_shared_regions, which are shared by the PrintObjects of the same ModelObject.
+    // Search the support spots in parallel for a single PrintObject of each PrintObjectRegions, then let the rest
+    // of the PrintObjects pick up the shared result.
+    {
+        std::vector<PrintObject*>                    search_objects;
+        std::vector<const PrintObjectRegions*>       search_regions;
+        for (PrintObject *obj : m_objects)
+            if (std::find(search_regions.begin(), search_regions.end(), obj->shared_regions()) == search_regions.end()) {
+                search_objects.emplace_back(obj);
+                search_regions.emplace_back(obj->shared_regions());
+            }
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, search_objects.size(), 1), [&search_objects](const tbb::blocked_range<size_t> &range) {
+            for (size_t idx = range.begin(); idx < range.end(); ++ idx)
+                search_objects[idx]->generate_support_spots();
+        }, tbb::simple_partitioner());
+        for (PrintObject *obj : m_objects)
+            obj->generate_support_spots();
+    }
     // check data from previous step, format the error message(s) and send alert to ui
     // this also has to be done sequentially.
     alert_when_supports_needed();
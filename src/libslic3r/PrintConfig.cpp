@@ -3035,6 +3035,31 @@ void PrintConfigDef::init_fff_params()
     def->mode = comAdvanced;
     def->set_default_value(new ConfigOptionPercent(15));
 
+    def = this->add("support_tree_cache_memory_budget", coInt);
+    def->label = L("Cache memory budget");
+    def->category = L("Support material");
+    // TRN PrintSettings: "Organic supports" > "Cache memory budget"
+    def->tooltip = L("Memory the collision and avoidance areas of organic supports may occupy. "
+                     "Over the budget, the least recently used areas are released and recalculated when needed again, "
+                     "which lowers the memory footprint of tall objects at the cost of a longer calculation. "
+                     "Set zero to keep all the areas in memory.");
+    def->sidetext = L("MB");
+    def->min = 0;
+    def->mode = comExpert;
+    def->set_default_value(new ConfigOptionInt(0));
+
+    def = this->add("support_tree_radius_quantization", coFloat);
+    def->label = L("Radius quantization");
+    def->category = L("Support material");
+    // TRN PrintSettings: "Organic supports" > "Radius quantization"
+    def->tooltip = L("Growth factor of the branch radii the collision and avoidance areas are calculated for. "
+                     "A higher value calculates the areas for less radii, which saves time and memory, "
+                     "at the cost of the thick branches keeping more distance from the model.");
+    def->min = 1.5;
+    def->max = 4.;
+    def->mode = comExpert;
+    def->set_default_value(new ConfigOptionFloat(1.5));
+
     def = this->add("temperature", coInts);
     def->label = L("Other layers");
     def->tooltip = L("Nozzle temperature for layers after the first one. Set this to zero to disable "
@@ -4206,6 +4231,18 @@ void PrintConfigDef::init_sla_params()
     def->mode = comExpert;
     def->set_default_value(new ConfigOptionFloat(2.0));
 
+    def = this->add("hollowing_tile_voxels", coInt);
+    def->label = L("Voxels per tile");
+    def->category = L("Hollowing");
+    def->tooltip  = L(
+        "Big models are hollowed in horizontal slabs of at most this many "
+        "voxels (in millions), one after the other, to limit the memory used. "
+        "Set zero to hollow the model in one piece.");
+    def->sidetext = L("millions");
+    def->min = 0;
+    def->mode = comExpert;
+    def->set_default_value(new ConfigOptionInt(0));
+
     def = this->add("material_print_speed", coEnum);
     def->label = L("Print speed");
     def->tooltip = L(
@@ -584,6 +584,8 @@ PRINT_CONFIG_CLASS_DEFINE(
     ((ConfigOptionPercent,             support_tree_top_rate))
     ((ConfigOptionFloat,               support_tree_branch_distance))
     ((ConfigOptionFloat,               support_tree_tip_diameter))
+    ((ConfigOptionInt,                 support_tree_cache_memory_budget))
+    ((ConfigOptionFloat,               support_tree_radius_quantization))
     // The rest
     ((ConfigOptionBool,                thick_bridges))
     ((ConfigOptionFloat,               xy_size_compensation))
@@ -1081,6 +1083,10 @@ PRINT_CONFIG_CLASS_DEFINE(
 
     // Indirectly controls the minimum size of created cavities.
     ((ConfigOptionFloat, hollowing_closing_distance))
+
+    // Millions of voxels of the slabs the model is hollowed in, zero to hollow
+    // the model in one piece.
+    ((ConfigOptionInt, hollowing_tile_voxels))
 )
 
 enum SLAMaterialSpeed { slamsSlow, slamsFast, slamsHighViscosity };
@@ -62,6 +62,7 @@ protected:
     Trafo m_trafo;
     Scanline m_scanlines;
     Rasterizer m_rasterizer;
+    TColor m_background;
     
     void flipy(agg::path_storage &path) const
     {
@@ -114,6 +115,35 @@ protected:
         return path;
     }
     
+    // Pixel rectangle covering a bounding box of the drawn polygons
+    // (inclusive, not clipped to the canvas), the same transformation as
+    // to_path() with a margin for the anti-aliased edges.
+    agg::rect_i to_px_rect(const BoundingBox &bb) const
+    {
+        double x1 = m_trafo.flipXY ? bb.min.y() * m_pxdim_scaled.h_mm : bb.min.x() * m_pxdim_scaled.w_mm;
+        double y1 = m_trafo.flipXY ? bb.min.x() * m_pxdim_scaled.w_mm : bb.min.y() * m_pxdim_scaled.h_mm;
+        double x2 = m_trafo.flipXY ? bb.max.y() * m_pxdim_scaled.h_mm : bb.max.x() * m_pxdim_scaled.w_mm;
+        double y2 = m_trafo.flipXY ? bb.max.x() * m_pxdim_scaled.w_mm : bb.max.y() * m_pxdim_scaled.h_mm;
+
+        x1 += m_trafo.center_x * m_pxdim_scaled.w_mm; x2 += m_trafo.center_x * m_pxdim_scaled.w_mm;
+        y1 += m_trafo.center_y * m_pxdim_scaled.h_mm; y2 += m_trafo.center_y * m_pxdim_scaled.h_mm;
+
+        if (m_trafo.mirror_x) {
+            x1 = double(m_resolution.width_px) - x1;
+            x2 = double(m_resolution.width_px) - x2;
+        }
+
+        if (m_trafo.mirror_y) {
+            y1 = double(m_resolution.height_px) - y1;
+            y2 = double(m_resolution.height_px) - y2;
+        }
+
+        agg::rect_i r(int(std::floor(std::min(x1, x2))) - 1, int(std::floor(std::min(y1, y2))) - 1,
+                      int(std::ceil(std::max(x1, x2))) + 1, int(std::ceil(std::max(y1, y2))) + 1);
+
+        return r;
+    }
+
     template<class P> void _draw(const P &poly)
     {
         m_rasterizer.reset();
@@ -143,6 +173,7 @@ public:
         , m_raw_renderer(m_pixrenderer)
         , m_renderer(m_raw_renderer)
         , m_trafo(trafo)
+        , m_background(background)
     {
         // Visual Studio compiler gives warnings about possible division by zero.
         assert(pd.w_mm != 0 && pd.h_mm != 0);
@@ -165,6 +196,39 @@ public:
     }
     
     void draw(const ExPolygon &poly) override { _draw(poly); }
+
+    bool assign(const RasterBase &other) override
+    {
+        auto rst = dynamic_cast<const AGGRaster *>(&other);
+        if (!rst || rst->m_buf.size() != m_buf.size() ||
+            rst->m_resolution.width_px != m_resolution.width_px)
+            return false;
+
+        std::copy(rst->m_buf.begin(), rst->m_buf.end(), m_buf.begin());
+
+        return true;
+    }
+
+    void redraw(const BoundingBox &region, const ExPolygons &polys) override
+    {
+        agg::rect_i r = to_px_rect(region);
+        if (m_raw_renderer.clip_box(r.x1, r.y1, r.x2, r.y2)) {
+            m_raw_renderer.copy_bar(r.x1, r.y1, r.x2, r.y2, m_background);
+
+            // Clipping the geometry on pixel boundaries keeps the coverage
+            // of the pixels inside the region exact.
+            const agg::rect_i &cb = m_raw_renderer.clip_box();
+            m_rasterizer.clip_box(cb.x1, cb.y1, cb.x2 + 1, cb.y2 + 1);
+
+            for (const ExPolygon &poly : polys)
+                if (to_px_rect(get_extents(poly.contour)).overlaps(cb))
+                    _draw(poly);
+
+            m_rasterizer.reset_clipping();
+        }
+
+        m_raw_renderer.reset_clipping(true);
+    }
     
     EncodedRaster encode(RasterEncoder encoder) const override
     {
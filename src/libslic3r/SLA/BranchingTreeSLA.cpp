@@ -14,6 +14,7 @@
 #include "Pad.hpp"
 
 #include <map>
+#include <memory>
 
 namespace Slic3r { namespace sla {
 
@@ -43,6 +44,24 @@ class BranchingTreeBuilder: public branchingtree::Builder {
 
     std::vector<size_t>  m_unroutable_pinheads;
 
+    // Points on the built branches, collected if not null.
+    std::vector<branchingtree::Node> *m_branch_points = nullptr;
+
+    void add_branch_points(const Vec3d &from, const Vec3d &to, double fromR, double toR)
+    {
+        if (!m_branch_points)
+            return;
+
+        // As dense as the mesh samples, so that a leaf routed later finds one in reach.
+        Vec3d  d = to - from;
+        double step = m_cloud.properties().sampling_radius();
+        int    n = std::max(1, int(std::ceil(d.norm() / step)));
+        for (int i = 1; i <= n; ++i) {
+            double t = double(i) / n;
+            m_branch_points->emplace_back((from + t * d).cast<float>(), float(fromR + t * (toR - fromR)));
+        }
+    }
+
     void build_subtree(size_t root)
     {
         traverse(m_cloud, root, [this](const branchingtree::Node &node) {
@@ -60,6 +79,8 @@ class BranchingTreeBuilder: public branchingtree::Builder {
                 m_builder.add_diffbridge(from1d, tod, leftR, mergeR);
                 m_builder.add_diffbridge(from2d, tod, rightR, mergeR);
                 m_builder.add_junction(tod, mergeR);
+                add_branch_points(from1d, tod, leftR, mergeR);
+                add_branch_points(from2d, tod, rightR, mergeR);
             } else if (int child = node.left + node.right + 1; child >= 0) {
                 auto from = m_cloud.get(child);
                 auto to   = m_cloud.get(node.id);
@@ -70,6 +91,7 @@ class BranchingTreeBuilder: public branchingtree::Builder {
                                          get_radius(from),
                                          toR);
                 m_builder.add_junction(tod, toR);
+                add_branch_points(from.pos.cast<double>(), tod, get_radius(from), toR);
             }
         });
     }
@@ -128,11 +150,16 @@ class BranchingTreeBuilder: public branchingtree::Builder {
         });
     }
 
+    // Ends the branch on a point of a branch built before.
+    bool add_branch_join(const branchingtree::Node &from,
+                         const branchingtree::Node &to);
+
 public:
     BranchingTreeBuilder(SupportTreeBuilder          &builder,
                      const SupportableMesh       &sm,
-                     const branchingtree::PointCloud &cloud)
-        : m_builder{builder}, m_sm{sm}, m_cloud{cloud}
+                     const branchingtree::PointCloud &cloud,
+                     std::vector<branchingtree::Node> *branch_points = nullptr)
+        : m_builder{builder}, m_sm{sm}, m_cloud{cloud}, m_branch_points{branch_points}
     {}
 
     bool add_bridge(const branchingtree::Node &from,
@@ -261,9 +288,29 @@ bool BranchingTreeBuilder::add_ground_bridge(const branchingtree::Node &from,
     return ret;
 }
 
+bool BranchingTreeBuilder::add_branch_join(const branchingtree::Node &from,
+                                           const branchingtree::Node &to)
+{
+    if (!add_bridge(from, to))
+        return false;
+
+    Vec3d  fromd = from.pos.cast<double>(), tod = to.pos.cast<double>();
+    double fromR = get_radius(from);
+    m_builder.add_diffbridge(fromd, tod, fromR, fromR);
+    m_builder.add_junction(tod, fromR);
+    add_branch_points(fromd, tod, fromR, fromR);
+
+    build_subtree(from.id);
+
+    return true;
+}
+
 bool BranchingTreeBuilder::add_mesh_bridge(const branchingtree::Node &from,
                                            const branchingtree::Node &to)
 {
+    if (m_cloud.is_branch_point(to.id))
+        return add_branch_join(from, to);
+
     if (from.weight > m_sm.cfg.max_weight_on_model_support)
         return false;
 
@@ -357,6 +404,85 @@ inline void build_pillars(SupportTreeBuilder &builder,
     }
 }
 
+// Route the leafs of the point cloud into builder, returns the indices of
+// the leafs in the cloud which could not be routed. The points on the built
+// branches are appended to branch_points, if given.
+static std::vector<size_t> route_leafs(SupportTreeBuilder               &builder,
+                                       const SupportableMesh            &sm,
+                                       branchingtree::PointCloud        &nodes,
+                                       std::vector<branchingtree::Node> *branch_points = nullptr)
+{
+    BranchingTreeBuilder vbuilder{builder, sm, nodes, branch_points};
+
+    execution::for_each(ex_tbb,
+                        size_t(0),
+                        nodes.get_leafs().size(),
+                        [&nodes, &vbuilder](size_t leaf_idx) {
+                            vbuilder.suggest_avoidance(nodes.get_leafs()[leaf_idx],
+                                                       nodes.properties().max_branch_length());
+                        });
+
+    branchingtree::build_tree(nodes, vbuilder);
+
+    build_pillars(builder, vbuilder, sm);
+
+    return vbuilder.unroutable_pinheads();
+}
+
+// Route the partitions of the leafs concurrently, each in its own point cloud.
+// The partitions are expected not to interact, see partition_leafs(). The
+// leafs may end on the branches given by branchpts, built before. The points
+// on the branches built now are returned in built_branchpts, if given.
+static void route_partitions(SupportTreeBuilder                     &builder,
+                             const SupportableMesh                  &sm,
+                             const std::vector<branchingtree::Node> &meshpts,
+                             const std::vector<branchingtree::Node> &bedpts,
+                             const std::vector<branchingtree::Node> &leafs,
+                             const std::vector<std::vector<size_t>> &partitions,
+                             const branchingtree::Properties        &props,
+                             const std::vector<branchingtree::Node> &branchpts       = {},
+                             std::vector<branchingtree::Node>       *built_branchpts = nullptr)
+{
+    const bool deterministic = sm.cfg.branching_tree_deterministic;
+
+    // With the deterministic option, each partition is built into a builder
+    // of its own and these are merged in the order of the partitions.
+    std::vector<std::unique_ptr<SupportTreeBuilder>> part_builders(deterministic ? partitions.size() : 0);
+    std::vector<std::vector<size_t>> unroutable(partitions.size());
+    std::vector<std::vector<branchingtree::Node>> part_branchpts(built_branchpts ? partitions.size() : 0);
+
+    execution::for_each(
+        ex_tbb, size_t(0), partitions.size(),
+        [&](size_t part_idx) {
+            if (builder.ctl().stopcondition())
+                return;
+
+            const std::vector<size_t> &partition = partitions[part_idx];
+            branchingtree::PointCloud nodes = branchingtree::make_partition_cloud(meshpts, bedpts, leafs, partition, props, branchpts);
+
+            SupportTreeBuilder *target = &builder;
+            if (deterministic) {
+                part_builders[part_idx] = std::make_unique<SupportTreeBuilder>(builder.ctl());
+                target = part_builders[part_idx].get();
+            }
+
+            unroutable[part_idx] = route_leafs(*target, sm, nodes, built_branchpts ? &part_branchpts[part_idx] : nullptr);
+            for (size_t &id : unroutable[part_idx])
+                id = partition[id];
+        });
+
+    for (size_t part_idx = 0; part_idx < partitions.size(); ++part_idx) {
+        if (deterministic && part_builders[part_idx])
+            builder.merge(std::move(*part_builders[part_idx]));
+
+        for (size_t id : unroutable[part_idx])
+            builder.head(id).invalidate();
+
+        if (built_branchpts)
+            built_branchpts->insert(built_branchpts->end(), part_branchpts[part_idx].begin(), part_branchpts[part_idx].end());
+    }
+}
+
 void create_branching_tree(SupportTreeBuilder &builder, const SupportableMesh &sm)
 {
     auto coordfn = [&sm](size_t id, size_t dim) { return sm.pts[id].pos(dim); };
@@ -406,24 +532,26 @@ void create_branching_tree(SupportTreeBuilder &builder, const SupportableMesh &s
     for (auto &bp : bedpts)
         bp.Rmin = sm.cfg.head_back_radius_mm;
 
-    branchingtree::PointCloud nodes{std::move(meshpts), std::move(bedpts),
-                                    std::move(leafs), props};
+    if (sm.cfg.branching_tree_parallel) {
+        auto partitions = branchingtree::partition_leafs(leafs, props, sm.cfg.branching_tree_partition_size);
 
-    BranchingTreeBuilder vbuilder{builder, sm, nodes};
+        BOOST_LOG_TRIVIAL(debug) << "Branching tree of " << leafs.size() << " support points in "
+                                 << partitions.parts.size() << " partitions, "
+                                 << partitions.seams.size() << " seams";
 
-    execution::for_each(ex_tbb,
-                        size_t(0),
-                        nodes.get_leafs().size(),
-                        [&nodes, &vbuilder](size_t leaf_idx) {
-                            vbuilder.suggest_avoidance(nodes.get_leafs()[leaf_idx],
-                                                       nodes.properties().max_branch_length());
-                        });
+        // The seams are routed after the partitions they separate, their
+        // leafs may end on the branches of these partitions.
+        std::vector<branchingtree::Node> branchpts;
+        route_partitions(builder, sm, meshpts, bedpts, leafs, partitions.parts, props, {}, &branchpts);
+        route_partitions(builder, sm, meshpts, bedpts, leafs, partitions.seams, props, branchpts);
 
-    branchingtree::build_tree(nodes, vbuilder);
+        return;
+    }
 
-    build_pillars(builder, vbuilder, sm);
+    branchingtree::PointCloud nodes{std::move(meshpts), std::move(bedpts),
+                                    std::move(leafs), props};
 
-    for (size_t id : vbuilder.unroutable_pinheads())
+    for (size_t id : route_leafs(builder, sm, nodes))
         builder.head(id).invalidate();
 
 }
@@ -7,6 +7,7 @@
 #include <numeric>
 #include <unordered_set>
 #include <random>
+#include <mutex>
 
 #include <libslic3r/OpenVDBUtils.hpp>
 #include <libslic3r/TriangleMesh.hpp>
@@ -14,10 +15,12 @@
 #include <libslic3r/SLA/Hollowing.hpp>
 #include <libslic3r/AABBTreeIndirect.hpp>
 #include <libslic3r/AABBMesh.hpp>
+#include <libslic3r/KDTreeIndirect.hpp>
 #include <libslic3r/ClipperUtils.hpp>
 #include <libslic3r/QuadricEdgeCollapse.hpp>
 #include <libslic3r/SLA/SupportTreeMesher.hpp>
 #include <libslic3r/Execution/ExecutionSeq.hpp>
+#include <libslic3r/Execution/ExecutionTBB.hpp>
 #include <libslic3r/Model.hpp>
 
 #include <libslic3r/MeshBoolean.hpp>
@@ -71,9 +74,16 @@ VoxelGrid &get_grid(Interior &interior)
     return *interior.gridptr;
 }
 
-InteriorPtr generate_interior(const VoxelGrid       &vgrid,
-                              const HollowingConfig &hc,
-                              const JobController   &ctl)
+// The grid of the interior before extracting its surface
+struct InteriorGrid {
+    VoxelGridPtr gridptr;
+    double iso_surface  = 0.;
+    double full_narrowb = 2.;
+};
+
+static InteriorGrid hollow_grid(const VoxelGrid       &vgrid,
+                                const HollowingConfig &hc,
+                                const JobController   &ctl)
 {
     double voxsc    = get_voxel_scale(vgrid);
     double offset   = hc.min_thickness;              // world units
@@ -82,9 +92,6 @@ InteriorPtr generate_interior(const VoxelGrid       &vgrid,
     float  out_range = 1.f / voxsc; // world units
     auto   narrowb  = 1.f;  // voxel units (voxel count)
 
-    if (ctl.stopcondition()) return {};
-    else ctl.statuscb(0, _u8L("Hollowing"));
-
     auto gridptr = dilate_grid(vgrid, out_range, in_range);
 
     if (ctl.stopcondition()) return {};
@@ -102,21 +109,225 @@ InteriorPtr generate_interior(const VoxelGrid       &vgrid,
         iso_surface = -offset;
     }
 
+    return {std::move(gridptr), iso_surface, (out_range + in_range) / 2.};
+}
+
+InteriorPtr generate_interior(const VoxelGrid       &vgrid,
+                              const HollowingConfig &hc,
+                              const JobController   &ctl)
+{
     if (ctl.stopcondition()) return {};
+    else ctl.statuscb(0, _u8L("Hollowing"));
+
+    InteriorGrid igrid = hollow_grid(vgrid, hc, ctl);
+
+    if (!igrid.gridptr || ctl.stopcondition()) return {};
     else ctl.statuscb(70, _u8L("Hollowing"));
 
     double adaptivity = 0.;
     InteriorPtr interior = InteriorPtr{new Interior{}};
 
-    interior->mesh = grid_to_mesh(*gridptr, iso_surface, adaptivity);
-    interior->gridptr = std::move(gridptr);
+    interior->mesh = grid_to_mesh(*igrid.gridptr, igrid.iso_surface, adaptivity);
+    interior->gridptr = std::move(igrid.gridptr);
 
     if (ctl.stopcondition()) return {};
     else ctl.statuscb(100, _u8L("Hollowing"));
 
-    interior->iso_surface = iso_surface;
-    interior->thickness   = offset;
-    interior->full_narrowb = (out_range + in_range) / 2.;
+    interior->iso_surface = igrid.iso_surface;
+    interior->thickness   = hc.min_thickness;
+    interior->full_narrowb = igrid.full_narrowb;
+
+    return interior;
+}
+
+// Part of the mesh between the planes zmin and zmax, the cuts are closed if
+// caps is set.
+static indexed_triangle_set cut_mesh_to_slab(const indexed_triangle_set &its, float zmin, float zmax, bool caps = true)
+{
+    indexed_triangle_set upper, slab;
+    cut_mesh(its, zmin, &upper, nullptr, caps);
+    cut_mesh(upper, zmax, nullptr, &slab, caps);
+    its_compactify_vertices(slab);
+
+    return slab;
+}
+
+// Move the vertices of the open cut of upper at the plane z onto the closest
+// vertices of the open cut of lower, so that the cuts are merged by
+// its_merge_vertices(). The slabs see the same geometry around the cut, thus
+// the cuts only differ by rounding errors.
+static void snap_to_seam(const indexed_triangle_set &lower, indexed_triangle_set &upper, float z, double tolerance)
+{
+    std::vector<size_t> seam;
+    for (size_t i = 0; i < lower.vertices.size(); ++ i)
+        if (lower.vertices[i].z() == z)
+            seam.emplace_back(i);
+
+    if (seam.empty())
+        return;
+
+    auto coordinate_fn = [&lower](size_t idx, size_t dimension) { return lower.vertices[idx][dimension]; };
+    KDTreeIndirect<2, float, decltype(coordinate_fn)> kdtree(coordinate_fn, seam);
+
+    for (Vec3f &v : upper.vertices)
+        if (v.z() == z) {
+            size_t idx = find_closest_point(kdtree, Vec2f{v.x(), v.y()});
+            if (idx != kdtree.npos && (lower.vertices[idx] - v).squaredNorm() <= tolerance * tolerance)
+                v = lower.vertices[idx];
+        }
+}
+
+InteriorPtr generate_interior_tiled(const std::vector<csg::CSGPart> &parts,
+                                    const HollowingConfig           &hc,
+                                    const JobController             &ctl,
+                                    TiledHollowingStats             *stats)
+{
+    BoundingBoxf3 bb;
+    for (const csg::CSGPart &part : parts)
+        if (const indexed_triangle_set *its = csg::get_mesh(part); its && ! its->empty())
+            bb.merge(bounding_box(*its, csg::get_transform(part)));
+
+    if (! bb.defined)
+        return {};
+
+    double voxsc  = get_voxel_scale(csgmesh_positive_maxvolume(parts), hc);
+    // The interior inside a slab is not affected by the cuts of the slab
+    // further than the margin.
+    double margin = 1.5 * (hc.min_thickness + hc.closing_distance) + 8. / voxsc;
+
+    // Small models are hollowed in one piece.
+    auto whole = [&parts, &hc, &ctl, stats, voxsc]() -> InteriorPtr {
+        VoxelGridPtr grid = voxelize_for_hollowing(range(parts), voxsc, ctl);
+        if (! grid)
+            return {};
+
+        InteriorPtr interior = generate_interior(*grid, hc, ctl);
+        if (stats) {
+            stats->tiles              = 1;
+            stats->peak_active_voxels = active_voxel_count(*grid) + (interior ? active_voxel_count(*interior->gridptr) : 0);
+        }
+
+        return interior;
+    };
+
+    auto   voxels = [voxsc](double len) { return std::ceil(len * voxsc); };
+    double xy_vox = voxels(bb.size().x() + 2. * margin) * voxels(bb.size().y() + 2. * margin);
+    double h      = std::floor(double(hc.max_tile_voxels) / xy_vox) / voxsc - 2. * margin;
+
+    // Slabs much thinner than the margin would mostly compute the margins.
+    h = std::max(h, 2. * margin);
+
+    auto slabs = size_t(std::ceil(bb.size().z() / h));
+    if (slabs < 2)
+        return whole();
+
+    BOOST_LOG_TRIVIAL(debug) << "Hollowing: processing " << slabs << " slabs of " << h << " mm";
+
+    if (ctl.stopcondition()) return {};
+    else ctl.statuscb(0, _u8L("Hollowing"));
+
+    JobController slabctl;
+    slabctl.stopcondition = ctl.stopcondition;
+
+    std::vector<indexed_triangle_set> pieces(slabs);
+    std::mutex                        mtx;
+    size_t                            slabs_done  = 0;
+    size_t                            live_voxels = 0;
+    TiledHollowingStats               st;
+    st.tiles = slabs;
+
+    auto account = [&mtx, &live_voxels, &st](const VoxelGridPtr &grid, bool alloc) {
+        if (! grid)
+            return;
+        std::lock_guard lk{mtx};
+        if (alloc) {
+            live_voxels += active_voxel_count(*grid);
+            st.peak_active_voxels = std::max(st.peak_active_voxels, live_voxels);
+        } else
+            live_voxels -= active_voxel_count(*grid);
+    };
+
+    double iso_surface  = 0.;
+    double full_narrowb = 2.;
+
+    // The slabs are processed in batches, so that only a bounded number of
+    // the slab grids are alive at once.
+    size_t batch = std::max(hc.max_parallel_tiles, size_t(1));
+    for (size_t batch_begin = 0; batch_begin < slabs && ! ctl.stopcondition(); batch_begin += batch) {
+        execution::for_each(ex_tbb, batch_begin, std::min(batch_begin + batch, slabs), [&](size_t i) {
+            if (ctl.stopcondition())
+                return;
+
+            // The first and the last slab are not cut at the model boundaries.
+            float zmin = i == 0 ? -std::numeric_limits<float>::max() : float(bb.min.z() + double(i) * h);
+            float zmax = i + 1 == slabs ? std::numeric_limits<float>::max() : float(bb.min.z() + double(i + 1) * h);
+
+            std::vector<csg::CSGPart> slabparts;
+            slabparts.reserve(parts.size());
+            for (const csg::CSGPart &part : parts) {
+                auto its = std::make_unique<indexed_triangle_set>();
+                if (const indexed_triangle_set *pmesh = csg::get_mesh(part)) {
+                    Transform3f trafo = csg::get_transform(part);
+                    if (trafo.matrix().isIdentity()) {
+                        *its = cut_mesh_to_slab(*pmesh, zmin - float(margin), zmax + float(margin));
+                    } else {
+                        *its = *pmesh;
+                        its_transform(*its, trafo, true);
+                        *its = cut_mesh_to_slab(*its, zmin - float(margin), zmax + float(margin));
+                    }
+                }
+                slabparts.emplace_back(std::move(its), csg::get_operation(part));
+                slabparts.back().stack_operation = csg::get_stack_operation(part);
+            }
+
+            VoxelGridPtr grid = voxelize_for_hollowing(range(slabparts), voxsc, slabctl);
+            slabparts.clear();
+            if (! grid || is_grid_empty(*grid))
+                return;
+            account(grid, true);
+
+            InteriorGrid igrid = hollow_grid(*grid, hc, slabctl);
+            account(igrid.gridptr, true);
+            account(grid, false);
+            grid.reset();
+            if (! igrid.gridptr)
+                return;
+
+            indexed_triangle_set its = grid_to_mesh(*igrid.gridptr, igrid.iso_surface, 0.);
+            account(igrid.gridptr, false);
+            igrid.gridptr.reset();
+
+            // The cuts are left open to be stitched to the neighbor slabs.
+            pieces[i] = cut_mesh_to_slab(its, zmin, zmax, false);
+
+            std::lock_guard lk{mtx};
+            // The same for all the slabs.
+            iso_surface  = igrid.iso_surface;
+            full_narrowb = igrid.full_narrowb;
+            ctl.statuscb(unsigned(100 * ++ slabs_done / slabs), _u8L("Hollowing"));
+        }, 1);
+    }
+
+    if (stats)
+        *stats = st;
+
+    if (ctl.stopcondition())
+        return {};
+
+    InteriorPtr interior = InteriorPtr{new Interior{}};
+    for (size_t i = 0; i < slabs; ++ i) {
+        if (i > 0)
+            snap_to_seam(interior->mesh, pieces[i], float(bb.min.z() + double(i) * h), 0.1 / voxsc);
+        its_merge(interior->mesh, std::move(pieces[i]));
+    }
+    // Stitch the slabs into one surface without internal walls.
+    its_merge_vertices(interior->mesh);
+
+    // No grid of the whole interior is kept, thus the triangles of the model
+    // inside the interior cannot be removed with this interior.
+    interior->iso_surface  = iso_surface;
+    interior->thickness    = hc.min_thickness;
+    interior->full_narrowb = full_narrowb;
 
     return interior;
 }
@@ -399,6 +610,10 @@ void divide_triangle(const DivFace &face, Fn &&visitor)
 void remove_inside_triangles(indexed_triangle_set &mesh, const Interior &interior,
                              const std::vector<bool> &exclude_mask)
 {
+    // The distances to the interior are measured on its grid.
+    if (!interior.gridptr)
+        return;
+
     enum TrPos { posInside, posTouch, posOutside };
 
     auto &faces       = mesh.indices;
@@ -680,8 +895,9 @@ std::vector<bool> create_exclude_mask(const indexed_triangle_set   &its,
                               ).cast<double>() / 3.;
 
         // If the center is more than half a mm inside the interior,
-        // it cannot possibly be part of a hole wall.
-        if (sla::get_distance(tr_center, interior) < -0.5)
+        // it cannot possibly be part of a hole wall. Without the grid of the
+        // interior, the distance is not known.
+        if (interior.gridptr && sla::get_distance(tr_center, interior) < -0.5)
             continue;
 
         Vec3f U = its.vertices[face(1)] - its.vertices[face(0)];
@@ -886,10 +1102,14 @@ int hollow_mesh_and_drill(indexed_triangle_set &hollowed_mesh,
         hollowed_mesh =
             MeshBoolean::cgal::cgal_to_indexed_triangle_set(*hollowed_mesh_cgal);
 
-        std::vector<bool> exclude_mask =
-            create_exclude_mask(hollowed_mesh, interior, drainholes);
+        // A tiled interior has no grid to measure the distances with, the
+        // inside triangles are kept, the same as by hollow_mesh().
+        if (interior.gridptr) {
+            std::vector<bool> exclude_mask =
+                create_exclude_mask(hollowed_mesh, interior, drainholes);
 
-        sla::remove_inside_triangles(hollowed_mesh, interior, exclude_mask);
+            sla::remove_inside_triangles(hollowed_mesh, interior, exclude_mask);
+        }
     } catch (const Slic3r::RuntimeError &) {
         ret |= static_cast<int>(HollowMeshResult::DrillingFailed);
     }
@@ -23,6 +23,24 @@ struct HollowingConfig
     double quality          = 0.5;
     double closing_distance = 0.5;
     bool enabled = true;
+
+    // If nonzero, models with more voxels in their bounding box are hollowed
+    // in overlapping Z slabs of at most this many voxels. Each slab is
+    // voxelized from the clipped model, hollowed and meshed on its own, only
+    // its part of the interior mesh is kept.
+    size_t max_tile_voxels = 0;
+
+    // Number of the slabs processed at once. The intermediate grids take
+    // about max_parallel_tiles * max_tile_voxels voxels at most.
+    size_t max_parallel_tiles = 2;
+};
+
+// Counters of the tiled hollowing, see generate_interior_tiled().
+struct TiledHollowingStats
+{
+    size_t tiles = 0;
+    // Maximum number of the active voxels of the grids alive at once.
+    size_t peak_active_voxels = 0;
 };
 
 enum HollowingFlags { hfRemoveInsideTriangles = 0x1 };
@@ -87,10 +105,21 @@ InteriorPtr generate_interior(const VoxelGrid &mesh,
                               const HollowingConfig &  = {},
                               const JobController &ctl = {});
 
+InteriorPtr generate_interior_tiled(const std::vector<csg::CSGPart> &parts,
+                                    const HollowingConfig           &hc,
+                                    const JobController             &ctl   = {},
+                                    TiledHollowingStats             *stats = nullptr);
+
 inline InteriorPtr generate_interior(const indexed_triangle_set &mesh,
                                      const HollowingConfig &hc = {},
                                      const JobController &ctl = {})
 {
+    if (hc.max_tile_voxels > 0) {
+        std::vector<csg::CSGPart> parts;
+        parts.emplace_back(&mesh);
+        return generate_interior_tiled(parts, hc, ctl);
+    }
+
     auto voxel_scale = get_voxel_scale(its_volume(mesh), hc);
     auto statusfn = [&ctl](int){ return ctl.stopcondition && ctl.stopcondition(); };
     auto grid = mesh_to_grid(mesh, MeshToGridParams{}
@@ -130,16 +159,16 @@ template<class Cont> double csgmesh_positive_maxvolume(const Cont &csg)
     return mesh_vol;
 }
 
+// Distance field of the model from which the interior is generated. It only
+// depends on the model and the voxel scale, so it can be reused to generate
+// the interior with different hollowing parameters.
 template<class It>
-InteriorPtr generate_interior(const Range<It>       &csgparts,
-                              const HollowingConfig &hc  = {},
-                              const JobController   &ctl = {})
+VoxelGridPtr voxelize_for_hollowing(const Range<It>     &csgparts,
+                                    double               voxel_scale,
+                                    const JobController &ctl = {})
 {
-    double mesh_vol = csgmesh_positive_maxvolume(csgparts);
-    double voxsc    = get_voxel_scale(mesh_vol, hc);
-
     auto params = csg::VoxelizeParams{}
-                      .voxel_scale(voxsc)
+                      .voxel_scale(voxel_scale)
                       .exterior_bandwidth(3.f)
                       .interior_bandwidth(3.f)
                       .statusfn([&ctl](int){ return ctl.stopcondition && ctl.stopcondition(); });
@@ -152,7 +181,45 @@ InteriorPtr generate_interior(const Range<It>       &csgparts,
     // TODO: figure out issues without the redistance
 //    if (csgparts.size() > 1 || its_is_splittable(*csg::get_mesh(*csgparts.begin())))
 
-    ptr = redistance_grid(*ptr, 0.0f, 3.f, 3.f);
+    return redistance_grid(*ptr, 0.0f, 3.f, 3.f);
+}
+
+// Hollowing of the model in Z slabs, each slab is voxelized from the parts
+// cut to the slab with a margin. The parts are copied with their
+// transformations applied.
+template<class It>
+InteriorPtr generate_interior_tiled(const Range<It>       &csgparts,
+                                    const HollowingConfig &hc,
+                                    const JobController   &ctl   = {},
+                                    TiledHollowingStats   *stats = nullptr)
+{
+    std::vector<csg::CSGPart> parts;
+    parts.reserve(csgparts.size());
+    for (const auto &csgpart : csgparts) {
+        auto its = std::make_unique<indexed_triangle_set>();
+        if (const indexed_triangle_set *pmesh = csg::get_mesh(csgpart)) {
+            *its = *pmesh;
+            its_transform(*its, csg::get_transform(csgpart), true);
+        }
+        parts.emplace_back(std::move(its), csg::get_operation(csgpart));
+        parts.back().stack_operation = csg::get_stack_operation(csgpart);
+    }
+
+    return generate_interior_tiled(parts, hc, ctl, stats);
+}
+
+template<class It>
+InteriorPtr generate_interior(const Range<It>       &csgparts,
+                              const HollowingConfig &hc  = {},
+                              const JobController   &ctl = {})
+{
+    if (hc.max_tile_voxels > 0)
+        return generate_interior_tiled(csgparts, hc, ctl);
+
+    double mesh_vol = csgmesh_positive_maxvolume(csgparts);
+    double voxsc    = get_voxel_scale(mesh_vol, hc);
+
+    auto ptr = voxelize_for_hollowing(csgparts, voxsc, ctl);
 
     return ptr ? generate_interior(*ptr, hc, ctl) : InteriorPtr{};
 }
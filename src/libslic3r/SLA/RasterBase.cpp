@@ -7,34 +7,490 @@
 #define SLARASTER_CPP
 
 #include <functional>
+#include <queue>
+#include <cstring>
 
 #include <libslic3r/SLA/RasterBase.hpp>
 #include <libslic3r/SLA/AGGRaster.hpp>
+#include <libslic3r/SLA/ScanlineRaster.hpp>
+#include <libslic3r/Execution/ExecutionTBB.hpp>
+#include <libslic3r/ClipperUtils.hpp>
 
 // minz image write:
 #include <miniz.h>
 
 namespace Slic3r { namespace sla {
 
+namespace {
+
+// Rows are encoded in blocks of at least this many rows, each block is
+// filtered and compressed independently on a separate thread.
+constexpr size_t PNG_MIN_BLOCK_ROWS = 128;
+
+enum PNGFilter : uint8_t { pngfNone = 0, pngfUp = 2 };
+
+// Number of bytes equal to val starting at ptr
+size_t run_length(const uint8_t *ptr, const uint8_t *end, uint8_t val)
+{
+    const uint8_t *p       = ptr;
+    const uint64_t pattern = uint64_t(val) * 0x0101010101010101ull;
+    for (uint64_t word; p + 8 <= end; p += 8) {
+        std::memcpy(&word, p, 8);
+        if (word != pattern) break;
+    }
+
+    while (p < end && *p == val) ++p;
+
+    return size_t(p - ptr);
+}
+
+// Writer of LSB first bit stream as required by deflate
+class BitWriter {
+    std::vector<uint8_t> &m_out;
+    uint64_t m_acc   = 0;
+    int      m_nbits = 0;
+
+public:
+    explicit BitWriter(std::vector<uint8_t> &out) : m_out(out) {}
+
+    void put(uint32_t bits, int n)
+    {
+        m_acc |= uint64_t(bits) << m_nbits;
+        m_nbits += n;
+        while (m_nbits >= 8) {
+            m_out.emplace_back(uint8_t(m_acc));
+            m_acc >>= 8;
+            m_nbits -= 8;
+        }
+    }
+
+    // Huffman codes are stored MSB first
+    void put_code(uint32_t code, int len)
+    {
+        uint32_t rev = 0;
+        for (int i = 0; i < len; ++i, code >>= 1)
+            rev = (rev << 1) | (code & 1);
+
+        put(rev, len);
+    }
+
+    void align()
+    {
+        if (m_nbits > 0)
+            put(0, 8 - m_nbits);
+    }
+};
+
+// Code lengths of a Huffman code for the given symbol frequencies, limited
+// to max_len bits. Every used symbol gets a code and the code is complete.
+std::vector<uint8_t> huffman_code_lengths(std::vector<size_t> freq, int max_len)
+{
+    size_t used = std::count_if(freq.begin(), freq.end(), [](size_t f) { return f > 0; });
+    for (size_t i = 0; used < 2 && i < freq.size(); ++i)
+        if (freq[i] == 0) {
+            freq[i] = 1;
+            ++used;
+        }
+
+    struct Node { size_t freq; int left, right; };
+    std::vector<Node> nodes;
+    std::vector<int>  leaf_of(freq.size(), -1);
+    using QItem = std::pair<size_t, int>;
+    std::priority_queue<QItem, std::vector<QItem>, std::greater<QItem>> queue;
+
+    for (size_t sym = 0; sym < freq.size(); ++sym)
+        if (freq[sym] > 0) {
+            leaf_of[sym] = int(nodes.size());
+            queue.emplace(freq[sym], int(nodes.size()));
+            nodes.push_back({freq[sym], -1, -1});
+        }
+
+    while (queue.size() > 1) {
+        auto [fa, a] = queue.top(); queue.pop();
+        auto [fb, b] = queue.top(); queue.pop();
+        queue.emplace(fa + fb, int(nodes.size()));
+        nodes.push_back({fa + fb, a, b});
+    }
+
+    // Depth of every node, parents are always after their children.
+    std::vector<int> depth(nodes.size(), 0);
+    for (int n = int(nodes.size()) - 1; n >= 0; --n)
+        if (nodes[n].left >= 0)
+            depth[nodes[n].left] = depth[nodes[n].right] = depth[n] + 1;
+
+    // Limit the code lengths the same way as miniz (and zlib) does: clamp
+    // the overflowing lengths and restore the Kraft equality by splitting
+    // the deepest leaves that are still shallower than the limit.
+    std::vector<int> num_codes(max_len + 1, 0);
+    for (size_t sym = 0; sym < freq.size(); ++sym)
+        if (leaf_of[sym] >= 0)
+            ++num_codes[std::min(depth[leaf_of[sym]], max_len)];
+
+    uint32_t total = 0;
+    for (int l = 1; l <= max_len; ++l)
+        total += uint32_t(num_codes[l]) << (max_len - l);
+
+    while (total != (1u << max_len)) {
+        --num_codes[max_len];
+        for (int l = max_len - 1; l > 0; --l)
+            if (num_codes[l]) {
+                --num_codes[l];
+                num_codes[l + 1] += 2;
+                break;
+            }
+        --total;
+    }
+
+    // Assign the lengths to the symbols, the most frequent get the shortest
+    std::vector<int> syms;
+    for (size_t sym = 0; sym < freq.size(); ++sym)
+        if (freq[sym] > 0) syms.emplace_back(int(sym));
+
+    std::stable_sort(syms.begin(), syms.end(), [&freq](int a, int b) { return freq[a] > freq[b]; });
+
+    std::vector<uint8_t> lengths(freq.size(), 0);
+    auto it = syms.begin();
+    for (int l = 1; l <= max_len; ++l)
+        for (int k = 0; k < num_codes[l]; ++k)
+            lengths[*it++] = uint8_t(l);
+
+    return lengths;
+}
+
+// Canonical Huffman codes for the given code lengths (RFC 1951, 3.2.2)
+std::vector<uint32_t> canonical_codes(const std::vector<uint8_t> &lengths)
+{
+    std::array<uint32_t, 17> bl_count{}, next_code{};
+    for (uint8_t l : lengths) ++bl_count[l];
+    bl_count[0] = 0;
+
+    for (int bits = 1, code = 0; bits <= 16; ++bits) {
+        code = (code + bl_count[bits - 1]) << 1;
+        next_code[bits] = code;
+    }
+
+    std::vector<uint32_t> codes(lengths.size(), 0);
+    for (size_t sym = 0; sym < lengths.size(); ++sym)
+        if (lengths[sym])
+            codes[sym] = next_code[lengths[sym]]++;
+
+    return codes;
+}
+
+struct LengthCode { uint16_t code; uint8_t extra_bits; uint16_t base; };
+
+const std::array<LengthCode, 259> &length_codes()
+{
+    static const std::array<LengthCode, 259> table = [] {
+        static const uint16_t base[] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                        31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static const uint8_t extra[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                        2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        std::array<LengthCode, 259> t{};
+        for (int c = 0; c < 29; ++c) {
+            int end = c + 1 < 29 ? base[c + 1] : 259;
+            for (int len = base[c]; len < end; ++len)
+                t[len] = {uint16_t(257 + c), extra[c], base[c]};
+        }
+        return t;
+    }();
+
+    return table;
+}
+
+// Deflate compressor using only run length matches (distance 1) and a
+// single dynamic Huffman block. This is much faster than a general LZ77
+// match search and compresses the constant runs of layer images just as
+// well. The input is fed in pieces, constant pieces need not be
+// materialized at all.
+class RLEDeflater {
+    static constexpr uint16_t EndOfBlock = 256;
+    static constexpr size_t   MinMatch = 3, MaxMatch = 258;
+
+    // Literals are stored as is, matches as 256 + length
+    std::vector<uint16_t> m_tokens;
+    std::vector<size_t>   m_lit_freq = std::vector<size_t>(286, 0);
+    int                   m_prev     = -1;
+    size_t                m_run      = 0; // pending repetitions of m_prev
+
+    void literal(uint8_t v)
+    {
+        m_tokens.emplace_back(v);
+        ++m_lit_freq[v];
+    }
+
+    void flush_run()
+    {
+        const auto &lcodes = length_codes();
+        while (m_run >= MinMatch) {
+            size_t l = std::min(m_run, MaxMatch);
+
+            // Don't leave a tail shorter than a match if it can be avoided
+            if (m_run - l > 0 && m_run - l < MinMatch)
+                l -= MinMatch;
+
+            m_tokens.emplace_back(uint16_t(256 + l));
+            ++m_lit_freq[lcodes[l].code];
+            m_run -= l;
+        }
+
+        for (; m_run > 0; --m_run)
+            literal(uint8_t(m_prev));
+    }
+
+public:
+    void feed(const uint8_t *ptr, size_t len)
+    {
+        const uint8_t *end = ptr + len;
+        while (ptr < end) {
+            if (*ptr == m_prev) {
+                size_t r = run_length(ptr, end, uint8_t(m_prev));
+                m_run += r;
+                ptr += r;
+            } else {
+                flush_run();
+                literal(*ptr);
+                m_prev = *ptr++;
+            }
+        }
+    }
+
+    void feed_repeated(uint8_t v, size_t count)
+    {
+        if (count == 0)
+            return;
+
+        if (v != m_prev) {
+            flush_run();
+            literal(v);
+            m_prev = v;
+            --count;
+        }
+
+        m_run += count;
+    }
+
+    // Write the collected data as one deflate block. Unless it is the last
+    // block, the output is padded to a byte boundary with an empty stored
+    // block, like zlib's Z_SYNC_FLUSH does, so the outputs of independent
+    // compressors can be simply concatenated.
+    void write(std::vector<uint8_t> &out, bool last);
+};
+
+void RLEDeflater::write(std::vector<uint8_t> &out, bool last)
+{
+    flush_run();
+    m_tokens.emplace_back(EndOfBlock);
+    ++m_lit_freq[EndOfBlock];
+
+    std::vector<uint8_t>  lit_len  = huffman_code_lengths(m_lit_freq, 15);
+    std::vector<uint32_t> lit_code = canonical_codes(lit_len);
+
+    size_t hlit = lit_len.size();
+    while (hlit > 257 && lit_len[hlit - 1] == 0) --hlit;
+
+    // Only distance 1 is used, a single distance code of one bit is allowed
+    std::vector<uint8_t> all_len(lit_len.begin(), lit_len.begin() + hlit);
+    all_len.emplace_back(1);
+
+    // Run length encode the code lengths with the symbols 16, 17 and 18
+    struct CLSym { uint8_t sym, extra_bits, extra; };
+    std::vector<CLSym>  cl_syms;
+    std::vector<size_t> cl_freq(19, 0);
+    for (size_t i = 0; i < all_len.size();) {
+        uint8_t l   = all_len[i];
+        size_t  rep = 1;
+        while (i + rep < all_len.size() && all_len[i + rep] == l) ++rep;
+        i += rep;
+
+        if (l == 0) {
+            for (; rep >= 11; rep -= std::min(rep, size_t(138)))
+                cl_syms.push_back({18, 7, uint8_t(std::min(rep, size_t(138)) - 11)});
+            if (rep >= 3) {
+                cl_syms.push_back({17, 3, uint8_t(rep - 3)});
+                rep = 0;
+            }
+        } else {
+            cl_syms.push_back({l, 0, 0});
+            --rep;
+            for (; rep >= 3; rep -= std::min(rep, size_t(6)))
+                cl_syms.push_back({16, 2, uint8_t(std::min(rep, size_t(6)) - 3)});
+        }
+
+        for (; rep > 0; --rep)
+            cl_syms.push_back({l, 0, 0});
+    }
+
+    for (const CLSym &s : cl_syms) ++cl_freq[s.sym];
+
+    std::vector<uint8_t>  cl_len  = huffman_code_lengths(cl_freq, 7);
+    std::vector<uint32_t> cl_code = canonical_codes(cl_len);
+
+    static const uint8_t cl_order[] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+    size_t hclen = 19;
+    while (hclen > 4 && cl_len[cl_order[hclen - 1]] == 0) --hclen;
+
+    BitWriter bw(out);
+    bw.put(last ? 1 : 0, 1);
+    bw.put(2, 2); // dynamic Huffman codes
+    bw.put(uint32_t(hlit - 257), 5);
+    bw.put(0, 5); // one distance code
+    bw.put(uint32_t(hclen - 4), 4);
+    for (size_t i = 0; i < hclen; ++i)
+        bw.put(cl_len[cl_order[i]], 3);
+
+    for (const CLSym &s : cl_syms) {
+        bw.put_code(cl_code[s.sym], cl_len[s.sym]);
+        if (s.extra_bits) bw.put(s.extra, s.extra_bits);
+    }
+
+    const auto &lcodes = length_codes();
+    for (uint16_t t : m_tokens) {
+        if (t <= EndOfBlock)
+            bw.put_code(lit_code[t], lit_len[t]);
+        else {
+            const LengthCode &lc = lcodes[t - 256];
+            bw.put_code(lit_code[lc.code], lit_len[lc.code]);
+            if (lc.extra_bits) bw.put(t - 256 - lc.base, lc.extra_bits);
+            bw.put_code(0, 1); // distance code 0: distance of 1
+        }
+    }
+
+    if (!last) {
+        // Empty stored block
+        bw.put(0, 3);
+        bw.align();
+        out.insert(out.end(), {0x00, 0x00, 0xff, 0xff});
+    } else {
+        bw.align();
+    }
+}
+
+// Same as zlib's adler32_combine()
+mz_ulong adler32_combine(mz_ulong adler1, mz_ulong adler2, size_t len2)
+{
+    constexpr mz_ulong BASE = 65521;
+
+    mz_ulong rem  = mz_ulong(len2 % BASE);
+    mz_ulong sum1 = adler1 & 0xffff;
+    mz_ulong sum2 = (rem * sum1) % BASE;
+    sum1 += (adler2 & 0xffff) + BASE - 1;
+    sum2 += ((adler1 >> 16) & 0xffff) + ((adler2 >> 16) & 0xffff) + BASE - rem;
+    if (sum1 >= BASE) sum1 -= BASE;
+    if (sum1 >= BASE) sum1 -= BASE;
+    if (sum2 >= (BASE << 1)) sum2 -= (BASE << 1);
+    if (sum2 >= BASE) sum2 -= BASE;
+
+    return sum1 | (sum2 << 16);
+}
+
+// Adler-32 of a sequence of count zero bytes
+mz_ulong adler32_zeros(size_t count)
+{
+    return MZ_ADLER32_INIT | (mz_ulong(count % 65521) << 16);
+}
+
+void append_u32(std::vector<uint8_t> &buf, uint32_t v)
+{
+    buf.insert(buf.end(), {uint8_t(v >> 24), uint8_t(v >> 16), uint8_t(v >> 8), uint8_t(v)});
+}
+
+void append_png_chunk(std::vector<uint8_t> &buf, const char *type, const std::vector<uint8_t> &data)
+{
+    append_u32(buf, uint32_t(data.size()));
+    size_t type_pos = buf.size();
+    buf.insert(buf.end(), type, type + 4);
+    buf.insert(buf.end(), data.begin(), data.end());
+    append_u32(buf, uint32_t(mz_crc32(MZ_CRC32_INIT, buf.data() + type_pos, buf.size() - type_pos)));
+}
+
+struct DeflatedBlock {
+    std::vector<uint8_t> data;
+    mz_ulong             adler   = MZ_ADLER32_INIT;
+    size_t               raw_len = 0;
+};
+
+} // namespace
+
 EncodedRaster PNGRasterEncoder::operator()(const void *ptr, size_t w, size_t h,
                                            size_t      num_components)
 {
+    static const uint8_t color_types[] = {0 /*gray*/, 4 /*gray alpha*/, 2 /*rgb*/, 6 /*rgba*/};
+    if (w == 0 || h == 0 || num_components < 1 || num_components > 4)
+        return EncodedRaster({}, "png");
+
+    const auto  *pixels  = static_cast<const uint8_t *>(ptr);
+    const size_t row_len = w * num_components;
+
+    // Split the rows into blocks which are compressed in parallel. The
+    // concatenation of the blocks is a single valid deflate stream.
+    size_t max_blocks = std::max(size_t(1), execution::max_concurrency(ex_tbb));
+    size_t num_blocks = std::clamp(h / PNG_MIN_BLOCK_ROWS, size_t(1), max_blocks);
+    size_t block_rows = (h + num_blocks - 1) / num_blocks;
+    num_blocks = (h + block_rows - 1) / block_rows;
+
+    std::vector<DeflatedBlock> blocks(num_blocks);
+
+    execution::for_each(ex_tbb, size_t(0), num_blocks, [&](size_t b) {
+        size_t row_begin = b * block_rows;
+        size_t row_end   = std::min(h, row_begin + block_rows);
+
+        DeflatedBlock &blk = blocks[b];
+        RLEDeflater    deflater;
+
+        // Rows identical to the previous one are filtered with Up (all
+        // zeros), the others are left unfiltered. Any of the other PNG
+        // filters would only trade one constant run for another.
+        for (size_t r = row_begin; r < row_end; ++r) {
+            const uint8_t *row = pixels + r * row_len;
+            const uint8_t filter = r > 0 && std::memcmp(row, row - row_len, row_len) == 0 ?
+                                       pngfUp : pngfNone;
+
+            deflater.feed(&filter, 1);
+            blk.adler = mz_adler32(blk.adler, &filter, 1);
+
+            if (filter == pngfUp) {
+                deflater.feed_repeated(0, row_len);
+                blk.adler = adler32_combine(blk.adler, adler32_zeros(row_len), row_len);
+            } else {
+                deflater.feed(row, row_len);
+                blk.adler = mz_adler32(blk.adler, row, row_len);
+            }
+        }
+
+        blk.raw_len = (row_end - row_begin) * (row_len + 1);
+        deflater.write(blk.data, b + 1 == num_blocks);
+    }, 1);
+
+    std::vector<uint8_t> ihdr;
+    append_u32(ihdr, uint32_t(w));
+    append_u32(ihdr, uint32_t(h));
+    ihdr.insert(ihdr.end(), {8 /*bit depth*/, color_types[num_components - 1], 0, 0, 0});
+
+    size_t deflated_size = 0;
+    for (const DeflatedBlock &blk : blocks) deflated_size += blk.data.size();
+
+    // zlib header: deflate with 32K window, fastest compression hint
+    std::vector<uint8_t> idat;
+    idat.reserve(deflated_size + 6);
+    idat.insert(idat.end(), {0x78, 0x01});
+
+    mz_ulong adler = MZ_ADLER32_INIT;
+    for (const DeflatedBlock &blk : blocks) {
+        idat.insert(idat.end(), blk.data.begin(), blk.data.end());
+        adler = adler32_combine(adler, blk.adler, blk.raw_len);
+    }
+    append_u32(idat, uint32_t(adler));
+
+    static const uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
     std::vector<uint8_t> buf;
-    size_t s = 0;
-    
-    void *rawdata = tdefl_write_image_to_png_file_in_memory(
-        ptr, int(w), int(h), int(num_components), &s);
-    
-    // On error, data() will return an empty vector. No other info can be
-    // retrieved from miniz anyway...
-    if (rawdata == nullptr) return EncodedRaster({}, "png");
-    
-    auto pptr = static_cast<std::uint8_t*>(rawdata);
-    
-    buf.reserve(s);
-    std::copy(pptr, pptr + s, std::back_inserter(buf));
-    
-    MZ_FREE(rawdata);
+    buf.reserve(idat.size() + 64);
+    buf.insert(buf.end(), std::begin(signature), std::end(signature));
+    append_png_chunk(buf, "IHDR", ihdr);
+    append_png_chunk(buf, "IDAT", idat);
+    append_png_chunk(buf, "IEND", {});
+
     return EncodedRaster(std::move(buf), "png");
 }
 
@@ -67,6 +523,66 @@ EncodedRaster PPMRasterEncoder::operator()(const void *ptr, size_t w, size_t h,
     return EncodedRaster(std::move(buf), "ppm");
 }
 
+LayerDelta draw_layer(RasterBase       &raster,
+                      const ExPolygons &polys,
+                      const RasterBase *prev,
+                      const ExPolygons &prev_polys,
+                      double            max_changed_ratio)
+{
+    auto draw_all = [&raster, &polys] {
+        for (const ExPolygon &poly : polys)
+            raster.draw(poly);
+
+        return LayerDelta::Full;
+    };
+
+    if (!prev)
+        return draw_all();
+
+    ExPolygons changed = diff_ex(polys, prev_polys);
+    append(changed, diff_ex(prev_polys, polys));
+
+    if (changed.empty())
+        return LayerDelta::Unchanged;
+
+    // Bounding boxes of the changed areas, overlapping ones are merged.
+    // Redrawing a region has to check every polygon of the layer, so lots
+    // of small scattered changes are better handled as one region.
+    std::vector<BoundingBox> regions;
+    if (changed.size() > 64)
+        regions = {get_extents(changed)};
+    else
+        for (const ExPolygon &p : changed)
+            regions.emplace_back(get_extents(p));
+
+    for (bool merged = true; merged;) {
+        merged = false;
+        for (size_t i = 0; i < regions.size(); ++i)
+            for (size_t j = i + 1; j < regions.size(); ++j)
+                if (regions[i].overlap(regions[j])) {
+                    regions[i].merge(regions[j]);
+                    regions.erase(regions.begin() + j--);
+                    merged = true;
+                }
+    }
+
+    BoundingBox extents = get_extents(polys);
+    extents.merge(get_extents(prev_polys));
+
+    double changed_area = 0.;
+    for (const BoundingBox &r : regions)
+        changed_area += double(r.size().x()) * double(r.size().y());
+
+    double extents_area = double(extents.size().x()) * double(extents.size().y());
+    if (changed_area > max_changed_ratio * extents_area || !raster.assign(*prev))
+        return draw_all();
+
+    for (const BoundingBox &r : regions)
+        raster.redraw(r, polys);
+
+    return LayerDelta::Partial;
+}
+
 std::unique_ptr<RasterBase> create_raster_grayscale_aa(
     const Resolution        &res,
     const PixelDim          &pxdim,
@@ -85,6 +601,16 @@ std::unique_ptr<RasterBase> create_raster_grayscale_aa(
     return rst;
 }
 
+std::unique_ptr<RasterBase> create_raster_grayscale_scanline(
+    const Resolution        &res,
+    const PixelDim          &pxdim,
+    double                   gamma,
+    const RasterBase::Trafo &tr,
+    int                      supersampling)
+{
+    return std::make_unique<RasterGrayscaleScanline>(res, pxdim, tr, gamma, supersampling);
+}
+
 } // namespace sla
 } // namespace Slic3r
 
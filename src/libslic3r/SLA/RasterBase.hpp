@@ -14,6 +14,7 @@
 #include <cstdint>
 
 #include <libslic3r/ExPolygon.hpp>
+#include <libslic3r/BoundingBox.hpp>
 
 namespace Slic3r {
 
@@ -99,8 +100,33 @@ public:
     virtual Trafo      trafo() const = 0;
     
     virtual EncodedRaster encode(RasterEncoder encoder) const = 0;
+
+    /// Optional support for incremental drawing of similar layers.
+    /// Take over the pixels of other, which has to be a raster of the same
+    /// type and resolution. Returns false if not supported.
+    virtual bool assign(const RasterBase &/*other*/) { return false; }
+
+    /// Clear the given region and draw the polygons again, but only inside
+    /// the region. The region is in the coordinates of the drawn polygons.
+    /// Only called on rasters which support assign().
+    virtual void redraw(const BoundingBox &/*region*/, const ExPolygons &/*polys*/) {}
 };
 
+enum class LayerDelta { Full, Partial, Unchanged };
+
+// Draw the polygons of a layer into raster. If the raster of the previous
+// layer (drawn from prev_polys) is given, the two layers are compared and
+// only the regions where they differ are redrawn on top of a copy of the
+// previous raster. The whole layer is drawn if the raster does not support
+// incremental drawing or if the changed regions exceed max_changed_ratio
+// of the layer extents. For LayerDelta::Unchanged nothing is drawn into
+// raster, the previous raster can be used instead.
+LayerDelta draw_layer(RasterBase       &raster,
+                      const ExPolygons &polys,
+                      const RasterBase *prev              = nullptr,
+                      const ExPolygons &prev_polys        = {},
+                      double            max_changed_ratio = 0.5);
+
 struct PNGRasterEncoder {
     EncodedRaster operator()(const void *ptr, size_t w, size_t h, size_t num_components);
 };
@@ -118,6 +144,17 @@ std::unique_ptr<RasterBase> create_raster_grayscale_aa(
     double                   gamma = 1.0,
     const RasterBase::Trafo &tr    = {});
 
+// Same as create_raster_grayscale_aa, but the returned raster uses the
+// scanline coverage rasterizer from ScanlineRaster.hpp instead of AGG. The
+// anti-aliasing is done by supersampling each pixel on a grid of
+// supersampling x supersampling samples, 1 disables it.
+std::unique_ptr<RasterBase> create_raster_grayscale_scanline(
+    const Resolution        &res,
+    const PixelDim          &pxdim,
+    double                   gamma         = 1.0,
+    const RasterBase::Trafo &tr            = {},
+    int                      supersampling = 4);
+
 }} // namespace Slic3r::sla
 
 #endif // SLARASTERBASE_HPP
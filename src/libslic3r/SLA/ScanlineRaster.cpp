@@ -0,0 +1,299 @@
+///|/ Copyright (c) Prusa Research 2023
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include "ScanlineRaster.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Slic3r { namespace sla {
+
+RasterGrayscaleScanline::RasterGrayscaleScanline(const Resolution &res,
+                                                 const PixelDim   &pd,
+                                                 const Trafo      &trafo,
+                                                 double            gamma,
+                                                 int               supersampling,
+                                                 FillRule          fill_rule)
+    : m_resolution(res)
+    , m_pxdim_scaled(SCALING_FACTOR, SCALING_FACTOR)
+    , m_trafo(trafo)
+    , m_supersampling(std::clamp(supersampling, 1, 16))
+    , m_fill_rule(fill_rule)
+    , m_buf(res.pixels(), uint8_t(0))
+{
+    // Visual Studio compiler gives warnings about possible division by zero.
+    assert(pd.w_mm != 0 && pd.h_mm != 0);
+    if (pd.w_mm != 0 && pd.h_mm != 0) {
+        m_pxdim_scaled.w_mm /= pd.w_mm;
+        m_pxdim_scaled.h_mm /= pd.h_mm;
+    }
+
+    const int samples = m_supersampling * m_supersampling;
+    m_lut.resize(samples + 1);
+    for (int c = 0; c <= samples; ++c) {
+        double a = double(c) / samples;
+        double v = gamma > 0. ? std::pow(a, gamma) : (a < .5 ? 0. : 1.);
+        m_lut[c] = uint8_t(std::round(std::clamp(v, 0., 1.) * 255.));
+    }
+}
+
+PixelDim RasterGrayscaleScanline::pixel_dimensions() const
+{
+    return {SCALING_FACTOR / m_pxdim_scaled.w_mm,
+            SCALING_FACTOR / m_pxdim_scaled.h_mm};
+}
+
+// Same transformation as AGGRaster::to_path()
+Vec2d RasterGrayscaleScanline::to_px(const Point &p) const
+{
+    double x = m_trafo.flipXY ? p.y() * m_pxdim_scaled.h_mm : p.x() * m_pxdim_scaled.w_mm;
+    double y = m_trafo.flipXY ? p.x() * m_pxdim_scaled.w_mm : p.y() * m_pxdim_scaled.h_mm;
+
+    x += m_trafo.center_x * m_pxdim_scaled.w_mm;
+    y += m_trafo.center_y * m_pxdim_scaled.h_mm;
+
+    if (m_trafo.mirror_x) x = double(m_resolution.width_px) - x;
+    if (m_trafo.mirror_y) y = double(m_resolution.height_px) - y;
+
+    return {x, y};
+}
+
+// Pixels touched by the bounding box, with a margin for anti-aliasing,
+// clipped to the canvas.
+RasterGrayscaleScanline::PxRect RasterGrayscaleScanline::to_px_rect(const BoundingBox &bb) const
+{
+    Vec2d a = to_px(bb.min), b = to_px(bb.max);
+    int   w = int(m_resolution.width_px), h = int(m_resolution.height_px);
+
+    auto clamp_px = [](double v, int hi) { return int(std::clamp(v, 0., double(hi))); };
+
+    return {clamp_px(std::floor(std::min(a.x(), b.x())) - 1, w),
+            clamp_px(std::floor(std::min(a.y(), b.y())) - 1, h),
+            clamp_px(std::ceil(std::max(a.x(), b.x())) + 1, w),
+            clamp_px(std::ceil(std::max(a.y(), b.y())) + 1, h)};
+}
+
+void RasterGrayscaleScanline::add_edges(const Points &pts)
+{
+    const double S      = m_supersampling;
+    const double ys_max = double(m_resolution.height_px * m_supersampling);
+
+    for (size_t i = 0; i < pts.size(); ++i) {
+        Vec2d a = to_px(pts[i]);
+        Vec2d b = to_px(pts[(i + 1) % pts.size()]);
+
+        int winding = 1;
+        if (a.y() > b.y()) {
+            std::swap(a, b);
+            winding = -1;
+        }
+
+        // Sub-scanline i is sampled at y = (i + 0.5) / S
+        int yb = int(std::clamp(std::ceil(a.y() * S - .5), 0., ys_max));
+        int ye = int(std::clamp(std::ceil(b.y() * S - .5), 0., ys_max));
+        if (yb >= ye)
+            continue;
+
+        double dxdy = (b.x() - a.x()) / (b.y() - a.y());
+        double x    = (a.x() + ((yb + .5) / S - a.y()) * dxdy) * S;
+
+        m_edges.push_back({x, dxdy, yb, ye, winding});
+    }
+}
+
+void RasterGrayscaleScanline::draw(const ExPolygon &poly)
+{
+    add_edges(poly.contour.points);
+    for (const Polygon &h : poly.holes)
+        add_edges(h.points);
+}
+
+void RasterGrayscaleScanline::render(const PxRect *clip) const
+{
+    if (m_edges.empty())
+        return;
+
+    const int S        = m_supersampling;
+    const int W        = int(m_resolution.width_px);
+    const int ys_min   = clip ? clip->y0 * S : 0;
+    const int ys_max   = clip ? clip->y1 * S : int(m_resolution.height_px) * S;
+    const int xs_max   = W * S;
+    const int samples  = S * S;
+    const int px_min   = clip ? clip->x0 : 0;
+    const int px_max   = clip ? clip->x1 : W;
+
+    std::sort(m_edges.begin(), m_edges.end(),
+              [](const Edge &a, const Edge &b) { return a.y_begin < b.y_begin; });
+
+    // Coverage of the current pixel row. Spans of fully covered pixels are
+    // recorded as a difference array (cover) so that a span costs O(1)
+    // regardless of its length, the partially covered end pixels go to
+    // partial. The pixels where either of them changes are recorded in
+    // events, so that a finished row can be written out as a few constant
+    // runs instead of visiting every pixel.
+    std::vector<int> cover(W + 1, 0), partial(W + 1, 0);
+    std::vector<int> events;
+    int row = -1;
+
+    auto fill_span = [&](double xa, double xb) {
+        int sa = int(std::clamp(std::ceil(xa - .5), 0., double(xs_max)));
+        int sb = int(std::clamp(std::ceil(xb - .5), 0., double(xs_max)));
+        if (sa >= sb)
+            return;
+
+        int pa = sa / S, pb = sb / S;
+        if (pa == pb) {
+            partial[pa] += sb - sa;
+            events.emplace_back(pa);
+        } else {
+            partial[pa] += S - (sa - pa * S);
+            cover[pa + 1] += S;
+            cover[pb] -= S;
+            partial[pb] += sb - pb * S;
+            events.insert(events.end(), {pa, pa + 1, pb});
+        }
+    };
+
+    auto flush_row = [&]() {
+        if (row < 0 || events.empty())
+            return;
+
+        std::sort(events.begin(), events.end());
+        events.erase(std::unique(events.begin(), events.end()), events.end());
+        events.emplace_back(W);
+
+        uint8_t *dst = m_buf.data() + size_t(row) * size_t(W);
+        int      run = 0;
+        for (size_t k = 0; k + 1 < events.size(); ++k) {
+            int px = events[k], px_end = std::min(events[k + 1], px_max);
+
+            run += cover[px];
+            if (px >= px_min && px < px_max) {
+                int c = std::min(run + partial[px], samples);
+                if (c > 0)
+                    dst[px] = std::max(dst[px], m_lut[c]);
+            }
+
+            // Coverage is constant up to the next event
+            int c = std::min(run, samples), x = std::max(px + 1, px_min);
+            if (c == samples)
+                std::fill(dst + x, dst + std::max(x, px_end), m_lut[c]);
+            else if (c > 0)
+                for (; x < px_end; ++x)
+                    dst[x] = std::max(dst[x], m_lut[c]);
+
+            cover[px]   = 0;
+            partial[px] = 0;
+        }
+
+        cover[W]   = 0;
+        partial[W] = 0;
+        events.clear();
+    };
+
+    std::vector<size_t>              active;
+    std::vector<std::pair<double, int>> crossings;
+    size_t next = 0;
+
+    for (int ys = std::max(m_edges.front().y_begin, ys_min); ys < ys_max; ++ys) {
+        // Skip the empty space between disjoint parts of the layer
+        if (active.empty()) {
+            if (next == m_edges.size())
+                break;
+
+            ys = std::max(ys, m_edges[next].y_begin);
+            if (ys >= ys_max)
+                break;
+        }
+
+        if (ys / S != row) {
+            flush_row();
+            row = ys / S;
+        }
+
+        // Edges starting above a clipped area have to catch up
+        for (; next < m_edges.size() && m_edges[next].y_begin <= ys; ++next) {
+            m_edges[next].x += (ys - m_edges[next].y_begin) * m_edges[next].dx;
+            active.emplace_back(next);
+        }
+
+        active.erase(std::remove_if(active.begin(), active.end(),
+                                    [this, ys](size_t i) { return m_edges[i].y_end <= ys; }),
+                     active.end());
+
+        crossings.clear();
+        for (size_t i : active)
+            crossings.emplace_back(m_edges[i].x, m_edges[i].winding);
+
+        std::sort(crossings.begin(), crossings.end());
+
+        int w = 0;
+        for (size_t k = 0; k + 1 < crossings.size(); ++k) {
+            w += crossings[k].second;
+            bool inside = m_fill_rule == frNonZero ? w != 0 : (w & 1) != 0;
+            if (inside)
+                fill_span(crossings[k].first, crossings[k + 1].first);
+        }
+
+        for (size_t i : active)
+            m_edges[i].x += m_edges[i].dx;
+    }
+
+    flush_row();
+    m_edges.clear();
+}
+
+EncodedRaster RasterGrayscaleScanline::encode(RasterEncoder encoder) const
+{
+    render();
+    return encoder(m_buf.data(), m_resolution.width_px, m_resolution.height_px, 1);
+}
+
+bool RasterGrayscaleScanline::assign(const RasterBase &other)
+{
+    auto rst = dynamic_cast<const RasterGrayscaleScanline *>(&other);
+    if (!rst || rst->m_buf.size() != m_buf.size() ||
+        rst->m_resolution.width_px != m_resolution.width_px)
+        return false;
+
+    rst->render();
+    m_edges.clear();
+    m_buf = rst->m_buf;
+
+    return true;
+}
+
+void RasterGrayscaleScanline::redraw(const BoundingBox &region, const ExPolygons &polys)
+{
+    render();
+
+    PxRect r = to_px_rect(region);
+    if (r.x0 >= r.x1 || r.y0 >= r.y1)
+        return;
+
+    for (int y = r.y0; y < r.y1; ++y)
+        std::fill_n(m_buf.begin() + size_t(y) * m_resolution.width_px + r.x0, r.x1 - r.x0, uint8_t(0));
+
+    for (const ExPolygon &poly : polys) {
+        PxRect pr = to_px_rect(get_extents(poly.contour));
+        if (pr.x0 < r.x1 && r.x0 < pr.x1 && pr.y0 < r.y1 && r.y0 < pr.y1)
+            draw(poly);
+    }
+
+    render(&r);
+}
+
+uint8_t RasterGrayscaleScanline::read_pixel(size_t col, size_t row) const
+{
+    render();
+    return m_buf[row * m_resolution.width_px + col];
+}
+
+void RasterGrayscaleScanline::clear()
+{
+    m_edges.clear();
+    std::fill(m_buf.begin(), m_buf.end(), uint8_t(0));
+}
+
+}} // namespace Slic3r::sla
@@ -0,0 +1,94 @@
+///|/ Copyright (c) Prusa Research 2023
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef SLA_SCANLINERASTER_HPP
+#define SLA_SCANLINERASTER_HPP
+
+#include <libslic3r/SLA/RasterBase.hpp>
+
+namespace Slic3r { namespace sla {
+
+// Monochrome canvas specialized for filling polygons, an alternative to the
+// AGG based RasterGrayscaleAA. Polygons passed to draw() are only collected
+// as edges and the whole layer is rasterized in a single active edge table
+// sweep when the pixels are first needed (encode() or read_pixel()). This
+// avoids building an agg::path_storage and running the generic scanline
+// rasterizer for every polygon, which dominates the rasterization time for
+// high resolution displays.
+//
+// Anti-aliasing is done by supersampling: every pixel is sampled on a
+// supersampling x supersampling grid and the covered sample count is mapped
+// to a gray level through a gamma lookup table. Supersampling of 1 disables
+// anti-aliasing.
+class RasterGrayscaleScanline : public RasterBase {
+public:
+    enum FillRule { frNonZero, frEvenOdd };
+
+    // If gamma is zero, thresholding will be performed (same as with
+    // create_raster_grayscale_aa).
+    RasterGrayscaleScanline(const Resolution &res,
+                            const PixelDim   &pd,
+                            const Trafo      &trafo,
+                            double            gamma         = 1.,
+                            int               supersampling = 4,
+                            FillRule          fill_rule     = frNonZero);
+
+    Trafo      trafo() const override { return m_trafo; }
+    Resolution resolution() const { return m_resolution; }
+    PixelDim   pixel_dimensions() const;
+    int        supersampling() const { return m_supersampling; }
+    FillRule   fill_rule() const { return m_fill_rule; }
+
+    void draw(const ExPolygon &poly) override;
+
+    EncodedRaster encode(RasterEncoder encoder) const override;
+
+    bool assign(const RasterBase &other) override;
+    void redraw(const BoundingBox &region, const ExPolygons &polys) override;
+
+    uint8_t read_pixel(size_t col, size_t row) const;
+
+    void clear();
+
+private:
+    // Polygon edge in sub-scanline space. Edges are stored with the X
+    // coordinate already evaluated at the first sub-scanline they cross,
+    // in sub-sample units.
+    struct Edge {
+        double x;       // X at sub-scanline y_begin
+        double dx;      // X increment per sub-scanline
+        int    y_begin; // first crossed sub-scanline
+        int    y_end;   // one past the last crossed sub-scanline
+        int    winding; // +1 or -1 depending on the edge direction
+    };
+
+    // Pixel rectangle [x0, x1) x [y0, y1)
+    struct PxRect { int x0, y0, x1, y1; };
+
+    Vec2d  to_px(const Point &p) const;
+    PxRect to_px_rect(const BoundingBox &bb) const;
+    void   add_edges(const Points &pts);
+
+    // Rasterize all the edges collected so far in one sweep. If clip is
+    // given, only the pixels inside are written.
+    void render(const PxRect *clip = nullptr) const;
+
+    Resolution m_resolution;
+    PixelDim   m_pxdim_scaled; // used for scaled coordinate polygons
+    Trafo      m_trafo;
+    int        m_supersampling;
+    FillRule   m_fill_rule;
+
+    // Gray level for each possible covered sample count of a pixel
+    std::vector<uint8_t> m_lut;
+
+    // Rendering is deferred until the pixels are needed, thus these are
+    // updated from const accessors.
+    mutable std::vector<Edge>    m_edges;
+    mutable std::vector<uint8_t> m_buf;
+};
+
+}} // namespace Slic3r::sla
+
+#endif // SLA_SCANLINERASTER_HPP
@@ -81,6 +81,21 @@ struct SupportTreeConfig
 
     double max_weight_on_model_support = 10.f;
 
+    // Build the branching tree in spatial partitions concurrently. The support
+    // points at the seams of the partitions are routed afterwards, these may
+    // end on the branches of the adjacent partitions. The tree differs from
+    // the one built at once, as the branches of neighbouring partitions
+    // don't merge into a common junction.
+    bool branching_tree_parallel = true;
+
+    // Collect the parts of the concurrently built partitions in a fixed order,
+    // so that the resulting support mesh is the same on every run.
+    bool branching_tree_deterministic = true;
+
+    // Groups of support points larger than this are split into partitions
+    // when building the branching tree in parallel.
+    unsigned branching_tree_partition_size = 512;
+
     double head_fullwidth() const {
         return 2 * head_front_radius_mm + head_width_mm +
                2 * head_back_radius_mm - head_penetration_mm;
@@ -128,6 +143,14 @@ struct SupportableMesh
         : emesh{trmsh}, pts{sp}, cfg{c}
     {}
 
+    // The AABB tree of the mesh is shared through AABBTreeCache, the caller
+    // keeps the mesh alive.
+    explicit SupportableMesh(const std::shared_ptr<const indexed_triangle_set> &trmsh,
+                             const SupportPoints        &sp,
+                             const SupportTreeConfig    &c)
+        : emesh{trmsh}, pts{sp}, cfg{c}
+    {}
+
 //    explicit SupportableMesh(const AABBMesh          &em,
 //                             const SupportPoints     &sp,
 //                             const SupportTreeConfig &c)
@@ -84,51 +84,104 @@ void SupportTreeBuilder::add_pillar_base(long pid, double baseheight, double rad
     m_meshcache_valid = false;
 }
 
-const indexed_triangle_set &SupportTreeBuilder::merged_mesh(size_t steps) const
+void SupportTreeBuilder::merge(SupportTreeBuilder &&other)
 {
-    if (m_meshcache_valid) return m_meshcache;
-    
-    indexed_triangle_set merged;
-    
-    for (auto &head : m_heads) {
-        if (ctl().stopcondition()) break;
-        if (head.is_valid()) its_merge(merged, get_mesh(head, steps));
-    }
-    
-    for (auto &pill : m_pillars) {
-        if (ctl().stopcondition()) break;
-        its_merge(merged, get_mesh(pill, steps));
-    }
+    assert(other.m_heads.empty());
+
+    auto append = [](auto &dst, auto &src) {
+        long offset = long(dst.size());
+        dst.reserve(dst.size() + src.size());
+        for (auto &el : src) {
+            dst.emplace_back(std::move(el));
+            if (dst.back().id != SupportTreeNode::ID_UNSET)
+                dst.back().id += offset;
+        }
+        src.clear();
+    };
 
-    for (auto &pedest : m_pedestals) {
-        if (ctl().stopcondition()) break;
-        its_merge(merged, get_mesh(pedest, steps));
-    }
-    
-    for (auto &j : m_junctions) {
-        if (ctl().stopcondition()) break;
-        its_merge(merged, get_mesh(j, steps));
-    }
+    std::lock_guard<Mutex> lk(m_mutex);
+    append(m_pillars, other.m_pillars);
+    append(m_junctions, other.m_junctions);
+    append(m_bridges, other.m_bridges);
+    append(m_crossbridges, other.m_crossbridges);
+    append(m_diffbridges, other.m_diffbridges);
+    append(m_pedestals, other.m_pedestals);
+    append(m_anchors, other.m_anchors);
+    m_meshcache_valid = false;
+}
 
-    for (auto &bs : m_bridges) {
-        if (ctl().stopcondition()) break;
-        its_merge(merged, get_mesh(bs, steps));
-    }
-    
-    for (auto &bs : m_crossbridges) {
-        if (ctl().stopcondition()) break;
-        its_merge(merged, get_mesh(bs, steps));
+// Offsets of the meshes of the elements in the merged mesh, with the end of
+// the last one at the back. The elements not passing the filter are skipped.
+template<class El, class Filter>
+static std::vector<MeshSize> mesh_offsets(ElementMesher         &mesher,
+                                          const std::vector<El> &elements,
+                                          MeshSize              &total,
+                                          Filter               &&filter)
+{
+    auto offsets = reserve_vector<MeshSize>(elements.size() + 1);
+    for (const El &el : elements) {
+        offsets.emplace_back(total);
+        if (filter(el)) {
+            MeshSize size = mesher.mesh_size(el);
+            total.vertices += size.vertices;
+            total.indices  += size.indices;
+        }
     }
+    offsets.emplace_back(total);
 
-    for (auto &bs : m_diffbridges) {
-        if (ctl().stopcondition()) break;
-        its_merge(merged, get_mesh(bs, steps));
-    }
+    return offsets;
+}
 
-    for (auto &anch : m_anchors) {
-        if (ctl().stopcondition()) break;
-        its_merge(merged, get_mesh(anch, steps));
-    }
+template<class El>
+static void write_meshes(const ElementMesher          &mesher,
+                         const std::vector<El>        &elements,
+                         const std::vector<MeshSize>  &offsets,
+                         indexed_triangle_set         &merged,
+                         const JobController          &ctl)
+{
+    execution::for_each(
+        ex_tbb, size_t(0), elements.size(),
+        [&](size_t i) {
+            if (offsets[i + 1].vertices > offsets[i].vertices && !ctl.stopcondition())
+                mesher.write(elements[i], MeshSpan{merged.vertices.data() + offsets[i].vertices,
+                                                   merged.indices.data() + offsets[i].indices,
+                                                   int(offsets[i].vertices)});
+        },
+        64);
+}
+
+const indexed_triangle_set &SupportTreeBuilder::merged_mesh(size_t steps) const
+{
+    if (m_meshcache_valid) return m_meshcache;
+
+    // First pass: sizes of the element meshes and their places in the merged
+    // mesh, second pass: the element meshes are written in parallel into the
+    // preallocated merged mesh.
+    ElementMesher mesher{steps};
+    MeshSize      total;
+    auto          all = [](const auto &) { return true; };
+
+    auto head_offsets        = mesh_offsets(mesher, m_heads, total, [](const Head &h) { return h.is_valid(); });
+    auto pillar_offsets      = mesh_offsets(mesher, m_pillars, total, all);
+    auto pedestal_offsets    = mesh_offsets(mesher, m_pedestals, total, all);
+    auto junction_offsets    = mesh_offsets(mesher, m_junctions, total, all);
+    auto bridge_offsets      = mesh_offsets(mesher, m_bridges, total, all);
+    auto crossbridge_offsets = mesh_offsets(mesher, m_crossbridges, total, all);
+    auto diffbridge_offsets  = mesh_offsets(mesher, m_diffbridges, total, all);
+    auto anchor_offsets      = mesh_offsets(mesher, m_anchors, total, all);
+
+    indexed_triangle_set merged;
+    merged.vertices.resize(total.vertices);
+    merged.indices.resize(total.indices);
+
+    write_meshes(mesher, m_heads, head_offsets, merged, ctl());
+    write_meshes(mesher, m_pillars, pillar_offsets, merged, ctl());
+    write_meshes(mesher, m_pedestals, pedestal_offsets, merged, ctl());
+    write_meshes(mesher, m_junctions, junction_offsets, merged, ctl());
+    write_meshes(mesher, m_bridges, bridge_offsets, merged, ctl());
+    write_meshes(mesher, m_crossbridges, crossbridge_offsets, merged, ctl());
+    write_meshes(mesher, m_diffbridges, diffbridge_offsets, merged, ctl());
+    write_meshes(mesher, m_anchors, anchor_offsets, merged, ctl());
 
     if (ctl().stopcondition()) {
         // In case of failure we have to return an empty mesh
@@ -418,6 +418,11 @@ public:
         return m_pillars[size_t(id)];
     }
 
+    // Append the parts built by another builder, e.g. one used for a part of
+    // the tree built concurrently. The heads are not merged, the other builder
+    // is only expected to connect to the heads of this one.
+    void merge(SupportTreeBuilder &&other);
+
     // WITHOUT THE PAD!!!
     const indexed_triangle_set &merged_mesh(size_t steps = 45) const;
     
@@ -4,6 +4,8 @@
 ///|/
 #include "SupportTreeMesher.hpp"
 
+#include <mutex>
+
 namespace Slic3r { namespace sla {
 
 indexed_triangle_set sphere(double rho, Portion portion, double fa) {
@@ -213,11 +215,80 @@ indexed_triangle_set halfcone(double       baseheight,
     return base;
 }
 
-indexed_triangle_set get_mesh(const Head &h, size_t steps)
+struct ElementMesher::UnitMeshes
+{
+    indexed_triangle_set sphere, cylinder, halfcone;
+    // cos and sin of the vertices of the half cone rings, exactly as
+    // halfcone() calculates them.
+    std::vector<Vec2d>   ring;
+
+    explicit UnitMeshes(size_t steps)
+        : sphere{sla::sphere(1., make_portion(0, PI), 2 * PI / steps)}
+        , cylinder{sla::cylinder(1., 1., steps)}
+        , halfcone{sla::halfcone(1., 1., 1., Vec3d::Zero(), steps)}
+    {
+        double a = 2 * PI / steps;
+        ring.reserve(steps);
+        for (size_t i = 0; i < steps; ++i)
+            ring.emplace_back(std::cos(i * a), std::sin(i * a));
+    }
+};
+
+std::shared_ptr<const ElementMesher::UnitMeshes> ElementMesher::unit_meshes(size_t steps)
+{
+    static std::mutex mutex;
+    static std::map<size_t, std::shared_ptr<const UnitMeshes>> cache;
+
+    std::lock_guard<std::mutex> lk(mutex);
+    std::shared_ptr<const UnitMeshes> &ret = cache[steps];
+    if (!ret)
+        ret = std::make_shared<const UnitMeshes>(steps);
+
+    return ret;
+}
+
+ElementMesher::PinheadKey ElementMesher::pinhead_key(const Head &h)
+{
+    return { h.r_pin_mm, h.r_back_mm, h.width_mm, h.penetration_mm };
+}
+
+ElementMesher::ElementMesher(size_t steps) : m_steps{steps}, m_unit{unit_meshes(steps)}
+{
+    assert(steps > 0);
+}
+
+template<class Fn>
+static void write_instance(const indexed_triangle_set &tmpl, const MeshSpan &out, Fn &&vertex_fn)
+{
+    for (size_t i = 0; i < tmpl.vertices.size(); ++i)
+        out.vertices[i] = vertex_fn(tmpl.vertices[i]);
+
+    for (size_t i = 0; i < tmpl.indices.size(); ++i)
+        out.indices[i] = tmpl.indices[i] + stl_triangle_vertex_indices::Constant(out.vertex_offset);
+}
+
+static MeshSize mesh_size(const indexed_triangle_set &its)
 {
-    indexed_triangle_set mesh = pinhead(h.r_pin_mm, h.r_back_mm, h.width_mm, steps);
+    return { its.vertices.size(), its.indices.size() };
+}
+
+MeshSize ElementMesher::mesh_size(const Head &h)
+{
+    PinheadKey key = pinhead_key(h);
+    auto it = m_pinheads.find(key);
+    if (it == m_pinheads.end()) {
+        indexed_triangle_set mesh = pinhead(h.r_pin_mm, h.r_back_mm, h.width_mm, m_steps);
+        for (auto& p : mesh.vertices) p.z() -= (h.fullwidth() - h.r_back_mm);
+        it = m_pinheads.emplace(key, std::move(mesh)).first;
+    }
+
+    return sla::mesh_size(it->second);
+}
 
-    for (auto& p : mesh.vertices) p.z() -= (h.fullwidth() - h.r_back_mm);
+void ElementMesher::write(const Head &h, const MeshSpan &out) const
+{
+    auto it = m_pinheads.find(pinhead_key(h));
+    assert(it != m_pinheads.end());
 
     using Quaternion = Eigen::Quaternion<float>;
 
@@ -229,33 +300,104 @@ indexed_triangle_set get_mesh(const Head &h, size_t steps)
                                               h.dir.cast<float>());
 
     Vec3f pos = h.pos.cast<float>();
-    for (auto& p : mesh.vertices) p = quatern * p + pos;
+    write_instance(it->second, out, [&quatern, &pos](const Vec3f &p) -> Vec3f { return quatern * p + pos; });
+}
 
-    return mesh;
+MeshSize ElementMesher::halfcone_size(double baseheight, double r_bottom, double r_top) const
+{
+    if (baseheight <= 0 || (r_bottom <= 0. && r_top <= 0.))
+        return {};
+
+    return sla::mesh_size(m_unit->halfcone);
 }
 
-indexed_triangle_set get_mesh(const Bridge &br, size_t steps)
+// Same vertices as halfcone(), the indices are taken from the template.
+void ElementMesher::write_halfcone(double baseheight, double r_bottom, double r_top, const Vec3d &pos, const MeshSpan &out) const
+{
+    const size_t steps = m_unit->ring.size();
+    Vec3d        ep{pos.x(), pos.y(), pos.z() + baseheight};
+    for (size_t i = 0; i < steps; ++i) {
+        const Vec2d &cs = m_unit->ring[i];
+        out.vertices[i] = Vec3f(float(pos.x() + r_top * cs.x()), float(pos.y() + r_top * cs.y()), float(ep.z()));
+        out.vertices[steps + i] = Vec3f(float(pos.x() + r_bottom * cs.x()), float(pos.y() + r_bottom * cs.y()), float(pos.z()));
+    }
+    out.vertices[2 * steps]     = pos.cast<float>();
+    out.vertices[2 * steps + 1] = ep.cast<float>();
+
+    const std::vector<stl_triangle_vertex_indices> &indices = m_unit->halfcone.indices;
+    for (size_t i = 0; i < indices.size(); ++i)
+        out.indices[i] = indices[i] + stl_triangle_vertex_indices::Constant(out.vertex_offset);
+}
+
+MeshSize ElementMesher::mesh_size(const Pillar &p) const
+{
+    // Endpoint is below the starting point
+    return p.height > EPSILON ? halfcone_size(p.height, p.r_end, p.r_start) : MeshSize{};
+}
+
+void ElementMesher::write(const Pillar &p, const MeshSpan &out) const
+{
+    if (p.height > EPSILON)
+        write_halfcone(p.height, p.r_end, p.r_start, p.endpt, out);
+}
+
+MeshSize ElementMesher::mesh_size(const Pedestal &p) const
+{
+    return halfcone_size(p.height, p.r_bottom, p.r_top);
+}
+
+void ElementMesher::write(const Pedestal &p, const MeshSpan &out) const
+{
+    write_halfcone(p.height, p.r_bottom, p.r_top, p.pos, out);
+}
+
+MeshSize ElementMesher::mesh_size(const Junction &j) const
+{
+    // prohibit close to zero radius, as sphere() does
+    return j.r <= 1e-6 && j.r >= -1e-6 ? MeshSize{} : sla::mesh_size(m_unit->sphere);
+}
+
+void ElementMesher::write(const Junction &j, const MeshSpan &out) const
+{
+    auto  r   = float(j.r);
+    Vec3f pos = j.pos.cast<float>();
+    write_instance(m_unit->sphere, out, [r, &pos](const Vec3f &p) -> Vec3f { return r * p + pos; });
+}
+
+MeshSize ElementMesher::mesh_size(const Bridge &br) const
+{
+    return sla::mesh_size(m_unit->cylinder);
+}
+
+void ElementMesher::write(const Bridge &br, const MeshSpan &out) const
 {
     using Quaternion = Eigen::Quaternion<float>;
     Vec3d v = (br.endp - br.startp);
     Vec3d dir = v.normalized();
-    double d = v.norm();
-
-    indexed_triangle_set mesh = cylinder(br.r, d, steps);
+    auto  r = float(br.r);
+    auto  d = float(v.norm());
 
     auto quater = Quaternion::FromTwoVectors(Vec3f{0.f, 0.f, 1.f},
                                              dir.cast<float>());
 
     Vec3f startp = br.startp.cast<float>();
-    for(auto& p : mesh.vertices) p = quater * p + startp;
+    write_instance(m_unit->cylinder, out, [&quater, &startp, r, d](const Vec3f &p) -> Vec3f {
+        return quater * Vec3f(r * p.x(), r * p.y(), d * p.z()) + startp;
+    });
+}
 
-    return mesh;
+MeshSize ElementMesher::mesh_size(const DiffBridge &br) const
+{
+    return halfcone_size(br.get_length(), br.r, br.end_r);
 }
 
-indexed_triangle_set get_mesh(const DiffBridge &br, size_t steps)
+void ElementMesher::write(const DiffBridge &br, const MeshSpan &out) const
 {
-    double h = br.get_length();
-    indexed_triangle_set mesh = halfcone(h, br.r, br.end_r, Vec3d::Zero(), steps);
+    MeshSize size = mesh_size(br);
+    if (size.vertices == 0)
+        return;
+
+    write_halfcone(br.get_length(), br.r, br.end_r, Vec3d::Zero(), out);
 
     using Quaternion = Eigen::Quaternion<float>;
 
@@ -267,9 +409,30 @@ indexed_triangle_set get_mesh(const DiffBridge &br, size_t steps)
                                               br.get_dir().cast<float>());
 
     Vec3f startp = br.startp.cast<float>();
-    for(auto& p : mesh.vertices) p = quatern * p + startp;
+    for (size_t i = 0; i < size.vertices; ++i)
+        out.vertices[i] = quatern * out.vertices[i] + startp;
+}
+
+template<class El>
+static indexed_triangle_set instance_mesh(const El &el, size_t steps)
+{
+    ElementMesher mesher{steps};
+    MeshSize size = mesher.mesh_size(el);
+
+    indexed_triangle_set mesh;
+    mesh.vertices.resize(size.vertices);
+    mesh.indices.resize(size.indices);
+    if (size.vertices > 0)
+        mesher.write(el, MeshSpan{mesh.vertices.data(), mesh.indices.data(), 0});
 
     return mesh;
 }
 
+indexed_triangle_set get_mesh(const Head &h, size_t steps) { return instance_mesh(h, steps); }
+indexed_triangle_set get_mesh(const Pillar &p, size_t steps) { return instance_mesh(p, steps); }
+indexed_triangle_set get_mesh(const Pedestal &p, size_t steps) { return instance_mesh(p, steps); }
+indexed_triangle_set get_mesh(const Junction &j, size_t steps) { return instance_mesh(j, steps); }
+indexed_triangle_set get_mesh(const Bridge &br, size_t steps) { return instance_mesh(br, steps); }
+indexed_triangle_set get_mesh(const DiffBridge &br, size_t steps) { return instance_mesh(br, steps); }
+
 }} // namespace Slic3r::sla
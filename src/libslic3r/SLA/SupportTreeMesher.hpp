@@ -5,6 +5,10 @@
 #ifndef SUPPORTTREEMESHER_HPP
 #define SUPPORTTREEMESHER_HPP
 
+#include <array>
+#include <map>
+#include <memory>
+
 #include "libslic3r/Point.hpp"
 
 #include "libslic3r/SLA/SupportTreeBuilder.hpp"
@@ -47,35 +51,72 @@ indexed_triangle_set halfcone(double       baseheight,
                               const Vec3d &pt    = Vec3d::Zero(),
                               size_t       steps = 45);
 
-indexed_triangle_set get_mesh(const Head &h, size_t steps);
-
-inline indexed_triangle_set get_mesh(const Pillar &p, size_t steps)
+// Size of the mesh of a support tree element
+struct MeshSize
 {
-    if(p.height > EPSILON) { // Endpoint is below the starting point
-        // We just create a bridge geometry with the pillar parameters and
-        // move the data.
-        //return cylinder(p.r_start, p.height, steps, p.endpoint());
-        return halfcone(p.height, p.r_end, p.r_start, p.endpt, steps);
-    }
-
-    return {};
-}
-
-inline indexed_triangle_set get_mesh(const Pedestal &p, size_t steps)
+    size_t vertices = 0;
+    size_t indices  = 0;
+};
+
+// Window into the preallocated buffers of a merged mesh, where the mesh of an
+// element is to be written. vertex_offset is the index of the first vertex
+// of the window in the merged mesh.
+struct MeshSpan
 {
-    return halfcone(p.height, p.r_bottom, p.r_top, p.pos, steps);
-}
-
-inline indexed_triangle_set get_mesh(const Junction &j, size_t steps)
+    Vec3f                       *vertices;
+    stl_triangle_vertex_indices *indices;
+    int                          vertex_offset;
+};
+
+// Produces the meshes of the support tree elements as instances of template
+// meshes. The unit sphere, the unit cylinder and the ring of the half cones
+// are only tessellated once per detail level and shared by all the meshers,
+// the pinheads once per head dimensions. With mesh_size() and write(), the
+// meshes of many elements can be merged into preallocated buffers without
+// an intermediate mesh per element.
+class ElementMesher
 {
-    indexed_triangle_set mesh = sphere(j.r, make_portion(0, PI), 2 * PI / steps);
-    Vec3f pos = j.pos.cast<float>();
-    for(auto& p : mesh.vertices) p += pos;
-    return mesh;
-}
+public:
+    explicit ElementMesher(size_t steps);
+
+    // Not thread safe for heads, the template of new head dimensions is
+    // created here.
+    MeshSize mesh_size(const Head &h);
+    MeshSize mesh_size(const Pillar &p) const;
+    MeshSize mesh_size(const Pedestal &p) const;
+    MeshSize mesh_size(const Junction &j) const;
+    MeshSize mesh_size(const Bridge &br) const;
+    MeshSize mesh_size(const DiffBridge &br) const;
+
+    // Thread safe. The span has to hold mesh_size() of the element, which
+    // has to be called before.
+    void write(const Head &h, const MeshSpan &out) const;
+    void write(const Pillar &p, const MeshSpan &out) const;
+    void write(const Pedestal &p, const MeshSpan &out) const;
+    void write(const Junction &j, const MeshSpan &out) const;
+    void write(const Bridge &br, const MeshSpan &out) const;
+    void write(const DiffBridge &br, const MeshSpan &out) const;
+
+private:
+    struct UnitMeshes;
+    using PinheadKey = std::array<double, 4>;
+
+    static std::shared_ptr<const UnitMeshes> unit_meshes(size_t steps);
+    static PinheadKey pinhead_key(const Head &h);
+
+    MeshSize halfcone_size(double baseheight, double r_bottom, double r_top) const;
+    void     write_halfcone(double baseheight, double r_bottom, double r_top, const Vec3d &pos, const MeshSpan &out) const;
+
+    size_t                                     m_steps;
+    std::shared_ptr<const UnitMeshes>          m_unit;
+    std::map<PinheadKey, indexed_triangle_set> m_pinheads;
+};
 
+indexed_triangle_set get_mesh(const Head &h, size_t steps);
+indexed_triangle_set get_mesh(const Pillar &p, size_t steps);
+indexed_triangle_set get_mesh(const Pedestal &p, size_t steps);
+indexed_triangle_set get_mesh(const Junction &j, size_t steps);
 indexed_triangle_set get_mesh(const Bridge &br, size_t steps);
-
 indexed_triangle_set get_mesh(const DiffBridge &br, size_t steps);
 
 }} // namespace Slic3r::sla
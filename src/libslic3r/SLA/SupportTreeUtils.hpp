@@ -166,29 +166,43 @@ Hit beam_mesh_hit(Ex policy,
     // Hit results
     std::array<Hit, RayCount> hits;
 
+    // The rays are cast in packets, which share the traversal of the AABB tree.
+    constexpr size_t PacketSize  = AABBMesh::RayPacketSize;
+    constexpr size_t PacketCount = (RayCount + PacketSize - 1) / PacketSize;
+
     execution::for_each(
-        policy, size_t(0), hits.size(),
-        [&mesh, r_src, r_dst, src, dst, &ring, dir, sd, &hits](size_t i) {
-            Hit &hit = hits[i];
-
-            // Point on the circle on the pin sphere
-            Vec3d p_src = ring.get(i, src, r_src + sd);
-            Vec3d p_dst = ring.get(i, dst, r_dst + sd);
-            Vec3d raydir = (p_dst - p_src).normalized();
-
-            auto hr = mesh.query_ray_hit(p_src + r_src * raydir, raydir);
-
-            if (hr.is_inside()) {
-                if (hr.distance() > 2 * r_src + sd)
-                    hit = Hit(0.0);
-                else {
-                    // re-cast the ray from the outside of the object
-                    auto q = p_src + (hr.distance() + EPSILON) * raydir;
-                    hit = mesh.query_ray_hit(q, raydir);
-                }
-            } else
-                hit = hr;
-        }, std::min(execution::max_concurrency(policy), RayCount));
+        policy, size_t(0), PacketCount,
+        [&mesh, r_src, r_dst, src, dst, &ring, sd, &hits](size_t packet) {
+            size_t first = packet * PacketSize;
+            size_t count = std::min(RayCount - first, AABBMesh::RayPacketSize);
+
+            AABBMesh::RayPacketPoints p_src, sources, raydirs;
+            for (size_t k = 0; k < count; ++k) {
+                // Point on the circle on the pin sphere
+                p_src[k] = ring.get(first + k, src, r_src + sd);
+                Vec3d p_dst = ring.get(first + k, dst, r_dst + sd);
+                raydirs[k] = (p_dst - p_src[k]).normalized();
+                sources[k] = p_src[k] + r_src * raydirs[k];
+            }
+
+            AABBMesh::RayPacketHits hrs = mesh.query_ray_hit_packet(sources, raydirs, count);
+
+            for (size_t k = 0; k < count; ++k) {
+                Hit &hit = hits[first + k];
+                const Hit &hr = hrs[k];
+
+                if (hr.is_inside()) {
+                    if (hr.distance() > 2 * r_src + sd)
+                        hit = Hit(0.0);
+                    else {
+                        // re-cast the ray from the outside of the object
+                        auto q = p_src[k] + (hr.distance() + EPSILON) * raydirs[k];
+                        hit = mesh.query_ray_hit(q, raydirs[k]);
+                    }
+                } else
+                    hit = hr;
+            }
+        }, std::min(execution::max_concurrency(policy), PacketCount));
 
     return min_hit(hits.begin(), hits.end());
 }
@@ -233,14 +247,25 @@ Hit pinhead_mesh_hit(Ex              ex,
     // of the pinhead robe (side) surface. The result will be the smallest
     // hit distance.
 
-    execution::for_each(
-        ex, size_t(0), hits.size(), [&m, &rings, sd, &hits](size_t i) {
-            // Point on the circle on the pin sphere
-            Vec3d ps = rings.pinring(i);
-            // This is the point on the circle on the back sphere
-            Vec3d p = rings.backring(i);
+    // The rays are cast in packets, which share the traversal of the AABB tree.
+    constexpr size_t PacketSize  = AABBMesh::RayPacketSize;
+    constexpr size_t PacketCount = (SAMPLES + PacketSize - 1) / PacketSize;
 
-            auto &hit = hits[i];
+    execution::for_each(
+        ex, size_t(0), PacketCount, [&m, &rings, sd, &hits](size_t packet) {
+            size_t first = packet * PacketSize;
+            size_t count = std::min(SAMPLES - first, AABBMesh::RayPacketSize);
+
+            AABBMesh::RayPacketPoints pss, sources, ns;
+            for (size_t k = 0; k < count; ++k) {
+                // Point on the circle on the pin sphere
+                pss[k] = rings.pinring(first + k);
+                // This is the point on the circle on the back sphere
+                Vec3d p = rings.backring(first + k);
+
+                ns[k] = (p - pss[k]).normalized();
+                sources[k] = pss[k] + sd * ns[k];
+            }
 
                // Point ps is not on mesh but can be inside or
                // outside as well. This would cause many problems
@@ -248,33 +273,37 @@ Hit pinhead_mesh_hit(Ex              ex,
                // use the ray-casting result (which has an is_inside
                // predicate).
 
-            Vec3d n = (p - ps).normalized();
-            auto  q = m.query_ray_hit(ps + sd * n, n);
-
-            if (q.is_inside()) { // the hit is inside the model
-                if (q.distance() > rings.rpin) {
-                    // If we are inside the model and the hit
-                    // distance is bigger than our pin circle
-                    // diameter, it probably indicates that the
-                    // support point was already inside the
-                    // model, or there is really no space
-                    // around the point. We will assign a zero
-                    // hit distance to these cases which will
-                    // enforce the function return value to be
-                    // an invalid ray with zero hit distance.
-                    // (see min_element at the end)
-                    hit = HitResult(0.0);
-                } else {
-                    // re-cast the ray from the outside of the
-                    // object. The starting point has an offset
-                    // of 2*safety_distance because the
-                    // original ray has also had an offset
-                    auto q2 = m.query_ray_hit(ps + (q.distance() + 2 * sd) * n, n);
-                    hit     = q2;
-                }
-            } else
-                hit = q;
-        }, std::min(execution::max_concurrency(ex), SAMPLES));
+            AABBMesh::RayPacketHits qs = m.query_ray_hit_packet(sources, ns, count);
+
+            for (size_t k = 0; k < count; ++k) {
+                auto &hit = hits[first + k];
+                const auto &q = qs[k];
+
+                if (q.is_inside()) { // the hit is inside the model
+                    if (q.distance() > rings.rpin) {
+                        // If we are inside the model and the hit
+                        // distance is bigger than our pin circle
+                        // diameter, it probably indicates that the
+                        // support point was already inside the
+                        // model, or there is really no space
+                        // around the point. We will assign a zero
+                        // hit distance to these cases which will
+                        // enforce the function return value to be
+                        // an invalid ray with zero hit distance.
+                        // (see min_element at the end)
+                        hit = HitResult(0.0);
+                    } else {
+                        // re-cast the ray from the outside of the
+                        // object. The starting point has an offset
+                        // of 2*safety_distance because the
+                        // original ray has also had an offset
+                        auto q2 = m.query_ray_hit(pss[k] + (q.distance() + 2 * sd) * ns[k], ns[k]);
+                        hit     = q2;
+                    }
+                } else
+                    hit = q;
+            }
+        }, std::min(execution::max_concurrency(ex), PacketCount));
 
     return min_hit(hits.begin(), hits.end());
 }
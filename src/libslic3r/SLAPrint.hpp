@@ -354,6 +354,10 @@ private:
         inline SupportData(const indexed_triangle_set &t)
             : input{t, {}, {}}
         {}
+
+        inline SupportData(const std::shared_ptr<const indexed_triangle_set> &t)
+            : input{t, {}, {}}
+        {}
         
         void create_support_tree(const sla::JobController &ctl)
         {
@@ -386,11 +390,20 @@ private:
     // or an approximation of that.
     std::array<std::shared_ptr<const indexed_triangle_set>, SLAPrintObjectStep::slaposCount + 1> m_preview_meshes;
 
+    // Kept until the model changes (slaposAssembly), so that editing the
+    // hollowing parameters or the drain holes does not need to voxelize the
+    // model again.
     class HollowingData
     {
     public:
 
-        sla::InteriorPtr interior;
+        // Distance field of the model and the voxel scale it was made with
+        VoxelGridPtr grid;
+        double       voxel_scale = 0.;
+
+        // Interior generated from grid and the parameters it was made with
+        sla::InteriorPtr      interior;
+        sla::HollowingConfig  interior_config;
     };
     
     std::unique_ptr<HollowingData> m_hollowing_data;
@@ -325,13 +325,13 @@ void SLAPrint::Steps::mesh_assembly(SLAPrintObject &po)
 
 void SLAPrint::Steps::hollow_model(SLAPrintObject &po)
 {
-    po.m_hollowing_data.reset();
     po.m_supportdata.reset();
     clear_csg(po.m_mesh_to_slice, slaposDrillHoles);
     clear_csg(po.m_mesh_to_slice, slaposHollowing);
 
     if (! po.m_config.hollowing_enable.getBool()) {
         BOOST_LOG_TRIVIAL(info) << "Skipping hollowing step!";
+        po.m_hollowing_data.reset();
         return;
     }
 
@@ -341,30 +341,77 @@ void SLAPrint::Steps::hollow_model(SLAPrintObject &po)
     double quality  = po.m_config.hollowing_quality.getFloat();
     double closing_d = po.m_config.hollowing_closing_distance.getFloat();
     sla::HollowingConfig hlwcfg{thickness, quality, closing_d};
+    hlwcfg.max_tile_voxels = size_t(po.m_config.hollowing_tile_voxels.getInt()) * 1000000;
     sla::JobController ctl;
     ctl.stopcondition = [this]() { return canceled(); };
     ctl.cancelfn = [this]() { throw_if_canceled(); };
 
-    sla::InteriorPtr interior =
-        generate_interior(po.mesh_to_slice(), hlwcfg, ctl);
-
-    if (!interior || sla::get_mesh(*interior).empty())
-        BOOST_LOG_TRIVIAL(warning) << "Hollowed interior is empty!";
-    else {
+    if (!po.m_hollowing_data)
         po.m_hollowing_data.reset(new SLAPrintObject::HollowingData());
-        po.m_hollowing_data->interior = std::move(interior);
 
-        indexed_triangle_set &m = sla::get_mesh(*po.m_hollowing_data->interior);
+    SLAPrintObject::HollowingData &hdata = *po.m_hollowing_data;
+
+    // The distance field of the model only depends on the voxel scale,
+    // which does not change with the closing distance, for example.
+    double mesh_vol = sla::csgmesh_positive_maxvolume(po.mesh_to_slice());
+    double voxsc    = sla::get_voxel_scale(mesh_vol, hlwcfg);
+
+    // The tiled hollowing voxelizes the model slab by slab, there is no grid
+    // of the whole model to keep.
+    bool tiled = hlwcfg.max_tile_voxels > 0;
+
+    if (tiled) {
+        hdata.grid.reset();
+    } else if (!hdata.grid || hdata.voxel_scale != voxsc) {
+        hdata.interior.reset();
+        hdata.grid = sla::voxelize_for_hollowing(po.mesh_to_slice(), voxsc, ctl);
+        hdata.voxel_scale = voxsc;
+    } else {
+        BOOST_LOG_TRIVIAL(debug) << "Hollowing: reusing the voxelized model";
+    }
+
+    const sla::HollowingConfig &icfg = hdata.interior_config;
+    bool same_config = icfg.min_thickness == hlwcfg.min_thickness &&
+                       icfg.quality == hlwcfg.quality &&
+                       icfg.closing_distance == hlwcfg.closing_distance &&
+                       icfg.max_tile_voxels == hlwcfg.max_tile_voxels;
+
+    if (hdata.interior && same_config) {
+        BOOST_LOG_TRIVIAL(debug) << "Hollowing: reusing the interior";
+    } else {
+        hdata.interior.reset();
 
-        if (!m.empty()) {
-            // simplify mesh lossless
-            float loss_less_max_error = 2*std::numeric_limits<float>::epsilon();
-            its_quadric_edge_collapse(m, 0U, &loss_less_max_error);
+        if (tiled)
+            hdata.interior = sla::generate_interior_tiled(po.mesh_to_slice(), hlwcfg, ctl);
+        else if (hdata.grid)
+            hdata.interior = sla::generate_interior(*hdata.grid, hlwcfg, ctl);
 
-            its_compactify_vertices(m);
-            its_merge_vertices(m);
+        // Canceled, nothing usable for the next run
+        if (canceled())
+            hdata.grid.reset();
+
+        if (hdata.interior) {
+            indexed_triangle_set &m = sla::get_mesh(*hdata.interior);
+
+            if (!m.empty()) {
+                // simplify mesh lossless
+                float loss_less_max_error = 2*std::numeric_limits<float>::epsilon();
+                its_quadric_edge_collapse(m, 0U, &loss_less_max_error);
+
+                its_compactify_vertices(m);
+                its_merge_vertices(m);
+            }
         }
 
+        hdata.interior_config = hlwcfg;
+    }
+
+    if (!hdata.interior || sla::get_mesh(*hdata.interior).empty()) {
+        BOOST_LOG_TRIVIAL(warning) << "Hollowed interior is empty!";
+        hdata.interior.reset();
+    } else {
+        const indexed_triangle_set &m = sla::get_mesh(*hdata.interior);
+
         // Put the interior into the target mesh as a negative
         po.m_mesh_to_slice
             .emplace(slaposHollowing,
@@ -387,9 +434,8 @@ void SLAPrint::Steps::drill_holes(SLAPrintObject &po)
 
     generate_preview(po, slaposDrillHoles);
 
-    // Release the data, won't be needed anymore, takes huge amount of ram
-    if (po.m_hollowing_data && po.m_hollowing_data->interior)
-        po.m_hollowing_data->interior.reset();
+    // The interior is kept for the next edit of the drain holes, it is
+    // released with the hollowing data when the model changes.
 }
 
 template<class Pred>
@@ -588,7 +634,7 @@ void SLAPrint::Steps::support_points(SLAPrintObject &po)
         auto &meshp = po.get_mesh_to_print();
         assert(meshp);
         po.m_supportdata =
-            std::make_unique<SLAPrintObject::SupportData>(*meshp);
+            std::make_unique<SLAPrintObject::SupportData>(meshp);
     }
 
     po.m_supportdata->input.zoffset = csgmesh_positive_bb(po.m_mesh_to_slice)
@@ -735,7 +781,7 @@ void SLAPrint::Steps::generate_pad(SLAPrintObject &po) {
             auto &meshp = po.get_mesh_to_print();
             assert(meshp);
             po.m_supportdata =
-                std::make_unique<SLAPrintObject::SupportData>(*meshp);
+                std::make_unique<SLAPrintObject::SupportData>(meshp);
         }
 
         // Get the distilled pad configuration from the config
@@ -1123,16 +1169,22 @@ void SLAPrint::Steps::rasterize()
 
     execution::SpinningMutex<ExecutionTBB> slck;
 
-    // procedure to process one height level. This will run in parallel
+    const std::vector<PrintLayer> &printer_input = m_print->m_printer_input;
+
+    // procedure to process one height level. This will run in parallel.
+    // Consecutive layers tend to be very similar, thus only the difference
+    // from the previous layer's raster is drawn if there is one.
     auto lvlfn =
-        [this, &slck, increment, &dstatus, &pst]
-        (sla::RasterBase& raster, size_t idx)
+        [this, &printer_input, &slck, increment, &dstatus, &pst]
+        (sla::RasterBase& raster, const sla::RasterBase *prev, size_t idx)
     {
-        PrintLayer& printlayer = m_print->m_printer_input[idx];
-        if(canceled()) return;
+        const PrintLayer& printlayer = printer_input[idx];
+        if(canceled()) return false;
 
-        for (const ExPolygon& poly : printlayer.transformed_slices())
-            raster.draw(poly);
+        sla::LayerDelta delta =
+            prev ? sla::draw_layer(raster, printlayer.transformed_slices(), prev,
+                                   printer_input[idx - 1].transformed_slices()) :
+                   sla::draw_layer(raster, printlayer.transformed_slices());
 
         // Status indication guarded with the spinlock
         {
@@ -1144,14 +1196,16 @@ void SLAPrint::Steps::rasterize()
                 pst = st;
             }
         }
+
+        return delta == sla::LayerDelta::Unchanged;
     };
 
     // last minute escape
     if(canceled()) return;
 
     // Print all the layers in parallel
-    m_print->m_archiver->draw_layers(m_print->m_printer_input.size(), lvlfn,
-                                    [this]() { return canceled(); }, ex_tbb);
+    m_print->m_archiver->draw_layers_incremental(printer_input.size(), lvlfn,
+                                                [this]() { return canceled(); }, ex_tbb);
 }
 
 std::string SLAPrint::Steps::label(SLAPrintObjectStep step)
@@ -105,6 +105,8 @@ TreeModelVolumes::TreeModelVolumes(
         m_increase_until_radius = config.increase_radius_until_radius;
         m_radius_0 = config.getRadius(0);
         m_raft_layers = config.raft_layers;
+        m_radius_quantization = std::max(SUPPORT_TREE_EXPONENTIAL_FACTOR, mesh_settings.support_tree_radius_quantization);
+        m_cache_memory_budget = mesh_settings.support_tree_cache_memory_budget;
         m_current_outline_idx = 0;
 
         m_layer_outlines.emplace_back(mesh_settings, std::vector<Polygons>{});
@@ -253,6 +255,7 @@ void TreeModelVolumes::precalculate(const PrintObject& print_object, const coord
 
 //    m_precalculated = true;
     BOOST_LOG_TRIVIAL(info) << "Precalculating collision took" << dur_col << " ms. Precalculating avoidance took " << dur_avo << " ms.";
+    this->shrink_caches_to_budget();
 
 #if 0
     // Paint caches into SVGs:
@@ -297,7 +300,7 @@ const Polygons& TreeModelVolumes::getCollision(const coord_t orig_radius, LayerI
     const coord_t radius = this->ceilRadius(orig_radius, min_xy_dist);
     if (std::optional<std::reference_wrapper<const Polygons>> result = m_collision_cache.getArea({ radius, layer_idx }); result)
         return (*result).get();
-    if (m_precalculated) {
+    if (m_precalculated && ! m_cache_shrunk) {
         BOOST_LOG_TRIVIAL(error_level_not_in_cache) << "Had to calculate collision at radius " << radius << " and layer " << layer_idx << ", but precalculate was called. Performance may suffer!";
         tree_supports_show_error("Not precalculated Collision requested."sv, false);
     }
@@ -320,7 +323,7 @@ const Polygons& TreeModelVolumes::getCollisionHolefree(coord_t radius, LayerInde
     assert(radius < m_increase_until_radius + m_current_min_xy_dist_delta);
     if (std::optional<std::reference_wrapper<const Polygons>> result = m_collision_cache_holefree.getArea({ radius, layer_idx }); result)
         return (*result).get();
-    if (m_precalculated) {
+    if (m_precalculated && ! m_cache_shrunk) {
         BOOST_LOG_TRIVIAL(error_level_not_in_cache) << "Had to calculate collision holefree at radius " << radius << " and layer " << layer_idx << ", but precalculate was called. Performance may suffer!";
         tree_supports_show_error("Not precalculated Holefree Collision requested."sv, false);
     }
@@ -343,7 +346,7 @@ const Polygons& TreeModelVolumes::getAvoidance(const coord_t orig_radius, LayerI
         result)
         return (*result).get();
 
-    if (m_precalculated) {
+    if (m_precalculated && ! m_cache_shrunk) {
         if (to_model) {
             BOOST_LOG_TRIVIAL(error_level_not_in_cache) << "Had to calculate Avoidance to model at radius " << radius << " and layer " << layer_idx << ", but precalculate was called. Performance may suffer!";
             tree_supports_show_error("Not precalculated Avoidance(to model) requested."sv, false);
@@ -362,7 +365,7 @@ const Polygons& TreeModelVolumes::getPlaceableAreas(const coord_t orig_radius, L
     const coord_t radius = ceilRadius(orig_radius);
     if (std::optional<std::reference_wrapper<const Polygons>> result = m_placeable_areas_cache.getArea({ radius, layer_idx }); result)
         return (*result).get();
-    if (m_precalculated) {
+    if (m_precalculated && ! m_cache_shrunk) {
         BOOST_LOG_TRIVIAL(error_level_not_in_cache) << "Had to calculate Placeable Areas at radius " << radius << " and layer " << layer_idx << ", but precalculate was called. Performance may suffer!";
         tree_supports_show_error(format("Not precalculated Placeable areas requested, radius %1%, layer %2%", radius, layer_idx), false);
     }
@@ -389,7 +392,7 @@ const Polygons& TreeModelVolumes::getWallRestriction(const coord_t orig_radius,
         (min_xy_dist ? m_wall_restrictions_cache_min : m_wall_restrictions_cache).getArea({ radius, layer_idx });
         result)
         return (*result).get();
-    if (m_precalculated) {
+    if (m_precalculated && ! m_cache_shrunk) {
         BOOST_LOG_TRIVIAL(error_level_not_in_cache) << "Had to calculate Wall restricions at radius " << radius << " and layer " << layer_idx << ", but precalculate was called. Performance may suffer!";
         tree_supports_show_error(
             min_xy_dist ? 
@@ -427,7 +430,7 @@ void TreeModelVolumes::calculateCollision(const coord_t radius, const LayerIndex
 
     // Layer range for which the collisions will be calculated.
     LayerPolygonCache           data;
-    data.allocate(m_collision_cache.getMaxCalculatedLayer(radius) + 1, max_layer_idx + 1);
+    data.allocate(m_collision_cache.getMaxCalculatedLayer(radius, max_layer_idx) + 1, max_layer_idx + 1);
 
     const bool                  calculate_placable = m_support_rests_on_model && radius == 0;
     LayerPolygonCache           data_placeable;
@@ -634,7 +637,7 @@ void TreeModelVolumes::calculateAvoidance(const std::vector<RadiusLayerPair> &ke
             ((iter_idx / 3) & 1) != 0  // to_model
         };
         // Ensure start_layer is at least 1 as if no avoidance was calculated yet getMaxCalculatedLayer() returns -1.
-        task.start_layer = std::max<LayerIndex>(1, 1 + avoidance_cache(task.type, task.to_model).getMaxCalculatedLayer(task.radius));
+        task.start_layer = std::max<LayerIndex>(1, 1 + avoidance_cache(task.type, task.to_model).getMaxCalculatedLayer(task.radius, task.max_required_layer));
         if (task.start_layer > task.max_required_layer) {
             BOOST_LOG_TRIVIAL(debug) << "Calculation requested for value already calculated?";
             continue;
@@ -719,7 +722,7 @@ void TreeModelVolumes::calculatePlaceables(const std::vector<RadiusLayerPair> &k
 
 void TreeModelVolumes::calculatePlaceables(const coord_t radius, const LayerIndex max_required_layer, std::function<void()> throw_on_cancel)
 {
-    LayerIndex start_layer = 1 + m_placeable_areas_cache.getMaxCalculatedLayer(radius);
+    LayerIndex start_layer = 1 + m_placeable_areas_cache.getMaxCalculatedLayer(radius, max_required_layer);
     if (start_layer > max_required_layer) {
         BOOST_LOG_TRIVIAL(debug) << "Requested calculation for value already calculated ?";
         return;
@@ -796,7 +799,7 @@ void TreeModelVolumes::calculateWallRestrictions(const std::vector<RadiusLayerPa
         for (size_t key_idx = range.begin(); key_idx < range.end(); ++ key_idx) {
             const coord_t    radius             = keys[key_idx].first;
             const LayerIndex max_required_layer = keys[key_idx].second;
-            const coord_t    min_layer_bottom   = std::max(1, m_wall_restrictions_cache.getMaxCalculatedLayer(radius));
+            const coord_t    min_layer_bottom   = std::max(1, m_wall_restrictions_cache.getMaxCalculatedLayer(radius, max_required_layer));
             const size_t     buffer_size        = max_required_layer + 1 - min_layer_bottom;
             std::vector<Polygons> data(buffer_size, Polygons{});
             std::vector<Polygons> data_min;
@@ -846,33 +849,198 @@ coord_t TreeModelVolumes::ceilRadius(const coord_t radius) const
         } else
             out += SUPPORT_TREE_COLLISION_RESOLUTION;
         while (out < radius || ignore(out)) {
-            assert(out * SUPPORT_TREE_EXPONENTIAL_FACTOR > out + SUPPORT_TREE_COLLISION_RESOLUTION);
-            out = out * SUPPORT_TREE_EXPONENTIAL_FACTOR;
+            assert(out * m_radius_quantization > out + SUPPORT_TREE_COLLISION_RESOLUTION);
+            out = out * m_radius_quantization;
         }
     }
     return out;
 }
 
+TreeModelVolumes::RadiusLayerPolygonCache& TreeModelVolumes::RadiusLayerPolygonCache::operator=(RadiusLayerPolygonCache &&rhs)
+{
+    this->clear();
+    for (size_t i = 0; i < MaxChunks; ++ i)
+        m_chunks[i].store(rhs.m_chunks[i].exchange(nullptr));
+    m_num_layers.store(rhs.m_num_layers.exchange(0));
+    m_hits.store(rhs.m_hits.exchange(0));
+    m_misses.store(rhs.m_misses.exchange(0));
+    m_waits.store(rhs.m_waits.exchange(0));
+    m_memory.store(rhs.m_memory.exchange(0));
+    m_epoch.store(rhs.m_epoch.load());
+    return *this;
+}
+
 void TreeModelVolumes::RadiusLayerPolygonCache::allocate_layers(size_t num_layers)
 {
-    if (num_layers > m_data.size()) {
-        if (num_layers > m_data.capacity())
-            reserve_power_of_2(m_data, num_layers);
-        m_data.resize(num_layers, {});
+    if (LayerIndex(num_layers) <= m_num_layers.load(std::memory_order_acquire))
+        return;
+    if (num_layers > MaxChunks * LayersPerChunk)
+        throw RuntimeError("Tree supports: Too many layers");
+    for (size_t ichunk = 0; ichunk * LayersPerChunk < num_layers; ++ ichunk)
+        if (m_chunks[ichunk].load(std::memory_order_acquire) == nullptr) {
+            // Another thread may be allocating the same chunk, the first one wins.
+            auto     chunk    = std::make_unique<Chunk>();
+            Chunk   *expected = nullptr;
+            if (m_chunks[ichunk].compare_exchange_strong(expected, chunk.get(), std::memory_order_acq_rel))
+                chunk.release();
+        }
+    // Publish the new layers after their chunks.
+    for (LayerIndex cur = m_num_layers.load(std::memory_order_acquire);
+         cur < LayerIndex(num_layers) && ! m_num_layers.compare_exchange_weak(cur, LayerIndex(num_layers), std::memory_order_acq_rel);)
+        ;
+}
+
+static size_t polygons_memsize(const Polygons &polygons)
+{
+    size_t out = polygons.capacity() * sizeof(Polygon);
+    for (const Polygon &polygon : polygons)
+        out += polygon.points.capacity() * sizeof(Point);
+    return out;
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::emplace(Layer &layer, coord_t radius, Polygons &&polygons)
+{
+    size_t memory = polygons_memsize(polygons);
+    auto   lock   = this->lock_layer(layer);
+    if (layer.data.emplace(radius, std::move(polygons)).second) {
+        layer.memory += memory;
+        m_memory.fetch_add(memory, std::memory_order_relaxed);
     }
+    this->touch(layer);
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::clear()
+{
+    m_num_layers.store(0);
+    m_memory.store(0);
+    for (std::atomic<Chunk*> &chunk : m_chunks)
+        delete chunk.exchange(nullptr);
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::clear_all_but_radius0()
+{
+    for (LayerIndex layer_idx = 0; layer_idx < m_num_layers.load(); ++ layer_idx)
+        this->release_layer(layer_idx, true);
+}
+
+size_t TreeModelVolumes::RadiusLayerPolygonCache::release_layer(LayerIndex layer_idx, bool keep_smallest_radius)
+{
+    Layer     &layer = *this->layer(layer_idx);
+    LayerData &l     = layer.data;
+    auto       begin = l.begin();
+    auto       end   = l.end();
+    if (keep_smallest_radius && begin != end)
+        ++ begin;
+    if (begin == end)
+        return 0;
+    l.erase(begin, end);
+    size_t memory = l.empty() ? 0 : polygons_memsize(l.begin()->second);
+    size_t released = layer.memory - memory;
+    layer.memory = memory;
+    m_memory.fetch_sub(released, std::memory_order_relaxed);
+    return released;
 }
 
 // For debugging purposes, sorted by layer index, then by radius.
 std::vector<std::pair<TreeModelVolumes::RadiusLayerPair, std::reference_wrapper<const Polygons>>> TreeModelVolumes::RadiusLayerPolygonCache::sorted() const
 {
     std::vector<std::pair<RadiusLayerPair, std::reference_wrapper<const Polygons>>> out;
-    for (auto &layer : m_data) {
-        auto layer_idx = LayerIndex(&layer - m_data.data());
-        for (auto &radius_polygons : layer)
+    for (LayerIndex layer_idx = 0; layer_idx < m_num_layers.load(); ++ layer_idx)
+        for (auto &radius_polygons : this->layer(layer_idx)->data)
             out.emplace_back(std::make_pair(radius_polygons.first, layer_idx), radius_polygons.second);
-    }
     assert(std::is_sorted(out.begin(), out.end(), [](auto &l, auto &r){ return l.first.second < r.first.second || (l.first.second == r.first.second) && l.first.first < r.first.first; }));
     return out;
 }
 
+void TreeModelVolumes::log_cache_stats() const
+{
+    auto log = [](const RadiusLayerPolygonCache &cache, std::string_view name) {
+#ifdef SUPPORT_TREE_CACHE_STATS
+        RadiusLayerPolygonCache::Stats stats = cache.stats();
+        BOOST_LOG_TRIVIAL(debug) << "Tree supports: cache " << name << ": " << stats.hits << " hits, " << stats.misses << " misses, " << stats.waits << " waits for a lock, " <<
+            cache.memory() / (1024 * 1024) << " MB";
+#else // SUPPORT_TREE_CACHE_STATS
+        BOOST_LOG_TRIVIAL(debug) << "Tree supports: cache " << name << ": " << cache.memory() / (1024 * 1024) << " MB";
+#endif // SUPPORT_TREE_CACHE_STATS
+    };
+    log(m_collision_cache,                   "collision"sv);
+    log(m_collision_cache_holefree,          "collision_holefree"sv);
+    log(m_avoidance_cache,                   "avoidance"sv);
+    log(m_avoidance_cache_slow,              "avoidance_slow"sv);
+    log(m_avoidance_cache_to_model,          "avoidance_to_model"sv);
+    log(m_avoidance_cache_to_model_slow,     "avoidance_to_model_slow"sv);
+    log(m_placeable_areas_cache,             "placeable_areas"sv);
+    log(m_avoidance_cache_holefree,          "avoidance_holefree"sv);
+    log(m_avoidance_cache_holefree_to_model, "avoidance_holefree_to_model"sv);
+    log(m_wall_restrictions_cache,           "wall_restrictions"sv);
+    log(m_wall_restrictions_cache_min,       "wall_restrictions_min"sv);
+    if (m_cache_memory_budget > 0)
+        BOOST_LOG_TRIVIAL(debug) << "Tree supports: peak memory of the caches " << m_cache_memory_peak / (1024 * 1024) << " MB, budget " << m_cache_memory_budget / (1024 * 1024) << " MB";
+}
+
+size_t TreeModelVolumes::cache_memory() const
+{
+    return m_collision_cache.memory() + m_collision_cache_holefree.memory() + m_avoidance_cache.memory() + m_avoidance_cache_slow.memory() +
+        m_avoidance_cache_to_model.memory() + m_avoidance_cache_to_model_slow.memory() + m_placeable_areas_cache.memory() +
+        m_avoidance_cache_holefree.memory() + m_avoidance_cache_holefree_to_model.memory() +
+        m_wall_restrictions_cache.memory() + m_wall_restrictions_cache_min.memory();
+}
+
+void TreeModelVolumes::shrink_caches_to_budget()
+{
+    if (m_cache_memory_budget == 0)
+        return;
+
+    struct Cache {
+        RadiusLayerPolygonCache *cache;
+        // Radius zero collisions and placeables are expected to be always available, see get_collision_lower_bound_area() and getPlaceableAreas().
+        bool                     keep_smallest_radius;
+    };
+    // Collision holefree is not released, it would be recalculated from the first layer.
+    const Cache caches[] {
+        { &m_collision_cache,                   true  },
+        { &m_placeable_areas_cache,             true  },
+        { &m_avoidance_cache,                   false },
+        { &m_avoidance_cache_slow,              false },
+        { &m_avoidance_cache_to_model,          false },
+        { &m_avoidance_cache_to_model_slow,     false },
+        { &m_avoidance_cache_holefree,          false },
+        { &m_avoidance_cache_holefree_to_model, false },
+        { &m_wall_restrictions_cache,           false },
+        { &m_wall_restrictions_cache_min,       false },
+    };
+
+    size_t memory = this->cache_memory();
+    m_cache_memory_peak = std::max(m_cache_memory_peak, memory);
+
+    if (memory > m_cache_memory_budget) {
+        struct Candidate {
+            const Cache *cache;
+            LayerIndex   layer_idx;
+            uint32_t     last_use;
+        };
+        std::vector<Candidate> candidates;
+        for (const Cache &c : caches)
+            c.cache->foreach_layer_last_use([&c, &candidates](LayerIndex layer_idx, uint32_t last_use) {
+                if (layer_idx % SUPPORT_TREE_CACHE_CHECKPOINT_INTERVAL != 0)
+                    candidates.push_back({ &c, layer_idx, last_use });
+            });
+        // Least recently used first. Of the layers used at the same time, the lower ones first, as the tree supports are grown top down.
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate &l, const Candidate &r) {
+            return l.last_use < r.last_use || (l.last_use == r.last_use && l.layer_idx < r.layer_idx);
+        });
+        size_t released = 0;
+        for (const Candidate &c : candidates) {
+            if (memory - released <= m_cache_memory_budget)
+                break;
+            released += c.cache->cache->release_layer(c.layer_idx, c.cache->keep_smallest_radius);
+        }
+        m_cache_shrunk |= released > 0;
+        BOOST_LOG_TRIVIAL(debug) << "Tree supports: released " << released / (1024 * 1024) << " MB of " << memory / (1024 * 1024) << " MB of the caches";
+    }
+
+    for (const Cache &c : caches)
+        c.cache->next_epoch();
+}
+
 } // namespace Slic3r::FFFTreeSupport
@@ -13,11 +13,16 @@
 #ifndef slic3r_TreeModelVolumes_hpp
 #define slic3r_TreeModelVolumes_hpp
 
+#include <array>
+#include <atomic>
+#include <limits>
 #include <mutex>
 #include <unordered_map>
 
 #include <boost/functional/hash.hpp>
 
+#include <tbb/spin_mutex.h>
+
 #include "TreeSupportCommon.hpp"
 
 #include "../Point.hpp"
@@ -37,6 +42,12 @@ static constexpr const double  SUPPORT_TREE_EXPONENTIAL_FACTOR = 1.5;
 static constexpr const coord_t SUPPORT_TREE_EXPONENTIAL_THRESHOLD = scaled<coord_t>(1. * SUPPORT_TREE_EXPONENTIAL_FACTOR);
 static constexpr const coord_t SUPPORT_TREE_COLLISION_RESOLUTION = scaled<coord_t>(0.5);
 static constexpr const bool    SUPPORT_TREE_AVOID_SUPPORT_BLOCKER = true;
+// Layers of the caches, which are never released when shrinking the caches to the memory budget.
+// Avoidances are calculated bottom up, a released layer is recalculated from the closest layer kept below it.
+static constexpr const int     SUPPORT_TREE_CACHE_CHECKPOINT_INTERVAL = 16;
+// Count the hits, misses and lock waits of the caches, see TreeModelVolumes::log_cache_stats().
+// The counters are shared by all the threads looking into a cache, thus they are only counted in profiling builds.
+// #define SUPPORT_TREE_CACHE_STATS
 
 class TreeModelVolumes
 {
@@ -73,6 +84,19 @@ public:
         m_wall_restrictions_cache.clear();
         m_wall_restrictions_cache_min.clear();
     }
+    // Release the least recently used layers of the caches if the caches take more memory than
+    // TreeSupportMeshGroupSettings::support_tree_cache_memory_budget. The released layers are recalculated on demand
+    // starting from the layers kept, see SUPPORT_TREE_CACHE_CHECKPOINT_INTERVAL.
+    // Shall only be called when nobody holds a reference to the cached polygons, for example between processing of layers.
+    void shrink_caches_to_budget();
+    // Log memory of the caches, with SUPPORT_TREE_CACHE_STATS also the hit / miss / wait statistics.
+    void log_cache_stats() const;
+    // Memory of all the caches in bytes.
+    size_t cache_memory() const;
+    // Peak memory of the caches seen by shrink_caches_to_budget().
+    size_t cache_memory_peak() const { return m_cache_memory_peak; }
+    // Were some layers released by shrink_caches_to_budget()?
+    bool   cache_shrunk() const { return m_cache_shrunk; }
 
     enum class AvoidanceType : int8_t
     {
@@ -199,43 +223,65 @@ private:
      * \brief Convenience typedef for the keys to the caches
      */
     using RadiusLayerPair             = std::pair<coord_t, LayerIndex>;
+    // Cache of regions indexed by layer and radius, queried and filled in from parallel loops.
+    // To not serialize the threads on a single lock, the cache is sharded by layers: Each layer has its own lock,
+    // held for a map lookup or insertion only. The layers are allocated in chunks, which are published atomically
+    // and never moved, thus a layer is found without any global lock.
+    // Reference to Polygons returned is stable until clear() or clear_all_but_radius0(), which shall not be called
+    // concurrently with the other methods.
     class RadiusLayerPolygonCache {
         // Map from radius to Polygons. Cache of one layer collision regions.
         using LayerData = std::map<coord_t, Polygons>;
-        // Vector of layers, at each layer map of radius to Polygons.
-        // Reference to Polygons returned shall be stable to insertion.
-        using Layers = std::vector<LayerData>;
+        struct Layer {
+            // The critical sections are short, spinning is cheaper than putting the thread to sleep.
+            mutable tbb::spin_mutex         mutex;
+            LayerData                       data;
+            // Memory of the polygons in data.
+            size_t                          memory   { 0 };
+            // Epoch of the last lookup or insertion.
+            mutable std::atomic<uint32_t>   last_use { 0 };
+        };
+        static constexpr const size_t LayersPerChunk = 256;
+        static constexpr const size_t MaxChunks      = 1024;
+        struct Chunk {
+            std::array<Layer, LayersPerChunk> layers;
+        };
     public:
+        // Counters for profiling the cache, only counted with SUPPORT_TREE_CACHE_STATS defined.
+        struct Stats {
+            size_t hits   { 0 };
+            size_t misses { 0 };
+            // Number of lookups or insertions waiting for another thread accessing the same layer.
+            size_t waits  { 0 };
+        };
+
         RadiusLayerPolygonCache() = default;
-        RadiusLayerPolygonCache(RadiusLayerPolygonCache &&rhs) : m_data(std::move(rhs.m_data)) {}
-        RadiusLayerPolygonCache& operator=(RadiusLayerPolygonCache &&rhs) { m_data = std::move(rhs.m_data); return *this; }
+        ~RadiusLayerPolygonCache() { this->clear(); }
+        RadiusLayerPolygonCache(RadiusLayerPolygonCache &&rhs) { *this = std::move(rhs); }
+        RadiusLayerPolygonCache& operator=(RadiusLayerPolygonCache &&rhs);
 
         RadiusLayerPolygonCache(const RadiusLayerPolygonCache&) = delete;
         RadiusLayerPolygonCache& operator=(const RadiusLayerPolygonCache&) = delete;
 
         void insert(std::vector<std::pair<RadiusLayerPair, Polygons>> &&in) {
-            std::lock_guard<std::mutex> guard(m_mutex);
             for (auto &d : in)
-                this->get_allocate_layer_data(d.first.second).emplace(d.first.first, std::move(d.second));
+                this->emplace(this->get_allocate_layer(d.first.second), d.first.first, std::move(d.second));
         }
         // by layer
         void insert(std::vector<std::pair<coord_t, Polygons>> &&in, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
             for (auto &d : in)
-                this->get_allocate_layer_data(d.first).emplace(radius, std::move(d.second));
+                this->emplace(this->get_allocate_layer(d.first), radius, std::move(d.second));
         }
         void insert(std::vector<Polygons> &&in, coord_t first_layer_idx, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
             allocate_layers(first_layer_idx + in.size());
             for (auto &d : in)
-                m_data[first_layer_idx ++].emplace(radius, std::move(d));
+                this->emplace(*this->layer(first_layer_idx ++), radius, std::move(d));
         }
         void insert(LayerPolygonCache &&in, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
             LayerIndex i = in.begin();
             allocate_layers(i + LayerIndex(in.size()));
             for (auto &d : in.polygons_mutable())
-                m_data[i ++].emplace(radius, std::move(d));
+                this->emplace(*this->layer(i ++), radius, std::move(d));
         }
         /*!
          * \brief Checks a cache for a given RadiusLayerPair and returns it if it is found
@@ -243,72 +289,125 @@ private:
          * \return A wrapped optional reference of the requested area (if it was found, an empty optional if nothing was found)
          */
         std::optional<std::reference_wrapper<const Polygons>> getArea(const TreeModelVolumes::RadiusLayerPair &key) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            if (key.second >= LayerIndex(m_data.size()))
-                return std::optional<std::reference_wrapper<const Polygons>>{};
-            const auto &layer = m_data[key.second];
-            auto it = layer.find(key.first);
-            return it == layer.end() ? 
-                std::optional<std::reference_wrapper<const Polygons>>{} : std::optional<std::reference_wrapper<const Polygons>>{ it->second };
+            if (const Layer *layer = this->layer(key.second); layer) {
+                auto lock = this->lock_layer(*layer);
+                if (auto it = layer->data.find(key.first); it != layer->data.end()) {
+                    this->touch(*layer);
+                    count_event(m_hits);
+                    return std::optional<std::reference_wrapper<const Polygons>>{ it->second };
+                }
+            }
+            count_event(m_misses);
+            return std::optional<std::reference_wrapper<const Polygons>>{};
         }
         // Get a collision area at a given layer for a radius that is a lower or equial to the key radius.
         std::optional<std::pair<coord_t, std::reference_wrapper<const Polygons>>> get_lower_bound_area(const TreeModelVolumes::RadiusLayerPair &key) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            if (key.second >= LayerIndex(m_data.size()))
-                return {};
-            const auto &layer = m_data[key.second];
-            if (layer.empty())
-                return {};
-            auto it = layer.lower_bound(key.first);
-            if (it == layer.end() || it->first != key.first) {
-                if (it == layer.begin())
-                    return {};
-                -- it;
+            if (const Layer *layer = this->layer(key.second); layer) {
+                auto lock = this->lock_layer(*layer);
+                auto it = layer->data.lower_bound(key.first);
+                if (it == layer->data.end() || it->first != key.first) {
+                    if (it != layer->data.begin())
+                        -- it;
+                    else
+                        it = layer->data.end();
+                }
+                if (it != layer->data.end()) {
+                    this->touch(*layer);
+                    count_event(m_hits);
+                    return std::make_pair(it->first, std::reference_wrapper<const Polygons>(it->second));
+                }
             }
-            return std::make_pair(it->first, std::reference_wrapper<const Polygons>(it->second));
+            count_event(m_misses);
+            return {};
         }
         /*!
          * \brief Get the highest already calculated layer in the cache.
          * \param radius The radius for which the highest already calculated layer has to be found.
-         * \param map The cache in which the lookup is performed.
+         * \param max_layer_idx Only layers up to max_layer_idx are considered. As the layers may be released by release_layer(),
+         *        the layers above max_layer_idx do not mean that the layers below are calculated.
          *
          * \return A wrapped optional reference of the requested area (if it was found, an empty optional if nothing was found)
          */
-        LayerIndex getMaxCalculatedLayer(coord_t radius) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            auto layer_idx = LayerIndex(m_data.size()) - 1;
-            for (; layer_idx > 0; -- layer_idx)
-                if (const auto &layer = m_data[layer_idx]; layer.find(radius) != layer.end())
+        LayerIndex getMaxCalculatedLayer(coord_t radius, LayerIndex max_layer_idx = std::numeric_limits<LayerIndex>::max()) const {
+            auto layer_idx = std::min(max_layer_idx, m_num_layers.load(std::memory_order_acquire) - 1);
+            for (; layer_idx > 0; -- layer_idx) {
+                const Layer &layer = *this->layer(layer_idx);
+                auto lock = this->lock_layer(layer);
+                if (layer.data.find(radius) != layer.data.end())
                     break;
+            }
             // The placeable on model areas do not exist on layer 0, as there can not be model below it. As such it may be possible that layer 1 is available, but layer 0 does not exist.
-            return layer_idx == 0 ? -1 : layer_idx;
+            return layer_idx <= 0 ? -1 : layer_idx;
         }
 
         // For debugging purposes, sorted by layer index, then by radius.
         [[nodiscard]] std::vector<std::pair<RadiusLayerPair, std::reference_wrapper<const Polygons>>> sorted() const;
 
-        void clear() { m_data.clear(); }
-        void clear_all_but_radius0() { 
-            for (LayerData &l : m_data) {
-                auto begin = l.begin();
-                auto end = l.end();
-                if (begin != end && ++ begin != end)
-                    l.erase(begin, end);
-            }
+        Stats stats() const {
+            return { m_hits.load(std::memory_order_relaxed), m_misses.load(std::memory_order_relaxed), m_waits.load(std::memory_order_relaxed) };
         }
 
+        // Memory of the cached polygons.
+        size_t memory() const { return m_memory.load(std::memory_order_relaxed); }
+        // Start a new epoch of lookups and insertions, the layers used from now on will be marked as the most recently used.
+        void next_epoch() { ++ m_epoch; }
+        // Call fn(layer_idx, last_use) for the layers holding any polygons.
+        template<typename Fn>
+        void foreach_layer_last_use(Fn &&fn) const {
+            for (LayerIndex layer_idx = 0; layer_idx < m_num_layers.load(); ++ layer_idx)
+                if (const Layer &layer = *this->layer(layer_idx); layer.memory > 0)
+                    fn(layer_idx, layer.last_use.load(std::memory_order_relaxed));
+        }
+        // Release polygons of a layer, optionally keeping the polygons of the smallest radius. Returns the memory released.
+        // Like clear(), shall not be called concurrently with the other methods.
+        size_t release_layer(LayerIndex layer_idx, bool keep_smallest_radius);
+
+        // The statistics are kept.
+        void clear();
+        void clear_all_but_radius0();
+
     private:
-        LayerData&          get_allocate_layer_data(LayerIndex layer_idx) {
+        // Returns nullptr if the layer was not allocated yet.
+        const Layer*        layer(LayerIndex layer_idx) const {
+            if (layer_idx < 0 || layer_idx >= m_num_layers.load(std::memory_order_acquire))
+                return nullptr;
+            return &m_chunks[layer_idx / LayersPerChunk].load(std::memory_order_acquire)->layers[layer_idx % LayersPerChunk];
+        }
+        Layer*              layer(LayerIndex layer_idx) { return const_cast<Layer*>(std::as_const(*this).layer(layer_idx)); }
+        Layer&              get_allocate_layer(LayerIndex layer_idx) {
             allocate_layers(layer_idx + 1);
-            return m_data[layer_idx];
+            return *this->layer(layer_idx);
         }
         void                allocate_layers(size_t num_layers);
+        std::unique_lock<tbb::spin_mutex> lock_layer(const Layer &layer) const {
+            std::unique_lock<tbb::spin_mutex> lock(layer.mutex, std::try_to_lock);
+            if (! lock.owns_lock()) {
+                count_event(m_waits);
+                lock.lock();
+            }
+            return lock;
+        }
+        void                emplace(Layer &layer, coord_t radius, Polygons &&polygons);
+        static void         count_event([[maybe_unused]] std::atomic<size_t> &counter) {
+#ifdef SUPPORT_TREE_CACHE_STATS
+            counter.fetch_add(1, std::memory_order_relaxed);
+#endif // SUPPORT_TREE_CACHE_STATS
+        }
+        void                touch(const Layer &layer) const {
+            // Don't write into the cache line of the layer if not needed.
+            if (uint32_t epoch = m_epoch.load(std::memory_order_relaxed); layer.last_use.load(std::memory_order_relaxed) != epoch)
+                layer.last_use.store(epoch, std::memory_order_relaxed);
+        }
 
-        Layers              m_data;
-        mutable std::mutex  m_mutex;
+        std::array<std::atomic<Chunk*>, MaxChunks> m_chunks {};
+        std::atomic<LayerIndex>                    m_num_layers { 0 };
+        mutable std::atomic<size_t>                m_hits       { 0 };
+        mutable std::atomic<size_t>                m_misses     { 0 };
+        mutable std::atomic<size_t>                m_waits      { 0 };
+        std::atomic<size_t>                        m_memory     { 0 };
+        std::atomic<uint32_t>                      m_epoch      { 1 };
     };
 
-
     /*!
      * \brief Provides the areas that have to be avoided by the tree's branches to prevent collision with the model on this layer. Holes are removed.
      *
@@ -486,6 +585,17 @@ private:
      * \brief Radii that can be ignored by ceilRadius as they will never be requested, sorted.
      */
     std::vector<coord_t> m_ignorable_radii;
+    /*!
+     * \brief Growth factor of the radii above SUPPORT_TREE_EXPONENTIAL_THRESHOLD, see ceilRadius().
+     */
+    double m_radius_quantization { SUPPORT_TREE_EXPONENTIAL_FACTOR };
+    /*!
+     * \brief Memory budget of the caches in bytes, zero for unlimited. See shrink_caches_to_budget().
+     */
+    size_t m_cache_memory_budget { 0 };
+    size_t m_cache_memory_peak   { 0 };
+    // Some layers were released by shrink_caches_to_budget(), thus they may be requested even though precalculate() was called.
+    bool   m_cache_shrunk        { false };
 
     /*!
      * \brief Smallest radius a branch can have. This is the radius of a SupportElement with DTT=0.
@@ -201,6 +201,13 @@ struct TreeSupportMeshGroupSettings {
     // minimum: min_wall_line_width, minimum warning: min_wall_line_width+0.05, maximum_value: support_tree_branch_diameter, value: support_line_width
     coord_t                         support_tree_tip_diameter               { scaled<coord_t>(0.4) };
 
+    // Memory budget of the collision and avoidance caches in bytes, zero for unlimited.
+    // Over the budget, the least recently used layers are released and recalculated on demand, trading time for memory.
+    size_t                          support_tree_cache_memory_budget        { 0 };
+    // Growth factor of the branch radii the collision and avoidance areas are calculated for, above 1.5mm.
+    // A coarser quantization calculates less radii, at the cost of branches keeping more distance from the model.
+    double                          support_tree_radius_quantization        { 1.5 };
+
     // Support Interface Priority
     // How support interface and support will interact when they overlap. Currently only implemented for support roof.
     //enum                           support_interface_priority { support_lines_overwrite_interface_area };
@@ -24,6 +24,8 @@
 #include "tbb/blocked_range.h"
 #include "tbb/blocked_range2d.h"
 #include "tbb/parallel_reduce.h"
+#include "tbb/parallel_invoke.h"
+#include "tbb/task_group.h"
 #include <algorithm>
 #include <boost/log/trivial.hpp>
 #include <cmath>
@@ -790,8 +792,30 @@ public:
     }
 };
 
+// Object parts built from each slice of each layer. Building the parts does not depend on the stability of the layers below,
+// thus it is done for all slices in parallel ahead of the inherently serial check_stability().
+using PrecomputedObjectParts = std::vector<std::vector<ObjectPart>>;
+PrecomputedObjectParts precompute_object_parts(const PrintObject *po, const Params &params)
+{
+    PrecomputedObjectParts result(po->layer_count());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, po->layers().size()), [po, &params, &result](tbb::blocked_range<size_t> r) {
+        for (size_t lidx = r.begin(); lidx < r.end(); lidx++) {
+            const Layer *l = po->get_layer(lidx);
+            result[lidx].resize(l->lslices_ex.size());
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, l->lslices_ex.size()), [lidx, l, &params, &result](tbb::blocked_range<size_t> r2) {
+                for (size_t slice_idx = r2.begin(); slice_idx < r2.end(); slice_idx++) {
+                    result[lidx][slice_idx] = std::get<0>(build_object_part_from_slice(slice_idx, l, params));
+                }
+            });
+        }
+    });
+
+    return result;
+}
+
 std::tuple<SupportPoints, PartialObjects> check_stability(const PrintObject                 *po,
                                                           const PrecomputedSliceConnections &precomputed_slices_connections,
+                                                          const PrecomputedObjectParts      &precomputed_object_parts,
                                                           const PrintTryCancel              &cancel_func,
                                                           const Params                      &params)
 {
@@ -822,7 +846,7 @@ std::tuple<SupportPoints, PartialObjects> check_stability(const PrintObject
 
         for (size_t slice_idx = 0; slice_idx < layer->lslices_ex.size(); ++slice_idx) {
             const LayerSlice &slice             = layer->lslices_ex.at(slice_idx);
-            auto [new_part, covered_area]              = build_object_part_from_slice(slice_idx, layer, params);
+            const ObjectPart &new_part                 = precomputed_object_parts[layer_idx][slice_idx];
             const SliceConnection &connection_to_below = precomputed_slices_connections[layer_idx][slice_idx];
 
 #ifdef DETAILED_DEBUG_LOGS
@@ -963,8 +987,18 @@ std::tuple<SupportPoints, PartialObjects> check_stability(const PrintObject
                               }
                           });
 
+        // The external perimeters of this layer will be queried by the next layer. Their distancer is built in the background,
+        // while the stability of the slices of this layer is being evaluated.
         std::vector<ExtrusionLine> current_layer_ext_perims_lines{};
         current_layer_ext_perims_lines.reserve(prev_layer_ext_perim_lines.get_lines().size());
+        for (const tbb::concurrent_vector<ExtrusionLine> &slice_lines : ext_perim_lines_per_slice)
+            current_layer_ext_perims_lines.insert(current_layer_ext_perims_lines.end(), slice_lines.begin(), slice_lines.end());
+        LD              next_layer_ext_perim_lines;
+        tbb::task_group build_next_layer_ext_perim_lines;
+        build_next_layer_ext_perim_lines.run([&next_layer_ext_perim_lines, &current_layer_ext_perims_lines]() {
+            next_layer_ext_perim_lines = LD(std::move(current_layer_ext_perims_lines));
+        });
+
         // All object parts updated, and for each slice we have coresponding weakest connection.
         // We can now check each slice and its corresponding weakest connection and object part for stability.
         for (size_t slice_idx = 0; slice_idx < layer->lslices_ex.size(); ++slice_idx) {
@@ -1029,10 +1063,9 @@ std::tuple<SupportPoints, PartialObjects> check_stability(const PrintObject
                     }
                 }
             }
-            current_layer_ext_perims_lines.insert(current_layer_ext_perims_lines.end(), current_slice_lines_distancer.get_lines().begin(),
-                                                  current_slice_lines_distancer.get_lines().end());
         } // slice iterations
-        prev_layer_ext_perim_lines = LD(current_layer_ext_perims_lines);
+        build_next_layer_ext_perim_lines.wait();
+        prev_layer_ext_perim_lines = std::move(next_layer_ext_perim_lines);
     } // layer iterations
 
     for (const auto& active_obj_pair : prev_slice_idx_to_object_part_mapping) {
@@ -1084,8 +1117,13 @@ void debug_export(const SupportPoints& support_points,const PartialObjects& obje
 
 std::tuple<SupportPoints, PartialObjects> full_search(const PrintObject *po, const PrintTryCancel& cancel_func, const Params &params)
 {
-    auto precomputed_slices_connections = precompute_slices_connections(po);
-    auto results = check_stability(po, precomputed_slices_connections, cancel_func, params);
+    PrecomputedSliceConnections precomputed_slices_connections;
+    PrecomputedObjectParts      precomputed_object_parts;
+    tbb::parallel_invoke(
+        [po, &precomputed_slices_connections]() { precomputed_slices_connections = precompute_slices_connections(po); },
+        [po, &params, &precomputed_object_parts]() { precomputed_object_parts = precompute_object_parts(po, params); });
+    cancel_func();
+    auto results = check_stability(po, precomputed_slices_connections, precomputed_object_parts, cancel_func, params);
 #ifdef DEBUG_FILES
     auto [supp_points, objects] = results;
     debug_export(supp_points, objects, "issues");
@@ -1094,6 +1132,18 @@ std::tuple<SupportPoints, PartialObjects> full_search(const PrintObject *po, con
     return results;
 }
 
+static std::vector<ExtrusionLine> concat_extrusion_lines(std::vector<std::vector<ExtrusionLine>> &&batches)
+{
+    size_t num_lines = 0;
+    for (const std::vector<ExtrusionLine> &batch : batches)
+        num_lines += batch.size();
+    std::vector<ExtrusionLine> out;
+    out.reserve(num_lines);
+    for (std::vector<ExtrusionLine> &batch : batches)
+        out.insert(out.end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+    return out;
+}
+
 void estimate_supports_malformations(SupportLayerPtrs &layers, float flow_width, const Params &params)
 {
 #ifdef DEBUG_FILES
@@ -1105,37 +1155,45 @@ void estimate_supports_malformations(SupportLayerPtrs &layers, float flow_width,
 
     for (SupportLayer *l : layers) {
         l->curled_lines.clear();
-        std::vector<ExtrusionLine> current_layer_lines;
-
-        for (const ExtrusionEntity *extrusion : l->support_fills.flatten().entities) {
-            Polyline pl = extrusion->as_polyline();
-            Polygon  pol(pl.points);
-            pol.make_counter_clockwise();
-
-            auto annotated_points = estimate_points_properties<true, true, false, false>(pol.points, prev_layer_lines, flow_width);
-
-            for (size_t i = 0; i < annotated_points.size(); ++i) {
-                const ExtendedPoint &a = i > 0 ? annotated_points[i - 1] : annotated_points[i];
-                const ExtendedPoint &b = annotated_points[i];
-                ExtrusionLine        line_out{a.position.cast<float>(), b.position.cast<float>(), float((a.position - b.position).norm()),
-                                       extrusion};
+        // The extrusions of a layer only depend on the layer below, thus they are processed in parallel,
+        // each into its own batch of lines. The batches are concatenated in the original order.
+        const ExtrusionEntityCollection         extrusions = l->support_fills.flatten();
+        std::vector<std::vector<ExtrusionLine>> extrusion_lines(extrusions.entities.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, extrusions.entities.size()), [&](const tbb::blocked_range<size_t> &range) {
+            for (size_t extrusion_idx = range.begin(); extrusion_idx < range.end(); ++extrusion_idx) {
+                const ExtrusionEntity      *extrusion          = extrusions.entities[extrusion_idx];
+                std::vector<ExtrusionLine> &current_layer_lines = extrusion_lines[extrusion_idx];
+                Polyline pl = extrusion->as_polyline();
+                Polygon  pol(pl.points);
+                pol.make_counter_clockwise();
+
+                auto annotated_points = estimate_points_properties<true, true, false, false>(pol.points, prev_layer_lines, flow_width);
+
+                current_layer_lines.reserve(annotated_points.size());
+                for (size_t i = 0; i < annotated_points.size(); ++i) {
+                    const ExtendedPoint &a = i > 0 ? annotated_points[i - 1] : annotated_points[i];
+                    const ExtendedPoint &b = annotated_points[i];
+                    ExtrusionLine        line_out{a.position.cast<float>(), b.position.cast<float>(), float((a.position - b.position).norm()),
+                                           extrusion};
 
-                Vec2f middle                               = 0.5 * (line_out.a + line_out.b);
-                auto [middle_distance, bottom_line_idx, x] = prev_layer_lines.distance_from_lines_extra<false>(middle);
-                ExtrusionLine bottom_line                  = prev_layer_lines.get_lines().empty() ? ExtrusionLine{} :
-                                                                                                    prev_layer_lines.get_line(bottom_line_idx);
+                    Vec2f middle                               = 0.5 * (line_out.a + line_out.b);
+                    auto [middle_distance, bottom_line_idx, x] = prev_layer_lines.distance_from_lines_extra<false>(middle);
+                    ExtrusionLine bottom_line                  = prev_layer_lines.get_lines().empty() ? ExtrusionLine{} :
+                                                                                                        prev_layer_lines.get_line(bottom_line_idx);
 
-                Vec2f v1   = (bottom_line.b - bottom_line.a);
-                Vec2f v2   = (a.position.cast<float>() - bottom_line.a);
-                auto  d    = (v1.x() * v2.y()) - (v1.y() * v2.x());
-                float sign = (d > 0) ? -1.0f : 1.0f;
+                    Vec2f v1   = (bottom_line.b - bottom_line.a);
+                    Vec2f v2   = (a.position.cast<float>() - bottom_line.a);
+                    auto  d    = (v1.x() * v2.y()) - (v1.y() * v2.x());
+                    float sign = (d > 0) ? -1.0f : 1.0f;
 
-                line_out.curled_up_height = estimate_curled_up_height(middle_distance * sign, 0.5 * (a.curvature + b.curvature), l->height,
-                                                                      flow_width, bottom_line.curled_up_height, params);
+                    line_out.curled_up_height = estimate_curled_up_height(middle_distance * sign, 0.5 * (a.curvature + b.curvature), l->height,
+                                                                          flow_width, bottom_line.curled_up_height, params);
 
-                current_layer_lines.push_back(line_out);
+                    current_layer_lines.push_back(line_out);
+                }
             }
-        }
+        });
+        std::vector<ExtrusionLine> current_layer_lines = concat_extrusion_lines(std::move(extrusion_lines));
 
         for (const ExtrusionLine &line : current_layer_lines) {
             if (line.curled_up_height > params.curling_tolerance_limit) {
@@ -1156,7 +1214,7 @@ void estimate_supports_malformations(SupportLayerPtrs &layers, float flow_width,
         }
 #endif
 
-        prev_layer_lines = LD{current_layer_lines};
+        prev_layer_lines = LD{std::move(current_layer_lines)};
     }
 
 #ifdef DEBUG_FILES
@@ -1178,11 +1236,23 @@ void estimate_malformations(LayerPtrs &layers, const Params &params)
         l->curled_lines.clear();
         std::vector<Linef> boundary_lines = l->lower_layer != nullptr ? to_unscaled_linesf(l->lower_layer->lslices) : std::vector<Linef>();
         AABBTreeLines::LinesDistancer<Linef> prev_layer_boundary{std::move(boundary_lines)};
-        std::vector<ExtrusionLine>           current_layer_lines;
+
+        // The external perimeters of a layer only depend on the layer below, thus they are processed in parallel,
+        // each into its own batch of lines. The batches are concatenated in the original order.
+        std::vector<ExtrusionEntityCollection>                          perimeters;
+        std::vector<std::pair<const LayerRegion*, const ExtrusionEntity*>> extrusions;
+        perimeters.reserve(l->regions().size());
         for (const LayerRegion *layer_region : l->regions()) {
-            for (const ExtrusionEntity *extrusion : layer_region->perimeters().flatten().entities) {
-                if (!extrusion->role().is_external_perimeter())
-                    continue;
+            perimeters.emplace_back(layer_region->perimeters().flatten());
+            for (const ExtrusionEntity *extrusion : perimeters.back().entities)
+                if (extrusion->role().is_external_perimeter())
+                    extrusions.emplace_back(layer_region, extrusion);
+        }
+        std::vector<std::vector<ExtrusionLine>> extrusion_lines(extrusions.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, extrusions.size()), [&](const tbb::blocked_range<size_t> &range) {
+            for (size_t extrusion_idx = range.begin(); extrusion_idx < range.end(); ++extrusion_idx) {
+                const auto [layer_region, extrusion]           = extrusions[extrusion_idx];
+                std::vector<ExtrusionLine> &current_layer_lines = extrusion_lines[extrusion_idx];
 
                 Points extrusion_pts;
                 extrusion->collect_points(extrusion_pts);
@@ -1209,7 +1279,8 @@ void estimate_malformations(LayerPtrs &layers, const Params &params)
                     current_layer_lines.push_back(line_out);
                 }
             }
-        }
+        });
+        std::vector<ExtrusionLine> current_layer_lines = concat_extrusion_lines(std::move(extrusion_lines));
 
         for (const ExtrusionLine &line : current_layer_lines) {
             if (line.curled_up_height > params.curling_tolerance_limit) {
@@ -1230,7 +1301,7 @@ void estimate_malformations(LayerPtrs &layers, const Params &params)
         }
 #endif
 
-        prev_layer_lines = LD{current_layer_lines};
+        prev_layer_lines = LD{std::move(current_layer_lines)};
     }
 
 #ifdef DEBUG_FILES
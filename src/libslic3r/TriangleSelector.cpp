@@ -7,12 +7,25 @@
 
 #include <boost/container/small_vector.hpp>
 
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
 #ifndef NDEBUG
 //    #define EXPENSIVE_DEBUG_CHECKS
 #endif // NDEBUG
 
 namespace Slic3r {
 
+// The exports and the serialization process the triangles in chunks of this size in parallel.
+// The results of the chunks are concatenated in the order of the triangles, thus the output does not depend
+// on the number of threads.
+static constexpr int triangles_chunk_size = 4096;
+
+static inline size_t num_triangle_chunks(int num_triangles)
+{
+    return size_t((num_triangles + triangles_chunk_size - 1) / triangles_chunk_size);
+}
+
 // Check if the line is whole inside the sphere, or it is partially inside (intersecting) the sphere.
 // Inspired by Christer Ericson's Real-Time Collision Detection, pp. 177-179.
 static bool test_line_inside_sphere(const Vec3f &line_a, const Vec3f &line_b, const Vec3f &sphere_p, const float sphere_radius)
@@ -1337,22 +1350,50 @@ int TriangleSelector::num_facets(EnforcerBlockerType state) const
 
 indexed_triangle_set TriangleSelector::get_facets(EnforcerBlockerType state) const
 {
+    // Only export the vertices referenced by the exported triangles, in the order of their first use.
     indexed_triangle_set out;
     std::vector<int> vertex_map(m_vertices.size(), -1);
-    for (const Triangle& tr : m_triangles) {
-        if (tr.valid() && ! tr.is_split() && tr.get_state() == state) {
-            stl_triangle_vertex_indices indices;
-            for (int i=0; i<3; ++i) {
-                int j = tr.verts_idxs[i];
-                if (vertex_map[j] == -1) {
-                    vertex_map[j] = int(out.vertices.size());
-                    out.vertices.emplace_back(m_vertices[j].v);
-                }
-                indices[i] = vertex_map[j];
+    auto export_triangle = [this, &out, &vertex_map](const stl_triangle_vertex_indices &triangle) {
+        stl_triangle_vertex_indices indices;
+        for (int i = 0; i < 3; ++ i) {
+            int j = triangle(i);
+            if (vertex_map[j] == -1) {
+                vertex_map[j] = int(out.vertices.size());
+                out.vertices.emplace_back(m_vertices[j].v);
             }
-            out.indices.emplace_back(indices);
+            indices(i) = vertex_map[j];
         }
+        out.indices.emplace_back(indices);
+    };
+
+    if (m_triangles.size() <= size_t(triangles_chunk_size) || tbb::this_task_arena::max_concurrency() == 1) {
+        // Collecting the leaves by chunks would only add to the serial time.
+        for (const Triangle &tr : m_triangles)
+            if (tr.valid() && ! tr.is_split() && tr.get_state() == state)
+                export_triangle(stl_triangle_vertex_indices(tr.verts_idxs[0], tr.verts_idxs[1], tr.verts_idxs[2]));
+        return out;
     }
+
+    // Collect the leaves of the given state by chunks of m_triangles, indexing m_vertices.
+    // The chunks are concatenated in the order of m_triangles, thus the triangles are exported in the same order as by a serial scan.
+    std::vector<std::vector<stl_triangle_vertex_indices>> chunks(num_triangle_chunks(int(m_triangles.size())));
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, chunks.size()), [this, state, &chunks](const tbb::blocked_range<size_t> &range) {
+        for (size_t chunk_idx = range.begin(); chunk_idx < range.end(); ++ chunk_idx) {
+            std::vector<stl_triangle_vertex_indices> &out = chunks[chunk_idx];
+            size_t itriangle_end = std::min((chunk_idx + 1) * size_t(triangles_chunk_size), m_triangles.size());
+            for (size_t itriangle = chunk_idx * size_t(triangles_chunk_size); itriangle < itriangle_end; ++ itriangle)
+                if (const Triangle &tr = m_triangles[itriangle]; tr.valid() && ! tr.is_split() && tr.get_state() == state)
+                    out.emplace_back(tr.verts_idxs[0], tr.verts_idxs[1], tr.verts_idxs[2]);
+        }
+    }); // end of parallel_for
+
+    size_t num_triangles = 0;
+    for (const std::vector<stl_triangle_vertex_indices> &chunk : chunks)
+        num_triangles += chunk.size();
+    out.indices.reserve(num_triangles);
+    for (const std::vector<stl_triangle_vertex_indices> &chunk : chunks)
+        for (const stl_triangle_vertex_indices &triangle : chunk)
+            export_triangle(triangle);
     return out;
 }
 
@@ -1372,12 +1413,36 @@ indexed_triangle_set TriangleSelector::get_facets_strict(EnforcerBlockerType sta
             out.vertices.emplace_back(v.v);
         }
 
-    for (int itriangle = 0; itriangle < m_orig_size_indices; ++ itriangle)
-        this->get_facets_strict_recursive(m_triangles[itriangle], m_neighbors[itriangle], state, out.indices);
+    if (m_orig_size_indices <= triangles_chunk_size || tbb::this_task_arena::max_concurrency() == 1) {
+        // Splitting the leaves by chunks would only add to the serial time.
+        for (int itriangle = 0; itriangle < m_orig_size_indices; ++ itriangle)
+            this->get_facets_strict_recursive(m_triangles[itriangle], m_neighbors[itriangle], state, out.indices);
+        for (auto &triangle : out.indices)
+            for (int i = 0; i < 3; ++ i)
+                triangle(i) = vertex_map[triangle(i)];
+        return out;
+    }
+
+    // Split the leaves of the given state by the T-joints by chunks of source triangles, then concatenate the chunks.
+    std::vector<std::vector<stl_triangle_vertex_indices>> chunks(num_triangle_chunks(m_orig_size_indices));
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, chunks.size()), [this, state, &vertex_map, &chunks](const tbb::blocked_range<size_t> &range) {
+        for (size_t chunk_idx = range.begin(); chunk_idx < range.end(); ++ chunk_idx) {
+            std::vector<stl_triangle_vertex_indices> &out_triangles = chunks[chunk_idx];
+            int itriangle_end = std::min(int(chunk_idx + 1) * triangles_chunk_size, m_orig_size_indices);
+            for (int itriangle = int(chunk_idx) * triangles_chunk_size; itriangle < itriangle_end; ++ itriangle)
+                this->get_facets_strict_recursive(m_triangles[itriangle], m_neighbors[itriangle], state, out_triangles);
+            for (auto &triangle : out_triangles)
+                for (int i = 0; i < 3; ++ i)
+                    triangle(i) = vertex_map[triangle(i)];
+        }
+    }); // end of parallel_for
 
-    for (auto &triangle : out.indices)
-        for (int i = 0; i < 3; ++ i)
-            triangle(i) = vertex_map[triangle(i)];
+    size_t num_triangles = 0;
+    for (const std::vector<stl_triangle_vertex_indices> &chunk : chunks)
+        num_triangles += chunk.size();
+    out.indices.reserve(num_triangles);
+    for (const std::vector<stl_triangle_vertex_indices> &chunk : chunks)
+        append(out.indices, chunk);
 
     return out;
 }
@@ -1587,21 +1652,56 @@ std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> TriangleSelector:
                 }
             }
         }
-    } out { this };
-
-    out.data.first.reserve(m_orig_size_indices);
-    for (int i=0; i<m_orig_size_indices; ++i)
-        if (const Triangle& tr = m_triangles[i]; tr.is_split() || tr.get_state() != EnforcerBlockerType::NONE) {
-            // Store index of the first bit assigned to ith triangle.
-            out.data.first.emplace_back(i, int(out.data.second.size()));
-            // out the triangle bits.
-            out.serialize(i);
+
+        // Serialize the painted or split source triangles <itriangle_begin, itriangle_end).
+        void serialize(int itriangle_begin, int itriangle_end) {
+            for (int i = itriangle_begin; i < itriangle_end; ++ i)
+                if (const Triangle& tr = triangle_selector->m_triangles[i]; tr.is_split() || tr.get_state() != EnforcerBlockerType::NONE) {
+                    // Store index of the first bit assigned to ith triangle.
+                    data.first.emplace_back(i, int(data.second.size()));
+                    // out the triangle bits.
+                    this->serialize(i);
+                }
         }
+    };
+
+    if (m_orig_size_indices <= triangles_chunk_size || tbb::this_task_arena::max_concurrency() == 1) {
+        // Concatenating the chunks would only add to the serial time.
+        Serializer out { this };
+        out.data.first.reserve(m_orig_size_indices);
+        out.serialize(0, m_orig_size_indices);
+        // May be stored onto Undo / Redo stack, thus conserve memory.
+        out.data.first.shrink_to_fit();
+        out.data.second.shrink_to_fit();
+        return out.data;
+    }
 
-    // May be stored onto Undo / Redo stack, thus conserve memory.
-    out.data.first.shrink_to_fit();
-    out.data.second.shrink_to_fit();
-    return out.data;
+    // The chunks of source triangles are serialized in parallel, each into its own bit stream
+    // with the bit offsets relative to the start of the chunk.
+    std::vector<Serializer> chunks(num_triangle_chunks(m_orig_size_indices), Serializer{ this });
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, chunks.size()), [this, &chunks](const tbb::blocked_range<size_t> &range) {
+        for (size_t chunk_idx = range.begin(); chunk_idx < range.end(); ++ chunk_idx)
+            chunks[chunk_idx].serialize(int(chunk_idx) * triangles_chunk_size, std::min(int(chunk_idx + 1) * triangles_chunk_size, m_orig_size_indices));
+    }); // end of parallel_for
+
+    // Concatenate the chunks, shifting their bit offsets.
+    // Reserved to the exact size, as the result may be stored onto Undo / Redo stack, thus conserve memory.
+    std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> data;
+    size_t num_triangles = 0;
+    size_t num_bits      = 0;
+    for (const Serializer &chunk : chunks) {
+        num_triangles += chunk.data.first.size();
+        num_bits      += chunk.data.second.size();
+    }
+    data.first.reserve(num_triangles);
+    data.second.reserve(num_bits);
+    for (const Serializer &chunk : chunks) {
+        int ibit = int(data.second.size());
+        for (const std::pair<int, int> &triangle_id_and_ibit : chunk.data.first)
+            data.first.emplace_back(triangle_id_and_ibit.first, triangle_id_and_ibit.second + ibit);
+        data.second.insert(data.second.end(), chunk.data.second.begin(), chunk.data.second.end());
+    }
+    return data;
 }
 
 void TriangleSelector::deserialize(const std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> &data, bool needs_reset)
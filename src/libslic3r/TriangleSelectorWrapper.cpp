@@ -7,9 +7,8 @@
 
 namespace Slic3r {
 
-TriangleSelectorWrapper::TriangleSelectorWrapper(const TriangleMesh &mesh, const Transform3d& mesh_transform) :
-        mesh(mesh), mesh_transform(mesh_transform), selector(mesh), triangles_tree(
-                AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(mesh.its.vertices, mesh.its.indices)) {
+TriangleSelectorWrapper::TriangleSelectorWrapper(const std::shared_ptr<const TriangleMesh> &mesh, const Transform3d& mesh_transform) :
+        mesh(*mesh), mesh_transform(mesh_transform), selector(*mesh), triangles_tree(AABBTreeCache::tree(mesh)) {
 }
 
 void TriangleSelectorWrapper::enforce_spot(const Vec3f &point, const Vec3f &origin, float radius) {
@@ -18,7 +17,7 @@ void TriangleSelectorWrapper::enforce_spot(const Vec3f &point, const Vec3f &orig
     static constexpr const auto eps_angle = 89.99f;
     Transform3d trafo_no_translate = mesh_transform;
     trafo_no_translate.translation() = Vec3d::Zero();
-    if (AABBTreeIndirect::intersect_ray_all_hits(mesh.its.vertices, mesh.its.indices, triangles_tree,
+    if (AABBTreeIndirect::intersect_ray_all_hits(mesh.its.vertices, mesh.its.indices, *triangles_tree,
             Vec3d(origin.cast<double>()),
             Vec3d(dir.cast<double>()),
             hits)) {
@@ -38,7 +37,7 @@ void TriangleSelectorWrapper::enforce_spot(const Vec3f &point, const Vec3f &orig
         size_t hit_idx_out;
         Vec3f hit_point_out;
         float dist = AABBTreeIndirect::squared_distance_to_indexed_triangle_set(mesh.its.vertices, mesh.its.indices,
-                triangles_tree, point, hit_idx_out, hit_point_out);
+                *triangles_tree, point, hit_idx_out, hit_point_out);
         if (dist < radius) {
             std::unique_ptr<TriangleSelector::Cursor> cursor = std::make_unique<TriangleSelector::Sphere>(
                     point, origin, radius, this->mesh_transform, TriangleSelector::ClippingPlane { });
@@ -7,7 +7,7 @@
 
 #include "TriangleSelector.hpp"
 #include "Model.hpp"
-#include "AABBTreeIndirect.hpp"
+#include "AABBTreeCache.hpp"
 
 namespace Slic3r {
 
@@ -22,9 +22,10 @@ public:
     const TriangleMesh &mesh;
     const Transform3d& mesh_transform;
     TriangleSelector selector;
-    AABBTreeIndirect::Tree<3, float> triangles_tree;
+    // Shared through AABBTreeCache, the caller keeps the mesh alive.
+    std::shared_ptr<const AABBTreeIndirect::Tree<3, float>> triangles_tree;
 
-    TriangleSelectorWrapper(const TriangleMesh &mesh, const Transform3d& mesh_transform);
+    TriangleSelectorWrapper(const std::shared_ptr<const TriangleMesh> &mesh, const Transform3d& mesh_transform);
 
     void enforce_spot(const Vec3f &point, const Vec3f& origin, float radius);
 
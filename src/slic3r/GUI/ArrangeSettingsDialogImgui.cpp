@@ -16,6 +16,7 @@ struct Settings {
     int   xl_align;
     int   geom_handling;
     int   arr_strategy;
+    bool  incremental;
 };
 
 static void read_settings(Settings &s, const arr2::ArrangeSettingsDb *db)
@@ -26,7 +27,8 @@ static void read_settings(Settings &s, const arr2::ArrangeSettingsDb *db)
     s.rotations = db->is_rotation_enabled();
     s.xl_align  = db->get_xl_alignment();
     s.geom_handling = db->get_geometry_handling();
-    s.arr_strategy = db->get_arrange_strategy();
+    s.arr_strategy = db->get_arrange_strategy() == arr2::ArrangeSettingsView::asRaster ? 1 : 0;
+    s.incremental = db->is_incremental();
 }
 
 ArrangeSettingsDialogImgui::ArrangeSettingsDialogImgui(
@@ -112,6 +114,22 @@ void ArrangeSettingsDialogImgui::render(float pos_x, float pos_y)
                     settings.geom_handling));
     }
 
+    // TRN ArrangeDialog
+    if (m_imgui->combo(_L("Strategy"),
+        // TRN ArrangeDialog: Type of arrange "Strategy"
+         {_u8L("Automatic"),
+        // TRN ArrangeDialog: Type of arrange "Strategy". Fast but less exact packing of many objects.
+          _u8L("Raster (fast)")},
+                       settings.arr_strategy)) {
+        m_db->set_arrange_strategy(settings.arr_strategy == 1 ?
+                                       ArrangeSettingsView::asRaster :
+                                       ArrangeSettingsView::asAuto);
+    }
+
+    if (m_imgui->checkbox(_L("Keep unmoved objects in place"), settings.incremental)) {
+        m_db->set_incremental(settings.incremental);
+    }
+
     ImGui::Separator();
 
     if (m_imgui->button(_L("Reset defaults"))) {
@@ -124,6 +142,7 @@ void ArrangeSettingsDialogImgui::render(float pos_x, float pos_y)
 
         m_db->set_geometry_handling(df.geom_handling);
         m_db->set_arrange_strategy(df.arr_strategy);
+        m_db->set_incremental(df.incremental);
 
         if (m_on_reset_btn)
             m_on_reset_btn();
@@ -49,7 +49,13 @@ public:
 
     XLPivots get_xl_alignment() const override { return m_db->get_xl_alignment(); }
     GeometryHandling get_geometry_handling() const override { return m_db->get_geometry_handling(); }
-    ArrangeStrategy get_arrange_strategy() const override { return arr2::ArrangeSettingsView::asAuto; }
+    // Pull to center is not offered to the user, only the raster strategy
+    // can be chosen instead of the automatic one.
+    ArrangeStrategy get_arrange_strategy() const override
+    {
+        return m_db->get_arrange_strategy() == asRaster ? asRaster : asAuto;
+    }
+    bool is_incremental() const override { return m_db->is_incremental(); }
 };
 
 }} // namespace Slic3r::GUI
@@ -422,7 +422,7 @@ void GLGizmoFdmSupports::apply_data_from_backend()
                 if (model_volume->is_model_part()) {
                     Transform3d mesh_transformation = obj_transform * model_volume->get_matrix();
                     Transform3d inv_transform       = mesh_transformation.inverse();
-                    selectors.emplace(model_volume->id().id, TriangleSelectorWrapper{model_volume->mesh(), mesh_transformation});
+                    selectors.emplace(model_volume->id().id, TriangleSelectorWrapper{model_volume->mesh_ptr(), mesh_transformation});
 
                     for (const SupportSpotsGenerator::SupportPoint &support_point : support_points) {
                         Vec3f point  = Vec3f(inv_transform.cast<float>() * support_point.position);
@@ -203,6 +203,13 @@ arr2::SceneBuilder build_scene(Plater &plater, ArrangeSelectionMode mode)
 
 FillBedJob2::FillBedJob2(arr2::Scene &&scene, const Callbacks &cbs) : Base(std::move(scene), _u8L("Filling bed"), cbs) {}
 
-ArrangeJob2::ArrangeJob2(arr2::Scene &&scene, const Callbacks &cbs) : Base(std::move(scene), _u8L("Arranging"), cbs) {}
+ArrangeJob2::ArrangeJob2(arr2::Scene &&scene, const Callbacks &cbs, std::shared_ptr<IncrementalState> incremental_state)
+    : Base(std::move(scene), _u8L("Arranging"), cbs), m_incremental_state{std::move(incremental_state)}
+{}
+
+std::unique_ptr<arr2::ArrangeTask<arr2::ArrangeItem>> ArrangeJob2::create_task(const arr2::Scene &scene)
+{
+    return arr2::ArrangeTask<arr2::ArrangeItem>::create(scene, m_incremental_state);
+}
 
 }} // namespace Slic3r
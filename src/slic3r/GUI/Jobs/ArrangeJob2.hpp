@@ -81,11 +81,17 @@ private:
     Callbacks  m_cbs;
     std::string m_task_msg;
 
+protected:
+    virtual std::unique_ptr<ArrangeTaskT> create_task(const arr2::Scene &scene)
+    {
+        return ArrangeTaskT::create(scene);
+    }
+
 public:
     void process(Ctl &ctl) override
     {
         ctl.call_on_main_thread([this]{
-               m_task = ArrangeTaskT::create(m_scene);
+               m_task = create_task(m_scene);
                m_result.reset();
                if (m_task && m_cbs.on_prepared)
                    m_cbs.on_prepared(*m_task);
@@ -131,8 +137,17 @@ public:
 class ArrangeJob2: public ArrangeJob_<arr2::ArrangeTask<arr2::ArrangeItem>>
 {
     using Base = ArrangeJob_<arr2::ArrangeTask<arr2::ArrangeItem>>;
+    using IncrementalState = arr2::IncrementalArrangeState<arr2::ArrangeItem>;
+
+    // Shared by the subsequent arrange jobs, only accessed by one job at a time.
+    std::shared_ptr<IncrementalState> m_incremental_state;
+
+protected:
+    std::unique_ptr<arr2::ArrangeTask<arr2::ArrangeItem>> create_task(const arr2::Scene &scene) override;
+
 public:
-    ArrangeJob2(arr2::Scene &&scene, const Callbacks &cbs = {});
+    ArrangeJob2(arr2::Scene &&scene, const Callbacks &cbs = {},
+                std::shared_ptr<IncrementalState> incremental_state = {});
 };
 
 class FillBedJob2: public ArrangeJob_<arr2::FillBedTask<arr2::ArrangeItem>>
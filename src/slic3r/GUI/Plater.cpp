@@ -1708,6 +1708,11 @@ struct Plater::priv
     PlaterWorker<BoostThreadWorker> m_worker;
     SLAImportDialog *               m_sla_import_dlg;
 
+    // Items packed by the last arrangement, the objects not moved since are kept in place by the next
+    // one if the incremental mode is enabled in the arrange settings.
+    std::shared_ptr<arr2::IncrementalArrangeState<arr2::ArrangeItem>> arrange_state
+        { std::make_shared<arr2::IncrementalArrangeState<arr2::ArrangeItem>>() };
+
     bool                        delayed_scene_refresh;
     std::string                 delayed_error_message;
 
@@ -7355,7 +7360,14 @@ void Plater::arrange(Worker &w, bool selected)
         wxGetApp().obj_manipul()->set_dirty();
     };
 
-    replace_job(w, std::make_unique<ArrangeJob2>(std::move(arrscene), cbs));
+    // Without the incremental mode the next arrangement starts from scratch
+    std::shared_ptr<arr2::IncrementalArrangeState<arr2::ArrangeItem>> state;
+    if (arrscene.settings().is_incremental())
+        state = p->arrange_state;
+    else
+        p->arrange_state->clear();
+
+    replace_job(w, std::make_unique<ArrangeJob2>(std::move(arrscene), cbs, std::move(state)));
 }
 
 void Plater::set_current_canvas_as_dirty()
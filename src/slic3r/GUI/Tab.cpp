@@ -1565,6 +1565,8 @@ void TabPrint::build()
         optgroup->append_single_option_line("support_tree_tip_diameter", category_path + "tree_tip_diameter");
         optgroup->append_single_option_line("support_tree_branch_distance", category_path + "tree_branch_distance");
         optgroup->append_single_option_line("support_tree_top_rate", category_path + "tree_top_rate");
+        optgroup->append_single_option_line("support_tree_cache_memory_budget");
+        optgroup->append_single_option_line("support_tree_radius_quantization");
 
     page = add_options_page(L("Speed"), "time");
         optgroup = page->new_optgroup(L("Speed for print moves"));
@@ -5294,6 +5296,7 @@ void TabSLAPrint::build()
     optgroup->append_single_option_line("hollowing_min_thickness");
     optgroup->append_single_option_line("hollowing_quality");
     optgroup->append_single_option_line("hollowing_closing_distance");
+    optgroup->append_single_option_line("hollowing_tile_voxels");
 
     page = add_options_page(L("Advanced"), "wrench");
     optgroup = page->new_optgroup(L("Slicing"));
@@ -7,6 +7,7 @@
 #include <libslic3r/Arrange/Core/ArrangeFirstFit.hpp>
 #include <libslic3r/Arrange/Core/NFP/PackStrategyNFP.hpp>
 #include <libslic3r/Arrange/Core/NFP/RectangleOverfitPackingStrategy.hpp>
+#include <libslic3r/Arrange/Core/Raster/PackStrategyRaster.hpp>
 
 #include <libslic3r/Arrange/Core/NFP/Kernels/GravityKernel.hpp>
 #include <libslic3r/Arrange/Core/NFP/Kernels/TMArrangeKernel.hpp>
@@ -547,6 +548,73 @@ TEMPLATE_TEST_CASE("NFP algorithm test", "[arrange2][Slow]",
     }
 }
 
+TEST_CASE("NFPs of translated copies are reused from the cache", "[arrange2]") {
+    using namespace Slic3r;
+
+    arr2::InfiniteBed bed;
+    auto parts = prusa_parts();
+    REQUIRE(parts.size() > 1);
+
+    auto calc_nfp = [&bed](const ArrangeItem &orbiter, const ArrangeItem &stationary) {
+        std::array<std::reference_wrapper<const ArrangeItem>, 1> fixed = {{stationary}};
+        return arr2::calculate_nfp(orbiter, default_context(fixed), bed);
+    };
+
+    auto require_same = [](const ExPolygons &a, const ExPolygons &b) {
+        REQUIRE(diff_ex(a, b).empty());
+        REQUIRE(diff_ex(b, a).empty());
+    };
+
+    NFPCache::clear();
+    NFPCache::Stats stats0 = NFPCache::stats();
+
+    ArrangeItem stationary = parts[0];
+    ArrangeItem orbiter = parts[1];
+    stationary.translation(scaled(Vec2d{10., 20.}));
+    stationary.rotation(PI / 3.);
+    orbiter.rotation(PI / 5.);
+    ExPolygons nfp = calc_nfp(orbiter, stationary);
+
+    // Copies share the shape ids, only the translations differ.
+    ArrangeItem stationary_cpy = stationary;
+    ArrangeItem orbiter_cpy = orbiter;
+    stationary_cpy.translation(scaled(Vec2d{-30., 45.}));
+    orbiter_cpy.translation(scaled(Vec2d{100., -7.}));
+    ExPolygons nfp_cached = calc_nfp(orbiter_cpy, stationary_cpy);
+
+    NFPCache::Stats stats = NFPCache::stats();
+    REQUIRE(stats.misses == stats0.misses + 1);
+    REQUIRE(stats.hits == stats0.hits + 1);
+    REQUIRE(stats.entries == 1);
+
+    // The same NFP calculated for shapes unknown to the cache.
+    ArrangeItem stationary_new{arr2::DecomposedShape{stationary.shape().contours()}};
+    ArrangeItem orbiter_new{arr2::DecomposedShape{orbiter.shape().contours()}};
+    stationary_new.translation(stationary_cpy.translation());
+    stationary_new.rotation(stationary_cpy.rotation());
+    orbiter_new.translation(orbiter_cpy.translation());
+    orbiter_new.rotation(orbiter_cpy.rotation());
+    REQUIRE(stationary_new.shape().id() != stationary.shape().id());
+
+    require_same(nfp_cached, calc_nfp(orbiter_new, stationary_new));
+    REQUIRE(NFPCache::stats().entries == 2);
+
+    Point d = stationary_cpy.translation() - stationary.translation();
+    for (ExPolygon &expoly : nfp)
+        expoly.translate(d);
+
+    require_same(nfp_cached, nfp);
+
+    // A different rotation of the orbiter is a different entry.
+    orbiter_cpy.rotation(PI / 2.);
+    calc_nfp(orbiter_cpy, stationary_cpy);
+    REQUIRE(NFPCache::stats().entries == 3);
+
+    NFPCache::clear();
+    REQUIRE(NFPCache::stats().entries == 0);
+    REQUIRE(NFPCache::stats().memory == 0);
+}
+
 TEST_CASE("EdgeCache tests", "[arrange2]") {
     using namespace Slic3r;
 
@@ -614,6 +682,27 @@ TEST_CASE("EdgeCache tests", "[arrange2]") {
         REQUIRE(samples.size() == 1);
         REQUIRE(ep0.coords(samples[0]) == poly.contour.points[1]);
     }
+
+    SECTION("Reset cache should behave as a newly created one") {
+        ExPolygon squ{arr2::to_rectangle(scaled(BoundingBoxf{{0., 0.}, {10., 10.}}))};
+        ExPolygon holed = squ;
+        holed.holes.emplace_back(arr2::to_rectangle(scaled(BoundingBoxf{{2., 2.}, {4., 4.}})));
+        holed.holes.back().reverse();
+
+        arr2::EdgeCache ep;
+        for (const ExPolygon *poly : {&holed, &squ, &holed}) {
+            ep.reset(poly);
+            arr2::EdgeCache ep_new{poly};
+
+            std::vector<arr2::ContourLocation> samples, samples_new;
+            ep.sample_contour(1., samples);
+            ep_new.sample_contour(1., samples_new);
+
+            REQUIRE(samples.size() == samples_new.size());
+            for (size_t i = 0; i < samples.size(); ++i)
+                REQUIRE(ep.coords(samples[i]) == ep_new.coords(samples_new[i]));
+        }
+    }
 }
 
 // Mock packing strategy that places N items to the center of the
@@ -1044,6 +1133,80 @@ TEMPLATE_TEST_CASE("RectangleOverfitPackingStrategy test", "[arrange2]",
     }
 }
 
+TEST_CASE("Conservative rasterization of shapes", "[arrange2]")
+{
+    using namespace Slic3r;
+
+    arr2::BitRaster raster{Point::Zero(), scaled(1.), 20, 10};
+
+    SECTION("Shape aligned to the pixels fills exactly its pixels") {
+        raster.fill_conservative(arr2::to_rectangle(
+            BoundingBox{{scaled(2.), scaled(3.)}, {scaled(6.) - 1, scaled(5.) - 1}}));
+
+        REQUIRE(raster.count() == 4 * 2);
+        REQUIRE(raster.get(2, 3));
+        REQUIRE(raster.get(5, 4));
+        REQUIRE(!raster.get(6, 4));
+    }
+
+    SECTION("Thin shape fills all the pixels it touches") {
+        Polygon diagonal{{scaled(0.5), scaled(0.5)},
+                         {scaled(9.5), scaled(9.4)},
+                         {scaled(9.5), scaled(9.5)}};
+        raster.fill_conservative(diagonal);
+
+        for (int i = 0; i < 10; ++i)
+            REQUIRE(raster.get(i, i));
+    }
+
+    SECTION("Holes are left empty") {
+        ExPolygon holed{arr2::to_rectangle(scaled(BoundingBoxf{{0., 0.}, {10., 10.}}))};
+        holed.holes.emplace_back(arr2::to_rectangle(scaled(BoundingBoxf{{2.5, 2.5}, {7.5, 7.5}})));
+        holed.holes.back().reverse();
+        raster.fill_conservative(holed);
+
+        REQUIRE(raster.get(2, 2));
+        REQUIRE(!raster.get(3, 3));
+        REQUIRE(!raster.get(6, 6));
+        REQUIRE(raster.get(7, 7));
+    }
+}
+
+TEMPLATE_TEST_CASE("Raster packing strategy should not overlap items", "[arrange2]",
+                   Slic3r::arr2::RectangleBed,
+                   Slic3r::arr2::CircleBed,
+                   Slic3r::arr2::IrregularBed)
+{
+    using namespace Slic3r;
+
+    auto bed = init_bed<TestType>();
+    auto parts = prusa_parts(2.);
+
+    arr2::PackStrategyRaster strategy{arr2::GravityKernel{}};
+    arr2::arrange(arr2::firstfit::SelectionStrategy<>{}, strategy,
+                  range(parts), bed);
+
+    ExPolygons bedshape = arr2::to_expolygons(bed);
+    constexpr double tolerance = scaled<double>(.01) * scaled<double>(.01);
+
+    size_t packed_cnt = 0;
+    for (size_t i = 0; i < parts.size(); ++i) {
+        if (get_bed_index(parts[i]) < 0)
+            continue;
+
+        ++packed_cnt;
+        const Polygons &outline = fixed_outline(parts[i]);
+        if (get_bed_index(parts[i]) == 0)
+            REQUIRE(area(diff_ex(outline, bedshape)) < tolerance);
+
+        for (size_t j = i + 1; j < parts.size(); ++j)
+            if (get_bed_index(parts[j]) == get_bed_index(parts[i]))
+                REQUIRE(area(intersection_ex(outline, fixed_outline(parts[j]))) < tolerance);
+    }
+
+    REQUIRE(packed_cnt == parts.size());
+}
+
 TEMPLATE_TEST_CASE("Test if allowed item rotations are considered", "[arrange2]",
                    Slic3r::arr2::ArrangeItem)
 {
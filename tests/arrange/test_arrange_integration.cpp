@@ -112,6 +112,7 @@ public:
         m_v.geom_handling = static_cast<GeometryHandling>(dist(m_rng) % ghCount);
         m_v.arr_strategy  = static_cast<ArrangeStrategy>(dist(m_rng) % asCount);
         m_v.xl_align      = static_cast<XLPivots>(dist(m_rng) % xlpCount);
+        m_v.incremental   = bdist(m_rng);
     }
     explicit RandomArrangeSettings() : m_rng(std::random_device{} ()) {}
 
@@ -121,6 +122,7 @@ public:
     XLPivots get_xl_alignment() const override { return m_v.xl_align; }
     GeometryHandling get_geometry_handling() const override { return m_v.geom_handling; }
     ArrangeStrategy get_arrange_strategy() const override { return m_v.arr_strategy; }
+    bool is_incremental() const override { return m_v.incremental; }
 };
 
 
@@ -791,6 +793,215 @@ TEST_CASE("Testing a simple arrange on cubes", "[arrange2][integration]")
     REQUIRE(is_collision_free(range(task->printable.selected)));
 }
 
+TEST_CASE("Incremental arrange only packs the new items", "[arrange2][integration]")
+{
+    using namespace Slic3r;
+
+    Model model = get_example_model_with_random_cube_objects(size_t{10});
+
+    arr2::ArrangeSettings settings;
+    settings.set_rotation_enabled(true);
+
+    auto bed = arr2::RectangleBed{scaled(250.), scaled(210.)};
+
+    // Arrange with nothing selected, as the plater does. Selected items are
+    // always arranged again.
+    arr2::FixedSelection nothing_selected;
+
+    auto build_scene = [&model, &settings, &bed, &nothing_selected] {
+        return arr2::Scene{arr2::SceneBuilder{}
+                               .set_model(model)
+                               .set_arrange_settings(settings)
+                               .set_bed(bed)
+                               .set_selection(&nothing_selected)};
+    };
+
+    auto state = std::make_shared<arr2::IncrementalArrangeState<arr2::ArrangeItem>>();
+
+    {
+        arr2::Scene scene = build_scene();
+        auto task = arr2::ArrangeTask<arr2::ArrangeItem>::create(scene, state);
+        REQUIRE(task->printable.selected.size() == 10);
+
+        auto result = task->process_native(arr2::DummyCtl{});
+        REQUIRE(result->apply_on(scene.model()));
+        REQUIRE(state->size() == 10);
+    }
+
+    std::vector<Vec3d> offsets;
+    for (const ModelInstance *inst : model.objects.front()->instances)
+        offsets.emplace_back(inst->get_offset());
+
+    ModelObject *obj = model.objects.front();
+    obj->add_instance(*obj->instances.front());
+
+    SECTION("Only the added instance is packed, the rest stays in place")
+    {
+        arr2::Scene scene = build_scene();
+        auto task = arr2::ArrangeTask<arr2::ArrangeItem>::create(scene, state);
+
+        REQUIRE(task->printable.selected.size() == 1);
+        REQUIRE(task->printable.unselected.size() == 10);
+
+        auto result = task->process_native(arr2::DummyCtl{});
+        REQUIRE(result->items.size() == 1);
+        REQUIRE(arr2::is_arranged(result->items.front()));
+        REQUIRE(result->apply_on(scene.model()));
+
+        for (size_t i = 0; i < offsets.size(); ++i)
+            REQUIRE((obj->instances[i]->get_offset() - offsets[i]).norm() < EPSILON);
+
+        std::vector<arr2::ArrangeItem> all_items = task->printable.unselected;
+        all_items.emplace_back(task->printable.selected.front());
+
+        REQUIRE(std::all_of(all_items.begin(), all_items.end(), [&bed](auto &item) {
+            return arr2::get_bed_index(item) > 0 ||
+                   bounding_box(bed).contains(arr2::fixed_bounding_box(item));
+        }));
+
+        all_items.erase(std::remove_if(all_items.begin(), all_items.end(),
+                                       [](auto &item) { return arr2::get_bed_index(item) != 0; }),
+                        all_items.end());
+
+        REQUIRE(is_collision_free(range(all_items)));
+
+        SECTION("Everything is arranged again if nothing was added or moved")
+        {
+            arr2::Scene scene2 = build_scene();
+            auto task2 = arr2::ArrangeTask<arr2::ArrangeItem>::create(scene2, state);
+
+            REQUIRE(task2->printable.selected.size() == 11);
+            REQUIRE(task2->printable.unselected.empty());
+        }
+    }
+
+    SECTION("Changed settings invalidate the state")
+    {
+        settings.set_distance_from_objects(settings.get_distance_from_objects() + 1.f);
+
+        arr2::Scene scene = build_scene();
+        auto task = arr2::ArrangeTask<arr2::ArrangeItem>::create(scene, state);
+
+        REQUIRE(task->printable.selected.size() == 11);
+    }
+}
+
+TEST_CASE("Incremental arrange packs rotated and mirrored items again", "[arrange2][integration]")
+{
+    using namespace Slic3r;
+
+    // A standing triangular prism, its footprint changes with a rotation by
+    // 180 degrees or a mirror but its bounding box does not.
+    TriangleMesh mesh = make_prism(30.f, 20.f, 20.f);
+    mesh.rotate_x(float(PI / 2.));
+    mesh.translate(-mesh.bounding_box().center().cast<float>());
+
+    Model model;
+    ModelObject *obj = model.add_object();
+    obj->add_volume(mesh);
+    for (size_t i = 0; i < 3; ++i)
+        obj->add_instance();
+
+    arr2::ArrangeSettings settings;
+    auto bed = arr2::RectangleBed{scaled(250.), scaled(210.)};
+    arr2::FixedSelection nothing_selected;
+
+    auto build_scene = [&model, &settings, &bed, &nothing_selected] {
+        return arr2::Scene{arr2::SceneBuilder{}
+                               .set_model(model)
+                               .set_arrange_settings(settings)
+                               .set_bed(bed)
+                               .set_selection(&nothing_selected)};
+    };
+
+    auto state = std::make_shared<arr2::IncrementalArrangeState<arr2::ArrangeItem>>();
+
+    auto geom = GENERATE(arr2::ArrangeSettingsView::ghConvex, arr2::ArrangeSettingsView::ghAdvanced);
+    settings.set_geometry_handling(geom);
+
+    {
+        arr2::Scene scene = build_scene();
+        auto task = arr2::ArrangeTask<arr2::ArrangeItem>::create(scene, state);
+        auto result = task->process_native(arr2::DummyCtl{});
+        REQUIRE(result->apply_on(scene.model()));
+        REQUIRE(state->size() == 3);
+    }
+
+    // An added instance makes the state keep the unchanged ones
+    obj->add_instance();
+
+    ModelInstance *inst = obj->instances.front();
+
+    SECTION("Rotated by 180 degrees")
+    {
+        inst->set_rotation(Z, inst->get_rotation(Z) + PI);
+    }
+
+    SECTION("Mirrored")
+    {
+        inst->set_mirror(Y, -1.);
+    }
+
+    arr2::Scene scene = build_scene();
+    auto task = arr2::ArrangeTask<arr2::ArrangeItem>::create(scene, state);
+
+    REQUIRE(task->printable.selected.size() == 2);
+    REQUIRE(task->printable.unselected.size() == 2);
+}
+
+TEST_CASE("Raster strategy arranges the wipe tower and the XL bed with NFPs", "[arrange2][integration]")
+{
+    using namespace Slic3r;
+
+    auto make_items = [](bool with_wipe_tower) {
+        std::vector<arr2::ArrangeItem> items;
+        for (int i = 0; i < 12; ++i) {
+            double w = 20. + 5. * (i % 4), h = 15. + 7. * (i % 3);
+            items.emplace_back(arr2::to_rectangle(scaled(BoundingBoxf{{0., 0.}, {w, h}})));
+        }
+        if (with_wipe_tower)
+            arr2::set_data(items.front(), "is_wipe_tower", true);
+
+        return items;
+    };
+
+    auto arrange = [](std::vector<arr2::ArrangeItem> &items, const arr2::ExtendedBed &bed,
+                      arr2::ArrangeSettingsView::ArrangeStrategy strategy) {
+        auto arranger = arr2::Arranger<arr2::ArrangeItem>::create(
+            arr2::ArrangeSettings{}.set_arrange_strategy(strategy));
+        arranger->arrange(items, {}, bed, arr2::DummyCtl{});
+    };
+
+    auto check_same = [](const std::vector<arr2::ArrangeItem> &l, const std::vector<arr2::ArrangeItem> &r) {
+        REQUIRE(l.size() == r.size());
+        for (size_t i = 0; i < l.size(); ++i) {
+            REQUIRE(arr2::get_bed_index(l[i]) == arr2::get_bed_index(r[i]));
+            REQUIRE(arr2::get_translation(l[i]) == arr2::get_translation(r[i]));
+            REQUIRE(arr2::get_rotation(l[i]) == Approx(arr2::get_rotation(r[i])));
+        }
+    };
+
+    SECTION("A wipe tower among the items") {
+        arr2::ExtendedBed bed = arr2::RectangleBed{scaled(250.), scaled(210.)};
+        std::vector<arr2::ArrangeItem> raster = make_items(true), nfp = make_items(true);
+        arrange(raster, bed, arr2::ArrangeSettingsView::asRaster);
+        arrange(nfp, bed, arr2::ArrangeSettingsView::asAuto);
+
+        check_same(raster, nfp);
+        REQUIRE(is_collision_free(range(raster)));
+    }
+
+    SECTION("XL bed") {
+        arr2::ExtendedBed bed = arr2::XLBed{BoundingBox{Point::Zero(), Point{scaled(360.), scaled(360.)}}};
+        std::vector<arr2::ArrangeItem> raster = make_items(false), nfp = make_items(false);
+        arrange(raster, bed, arr2::ArrangeSettingsView::asRaster);
+        arrange(nfp, bed, arr2::ArrangeSettingsView::asAuto);
+
+        check_same(raster, nfp);
+        REQUIRE(is_collision_free(range(raster)));
+    }
+}
+
 TEST_CASE("Testing arrangement involving virtual beds", "[arrange2][integration]")
 {
     using namespace Slic3r;
@@ -871,7 +1082,8 @@ bool settings_eq(const Slic3r::arr2::ArrangeSettingsView &v1,
            v1.get_distance_from_bed() == Approx(v2.get_distance_from_bed()) &&
            v1.get_distance_from_objects() == Approx(v2.get_distance_from_objects()) &&
            v1.get_geometry_handling() == v2.get_geometry_handling() &&
-           v1.get_xl_alignment() == v2.get_xl_alignment();
+           v1.get_xl_alignment() == v2.get_xl_alignment() &&
+           v1.is_incremental() == v2.is_incremental();
         ;
 }
 
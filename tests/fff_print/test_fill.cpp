@@ -7,6 +7,8 @@
 
 #include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/Fill/Fill.hpp"
+#include "libslic3r/Fill/FillGyroid.hpp"
+#include "libslic3r/Fill/FillPatternCache.hpp"
 #include "libslic3r/Flow.hpp"
 #include "libslic3r/Layer.hpp"
 #include "libslic3r/Geometry.hpp"
@@ -198,6 +200,43 @@ TEST_CASE("Fill: Pattern Path Length", "[Fill]") {
     }
 }
 
+TEST_CASE("Fill: Gyroid pattern is shared through FillPatternCache", "[Fill]") {
+    FillPatternCache::clear();
+    const ExPolygon expolygon(Polygon::new_scale({ { 0., 0. }, { 30., 0. }, { 30., 30. }, { 0., 30. } }));
+
+    std::unique_ptr<Slic3r::Fill> filler(Slic3r::Fill::new_from_type("gyroid"));
+    filler->spacing = 0.45;
+    filler->z       = 1.;
+    FillParams fill_params;
+    fill_params.density = 0.2f;
+
+    Slic3r::Surface surface(stInternal, expolygon);
+    FillPatternCache::Stats stats0 = FillPatternCache::stats();
+    Polylines first  = filler->fill_surface(&surface, fill_params);
+    Polylines second = filler->fill_surface(&surface, fill_params);
+    FillPatternCache::Stats stats = FillPatternCache::stats();
+
+    REQUIRE(! first.empty());
+    REQUIRE(stats.misses == stats0.misses + 1);
+    REQUIRE(stats.hits == stats0.hits + 1);
+    REQUIRE(first == second);
+
+    SECTION("A layer one period along z higher shares the pattern") {
+        filler->z += 2. * PI * filler->spacing / (fill_params.density * FillGyroid::DensityAdjust);
+        Polylines shifted = filler->fill_surface(&surface, fill_params);
+        REQUIRE(FillPatternCache::stats().hits == stats.hits + 1);
+        REQUIRE(shifted == first);
+    }
+    SECTION("The pattern rounded up to whole periods and folded along z fills the same as the exact one") {
+        FillPatternCache::set_enabled(false);
+        Polylines uncached = filler->fill_surface(&surface, fill_params);
+        FillPatternCache::set_enabled(true);
+        REQUIRE(FillPatternCache::stats().misses == stats.misses);
+        REQUIRE(uncached.size() == first.size());
+        REQUIRE(total_length(uncached) == Approx(total_length(first)).epsilon(1e-4));
+    }
+}
+
 SCENARIO("Infill does not exceed perimeters", "[Fill]") 
 {
     auto test = [](const std::string_view pattern) {
@@ -524,6 +524,70 @@ SCENARIO("Some weird coverage test", "[Perimeters]")
     }
 }
 
+SCENARIO("Perimeters of identical islands are generated once", "[Perimeters]")
+{
+    FullPrintConfig config;
+    config.perimeters.value = 3;
+
+    ExPolygon expolygon;
+    expolygon.contour = Polygon::new_scale({ { 0., 0. }, { 20., 0. }, { 20., 20. }, { 0., 20. } });
+    expolygon.holes.emplace_back(Polygon::new_scale({ { 5., 5. }, { 5., 15. }, { 15., 15. }, { 15., 5. } }));
+    Surface surface(stInternal, expolygon);
+
+    struct Result {
+        ExtrusionEntityCollection loops;
+        ExtrusionEntityCollection gap_fill;
+        ExPolygons                fill_expolygons;
+    };
+
+    auto test = [&config, &surface](PerimeterGeneratorType type) {
+        Flow flow(0.45f, 0.2f, 0.4f);
+        PerimeterGenerator::Parameters params(
+            0.2, // layer height
+            1, // layer ID
+            flow, flow, flow, flow,
+            static_cast<const PrintRegionConfig&>(config),
+            static_cast<const PrintObjectConfig&>(config),
+            static_cast<const PrintConfig&>(config),
+            false); // spiral_vase
+        auto process = [&params, &surface, type](Result &result) {
+            Polygons lower_layer_polygons_cache;
+            if (type == PerimeterGeneratorType::Arachne)
+                PerimeterGenerator::process_arachne(params, surface, nullptr, lower_layer_polygons_cache, result.loops, result.gap_fill, result.fill_expolygons);
+            else
+                PerimeterGenerator::process_classic(params, surface, nullptr, lower_layer_polygons_cache, result.loops, result.gap_fill, result.fill_expolygons);
+        };
+
+        Result uncached;
+        process(uncached);
+
+        PerimeterGenerator::Cache cache;
+        params.cache = &cache;
+        Result first, second;
+        process(first);
+        process(second);
+
+        THEN("the second island is served from the cache") {
+            REQUIRE(cache.hits() == 1);
+        }
+        THEN("the cached perimeters match the generated ones") {
+            for (const Result *result : { &first, &second }) {
+                REQUIRE(result->loops.flatten().entities.size() == uncached.loops.flatten().entities.size());
+                REQUIRE(result->loops.total_volume() == Approx(uncached.loops.total_volume()));
+                REQUIRE(result->gap_fill.entities.size() == uncached.gap_fill.entities.size());
+                REQUIRE(area(result->fill_expolygons) == Approx(area(uncached.fill_expolygons)));
+            }
+        }
+    };
+
+    GIVEN("classic perimeter generator") {
+        test(PerimeterGeneratorType::Classic);
+    }
+    GIVEN("Arachne perimeter generator") {
+        test(PerimeterGeneratorType::Arachne);
+    }
+}
+
 SCENARIO("Perimeters3", "[Perimeters]")
 {
     auto config = Slic3r::DynamicPrintConfig::full_print_config_with({
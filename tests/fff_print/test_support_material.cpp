@@ -1,7 +1,11 @@
 #include <catch2/catch.hpp>
 
+#include "libslic3r/BuildVolume.hpp"
+#include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/GCodeReader.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/Support/TreeModelVolumes.hpp"
+#include "libslic3r/Support/TreeSupportCommon.hpp"
 
 #include "test_data.hpp" // get access to init_print, etc
 
@@ -119,6 +123,53 @@ SCENARIO("SupportMaterial: support_layers_z and contact_distance", "[SupportMate
     }
 }
 
+TEST_CASE("SupportMaterial: organic support caches are shrunk to the memory budget", "[SupportMaterial]")
+{
+    using namespace Slic3r::FFFTreeSupport;
+
+    Slic3r::Print print_unlimited, print_budget;
+    Slic3r::Test::init_and_process_print({ TestMesh::sphere_50mm }, print_unlimited, { { "support_tree_cache_memory_budget", 0 } });
+    Slic3r::Test::init_and_process_print({ TestMesh::sphere_50mm }, print_budget,    { { "support_tree_cache_memory_budget", 1 } });
+
+    const BuildVolume build_volume(Pointfs{ Vec2d{ -300., -300. }, Vec2d{ -300., +300. }, Vec2d{ +300., +300. }, Vec2d{ +300., -300. } }, 0.);
+    auto precalculate = [&build_volume](const PrintObject &object) {
+        const TreeSupportMeshGroupSettings mesh_settings{ object };
+        const TreeSupportSettings          config{ mesh_settings, object.slicing_parameters() };
+        auto volumes = std::make_unique<TreeModelVolumes>(object, build_volume, config.maximum_move_distance, config.maximum_move_distance_slow, 0);
+        volumes->precalculate(object, LayerIndex(object.layer_count()) - 1, []{});
+        return std::make_pair(std::move(volumes), config);
+    };
+    const PrintObject &object = *print_unlimited.objects().front();
+    auto [unlimited, config] = precalculate(object);
+    std::unique_ptr<TreeModelVolumes> budget = precalculate(*print_budget.objects().front()).first;
+    REQUIRE(object.config().support_tree_cache_memory_budget.value == 0);
+    REQUIRE(print_budget.objects().front()->config().support_tree_cache_memory_budget.value == 1);
+
+    THEN("Layers are released over the budget only") {
+        CHECK(! unlimited->cache_shrunk());
+        REQUIRE(budget->cache_shrunk());
+        CHECK(budget->cache_memory_peak() > 1024 * 1024);
+        CHECK(budget->cache_memory() < unlimited->cache_memory());
+    }
+    THEN("Released layers are recalculated to the same areas") {
+        auto same = [](const Polygons &l, const Polygons &r) {
+            return area(diff(l, r)) + area(diff(r, l)) < sqr(scaled<double>(0.01));
+        };
+        bool collisions_same = true;
+        bool avoidances_same = true;
+        // Query top down, as the tree supports are grown.
+        for (LayerIndex layer_idx = LayerIndex(object.layer_count()) - 1; layer_idx >= 0; -- layer_idx)
+            for (coord_t radius : { config.getRadius(0), config.getRadius(config.tip_layers), config.branch_radius }) {
+                collisions_same &= same(unlimited->getCollision(radius, layer_idx, true), budget->getCollision(radius, layer_idx, true));
+                for (bool to_model : { false, true })
+                    avoidances_same &= same(unlimited->getAvoidance(radius, layer_idx, TreeModelVolumes::AvoidanceType::Fast, to_model, true),
+                                            budget   ->getAvoidance(radius, layer_idx, TreeModelVolumes::AvoidanceType::Fast, to_model, true));
+            }
+        CHECK(collisions_same);
+        CHECK(avoidances_same);
+    }
+}
+
 #if 0
 // Test 8.
 TEST_CASE("SupportMaterial: forced support is generated", "[SupportMaterial]")
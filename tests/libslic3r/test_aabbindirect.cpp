@@ -1,9 +1,12 @@
 #include <algorithm>
+#include <random>
 #include <catch2/catch.hpp>
 #include <test_utils.hpp>
 
 #include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/AABBTreeCache.hpp>
 #include <libslic3r/AABBTreeIndirect.hpp>
+#include <libslic3r/AABBTreeIndirectWide.hpp>
 #include <libslic3r/AABBTreeLines.hpp>
 
 using namespace Slic3r;
@@ -61,6 +64,196 @@ TEST_CASE("Building a tree over a box, ray caster and closest query", "[AABBIndi
     REQUIRE(closest_point.z() == Approx(1.));
 }
 
+TEST_CASE("Tree over a large mesh built in parallel is consistent", "[AABBIndirect]")
+{
+    // Large enough for the subtrees to be built by parallel tasks.
+    indexed_triangle_set its = its_make_sphere(10., PI / 200.);
+    REQUIRE(its.indices.size() > 50000);
+
+    auto tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(its.vertices, its.indices);
+    const auto &nodes = tree.nodes();
+
+    std::vector<int> referenced(its.indices.size(), 0);
+    for (size_t i = 0; i < nodes.size(); ++ i) {
+        if (! nodes[i].is_valid())
+            continue;
+        if (i > 0) {
+            // Parent of a valid node is an inner node enclosing the node.
+            const auto &parent = nodes[(i - 1) / 2];
+            REQUIRE(parent.is_inner());
+            REQUIRE(parent.bbox.contains(nodes[i].bbox));
+        }
+        if (nodes[i].is_leaf()) {
+            const auto &face = its.indices[nodes[i].idx];
+            for (int j = 0; j < 3; ++ j)
+                REQUIRE(nodes[i].bbox.contains(its.vertices[face(j)]));
+            ++ referenced[nodes[i].idx];
+        } else {
+            REQUIRE(tree.left_child(i).is_valid());
+            REQUIRE(tree.right_child(i).is_valid());
+        }
+    }
+    // Each triangle is referenced by exactly one leaf.
+    REQUIRE(std::all_of(referenced.begin(), referenced.end(), [](int cnt) { return cnt == 1; }));
+}
+
+TEST_CASE("Wide tree gives the same answers as the binary tree", "[AABBIndirect]")
+{
+    indexed_triangle_set its = its_make_sphere(10., PI / 40.);
+    its_merge(its, its_make_cube(3., 40., 2.));
+
+    auto tree  = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(its.vertices, its.indices);
+    auto wtree = AABBTreeIndirect::build_wide_aabb_tree_over_indexed_triangle_set(its.vertices, its.indices);
+    REQUIRE(! wtree.empty());
+
+    const BoundingBoxf3 bb = bounding_box(its);
+    REQUIRE(wtree.bbox().min().cast<double>().isApprox(bb.min));
+    REQUIRE(wtree.bbox().max().cast<double>().isApprox(bb.max));
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> coord(-15., 15.);
+    std::normal_distribution<double> dir;
+
+    size_t num_hits = 0;
+    for (int i = 0; i < 2000; ++ i) {
+        Vec3d origin(coord(rng), coord(rng), coord(rng));
+        // Every fourth ray is axis aligned to exercise the infinite inverse directions.
+        Vec3d d = i % 4 == 0 ? Vec3d(0., 0., -1.) : Vec3d(Vec3d(dir(rng), dir(rng), dir(rng)).normalized());
+
+        igl::Hit hit, whit;
+        bool intersected  = AABBTreeIndirect::intersect_ray_first_hit(its.vertices, its.indices, tree, origin, d, hit);
+        bool wintersected = AABBTreeIndirect::intersect_ray_first_hit(its.vertices, its.indices, wtree, origin, d, whit);
+        REQUIRE(intersected == wintersected);
+        if (intersected) {
+            ++ num_hits;
+            REQUIRE(whit.t == Approx(hit.t));
+        }
+
+        std::vector<igl::Hit> hits, whits;
+        AABBTreeIndirect::intersect_ray_all_hits(its.vertices, its.indices, tree, origin, d, hits);
+        AABBTreeIndirect::intersect_ray_all_hits(its.vertices, its.indices, wtree, origin, d, whits);
+        REQUIRE(hits.size() == whits.size());
+        for (size_t k = 0; k < hits.size(); ++ k)
+            REQUIRE(whits[k].t == Approx(hits[k].t));
+
+        size_t idx, widx;
+        Vec3d  pt, wpt;
+        double dist  = AABBTreeIndirect::squared_distance_to_indexed_triangle_set(its.vertices, its.indices, tree, origin, idx, pt);
+        double wdist = AABBTreeIndirect::squared_distance_to_indexed_triangle_set(its.vertices, its.indices, wtree, origin, widx, wpt);
+        REQUIRE(wdist == Approx(dist));
+    }
+    REQUIRE(num_hits > 0);
+}
+
+TEST_CASE("Ray packets give the same hits as single rays", "[AABBIndirect]")
+{
+    indexed_triangle_set its = its_make_sphere(10., PI / 40.);
+    its_merge(its, its_make_cube(3., 40., 2.));
+    auto tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(its.vertices, its.indices);
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> coord(-15., 15.);
+    std::normal_distribution<double> dir;
+
+    for (double spread : { 0.05, 1. })
+        for (int i = 0; i < 200; ++ i) {
+            // A packet of rays sharing an origin, directions spread around a common axis.
+            Vec3d origin(coord(rng), coord(rng), coord(rng));
+            Vec3d axis = Vec3d(dir(rng), dir(rng), dir(rng)).normalized();
+            std::array<Vec3d, 8> dirs;
+            for (Vec3d &d : dirs)
+                d = (axis + spread * Vec3d(dir(rng), dir(rng), dir(rng))).normalized();
+
+            std::array<igl::Hit, 8> hits;
+            AABBTreeIndirect::intersect_ray_packet_first_hit(its.vertices, its.indices, tree, origin, dirs, hits);
+
+            for (size_t k = 0; k < dirs.size(); ++ k) {
+                igl::Hit hit;
+                bool intersected = AABBTreeIndirect::intersect_ray_first_hit(its.vertices, its.indices, tree, origin, dirs[k], hit);
+                REQUIRE(intersected == (hits[k].id >= 0));
+                if (intersected) {
+                    REQUIRE(hits[k].t == Approx(hit.t));
+                } else {
+                    REQUIRE(std::isinf(hits[k].t));
+                }
+            }
+        }
+}
+
+TEST_CASE("AABB trees are shared through AABBTreeCache", "[AABBIndirect]")
+{
+    AABBTreeCache::clear();
+    AABBTreeCache::set_memory_limit(size_t(512) << 20);
+    AABBTreeCache::Stats stats0 = AABBTreeCache::stats();
+
+    auto sphere = std::make_shared<const TriangleMesh>(its_make_sphere(10., PI / 40.));
+    auto cube   = std::make_shared<const TriangleMesh>(its_make_cube(1., 1., 1.));
+
+    auto tree1 = AABBTreeCache::tree(sphere);
+    auto tree2 = AABBTreeCache::tree(sphere);
+    REQUIRE(tree1 == tree2);
+    REQUIRE(tree1->nodes().size() == AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(sphere->its.vertices, sphere->its.indices).nodes().size());
+    REQUIRE(AABBTreeCache::tree(cube) != tree1);
+
+    AABBTreeCache::Stats stats = AABBTreeCache::stats();
+    REQUIRE(stats.hits == stats0.hits + 1);
+    REQUIRE(stats.misses == stats0.misses + 2);
+    REQUIRE(stats.entries == 2);
+    REQUIRE(stats.memory > 0);
+
+    SECTION("Transformed meshes are keyed by the transformation") {
+        int num_builds = 0;
+        auto build = [&](const Transform3d &trafo) {
+            return AABBTreeCache::mesh_tree(ObjectID(1), "test", trafo, { { cube, Transform3d::Identity() } }, [&]() {
+                ++ num_builds;
+                AABBTreeCache::MeshTree out;
+                out.its = cube->its;
+                its_transform(out.its, trafo);
+                out.tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(out.its.vertices, out.its.indices);
+                return out;
+            });
+        };
+        Transform3d moved = Transform3d::Identity();
+        moved.translate(Vec3d(10., 0., 0.));
+        auto a = build(Transform3d::Identity());
+        auto b = build(moved);
+        REQUIRE(build(Transform3d::Identity()) == a);
+        REQUIRE(a != b);
+        REQUIRE(num_builds == 2);
+        REQUIRE(b->its.vertices.front().x() == Approx(a->its.vertices.front().x() + 10.));
+    }
+
+    SECTION("Entry of a released mesh is dropped, the tree lives while used") {
+        sphere.reset();
+        auto tree3 = AABBTreeCache::tree(cube);
+        REQUIRE(AABBTreeCache::stats().entries == 1);
+        REQUIRE(! tree1->empty());
+    }
+
+    SECTION("Trees over indexed triangle sets are shared and dropped with the mesh") {
+        auto its = std::make_shared<const indexed_triangle_set>(its_make_cube(2., 2., 2.));
+        auto tree3 = AABBTreeCache::tree(its);
+        REQUIRE(AABBTreeCache::tree(its) == tree3);
+        REQUIRE(AABBTreeCache::stats().entries == 3);
+        its.reset();
+        REQUIRE(AABBTreeCache::stats().entries == 2);
+    }
+
+    SECTION("Least recently used entries are evicted over the memory limit") {
+        AABBTreeCache::tree(sphere);
+        AABBTreeCache::set_memory_limit(AABBTreeCache::stats().memory - 1);
+        stats = AABBTreeCache::stats();
+        REQUIRE(stats.entries == 1);
+        REQUIRE(stats.evictions == stats0.evictions + 1);
+        // The cube was used least recently.
+        REQUIRE(AABBTreeCache::tree(sphere) == tree1);
+    }
+
+    AABBTreeCache::set_memory_limit(size_t(512) << 20);
+    AABBTreeCache::clear();
+    REQUIRE(AABBTreeCache::stats().memory == 0);
+}
+
 TEST_CASE("Creating a several 2d lines, testing closest point query", "[AABBIndirect]")
 {
     std::vector<Linef> lines { };
@@ -743,4 +743,46 @@ TEST_CASE("Arachne - #10034 - Degenerated Voronoi diagram - That wasn't fixed by
 #ifdef ARACHNE_DEBUG_OUT
     export_perimeters_to_svg(debug_out_path("arachne-degenerated-diagram-10034-rotation-not-works.svg"), polygons, perimeters, union_ex(wall_tool_paths.getInnerContour()));
 #endif
-}
\ No newline at end of file
+}
+
+TEST_CASE("Arachne - Separate islands produce the same perimeters as a single island", "[ArachneSeparateIslands]") {
+    // Grid of squares with square holes, the islands are trapezoidated separately.
+    ExPolygon island;
+    island.contour = Polygon::new_scale({ { 0., 0. }, { 5., 0. }, { 5., 5. }, { 0., 5. } });
+    island.holes.emplace_back(Polygon::new_scale({ { 1.5, 1.5 }, { 1.5, 3.5 }, { 3.5, 3.5 }, { 3.5, 1.5 } }));
+
+    ExPolygons islands;
+    for (int i = 0; i < 4; ++ i)
+        for (int j = 0; j < 4; ++ j) {
+            islands.emplace_back(island);
+            islands.back().translate(scaled<coord_t>(i * 8.), scaled<coord_t>(j * 8.));
+        }
+
+    coord_t spacing     = 407079;
+    coord_t inset_count = 3;
+
+    auto generate = [spacing, inset_count](const Polygons &polygons) {
+        Arachne::WallToolPaths wall_tool_paths(polygons, spacing, spacing, inset_count, 0, 0.2, PrintObjectConfig::defaults(), PrintConfig::defaults());
+        return wall_tool_paths.getToolPaths();
+    };
+
+    auto length = [](const Arachne::VariableWidthLines &lines) {
+        double len = 0.;
+        for (const Arachne::ExtrusionLine &line : lines)
+            len += double(line.getLength());
+        return len;
+    };
+
+    std::vector<Arachne::VariableWidthLines> perimeters        = generate(to_polygons(islands));
+    std::vector<Arachne::VariableWidthLines> island_perimeters = generate(to_polygons(island));
+
+#ifdef ARACHNE_DEBUG_OUT
+    export_perimeters_to_svg(debug_out_path("arachne-separate-islands.svg"), to_polygons(islands), perimeters, {});
+#endif
+
+    REQUIRE(perimeters.size() == island_perimeters.size());
+    for (size_t inset_idx = 0; inset_idx < perimeters.size(); ++ inset_idx) {
+        CHECK(perimeters[inset_idx].size() == islands.size() * island_perimeters[inset_idx].size());
+        CHECK(length(perimeters[inset_idx]) == Approx(islands.size() * length(island_perimeters[inset_idx])));
+    }
+}
@@ -19,3 +19,85 @@ TEST_CASE("Hollow two overlapping spheres") {
     sphere1.WriteOBJFile("twospheres.obj");
 }
 
+
+TEST_CASE("Tiled hollowing should match hollowing in one piece", "[Hollowing]") {
+    using namespace Slic3r;
+
+    TriangleMesh sphere = make_sphere(20., 2 * PI / 40.);
+
+    sla::HollowingConfig hcfg;
+    sla::InteriorPtr interior = sla::generate_interior(sphere.its, hcfg);
+
+    // Small enough to process the sphere in several slabs
+    hcfg.max_tile_voxels = 8000000;
+    sla::InteriorPtr tiled = sla::generate_interior(sphere.its, hcfg);
+
+    REQUIRE(interior);
+    REQUIRE(tiled);
+
+    double vol = its_volume(sla::get_mesh(*interior));
+    REQUIRE(vol > 0.);
+    REQUIRE(its_volume(sla::get_mesh(*tiled)) == Approx(vol).epsilon(0.01));
+
+    // The slabs are stitched together without gaps and internal walls
+    REQUIRE(its_split(sla::get_mesh(*tiled)).size() == 1);
+    REQUIRE(its_num_open_edges(sla::get_mesh(*tiled)) == 0);
+}
+
+TEST_CASE("Drain holes are drilled into a tiled interior", "[Hollowing]") {
+    using namespace Slic3r;
+
+    TriangleMesh sphere = make_sphere(20., 2 * PI / 40.);
+
+    // The tiled interior has no grid
+    sla::HollowingConfig hcfg;
+    hcfg.max_tile_voxels = 8000000;
+    sla::InteriorPtr interior = sla::generate_interior(sphere.its, hcfg);
+
+    REQUIRE(interior);
+    REQUIRE(! sla::get_mesh(*interior).empty());
+
+    indexed_triangle_set hollowed = sphere.its;
+    sla::hollow_mesh(hollowed, *interior);
+    REQUIRE(its_split(hollowed).size() == 2);
+
+    // A hole through the wall at the top of the sphere
+    sla::DrainHoles holes{sla::DrainHole{Vec3f{0.f, 0.f, 21.f}, -Vec3f::UnitZ(), 3.f, 5.f}};
+    int ret = sla::hollow_mesh_and_drill(hollowed, *interior, holes);
+
+    REQUIRE((ret & int(sla::HollowMeshResult::DrillingFailed)) == 0);
+
+    // The cavity is open to the outside through the hole
+    REQUIRE(its_split(hollowed).size() == 1);
+}
+
+TEST_CASE("Tiled hollowing bounds the memory of the voxel grids", "[Hollowing]") {
+    using namespace Slic3r;
+
+    std::vector<csg::CSGPart> parts;
+    indexed_triangle_set cylinder = its_make_cylinder(20., 200.);
+    parts.emplace_back(&cylinder);
+
+    sla::HollowingConfig hcfg;
+
+    // Big enough to process the cylinder in one piece
+    hcfg.max_tile_voxels = std::numeric_limits<size_t>::max();
+    sla::TiledHollowingStats whole_stats;
+    sla::InteriorPtr whole = sla::generate_interior_tiled(parts, hcfg, {}, &whole_stats);
+
+    hcfg.max_tile_voxels    = 8000000;
+    hcfg.max_parallel_tiles = 2;
+    sla::TiledHollowingStats tiled_stats;
+    sla::InteriorPtr tiled = sla::generate_interior_tiled(parts, hcfg, {}, &tiled_stats);
+
+    REQUIRE(whole);
+    REQUIRE(tiled);
+    REQUIRE(whole_stats.tiles == 1);
+    REQUIRE(tiled_stats.tiles > 2 * hcfg.max_parallel_tiles);
+
+    // Only the grids of a batch of slabs are alive at once
+    REQUIRE(tiled_stats.peak_active_voxels <= hcfg.max_parallel_tiles * hcfg.max_tile_voxels);
+    REQUIRE(tiled_stats.peak_active_voxels < 0.6 * whole_stats.peak_active_voxels);
+
+    REQUIRE(its_volume(sla::get_mesh(*tiled)) == Approx(its_volume(sla::get_mesh(*whole))).epsilon(0.01));
+}
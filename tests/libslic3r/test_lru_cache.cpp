@@ -0,0 +1,85 @@
+#include <catch2/catch.hpp>
+
+#include <stdexcept>
+#include <string>
+
+#include "libslic3r/LRUCache.hpp"
+
+using namespace Slic3r;
+
+using Cache = LRUCache<int, std::string>;
+
+static size_t string_memsize(const int &, const std::string &s) { return s.size(); }
+
+TEST_CASE("LRUCache builds each value once and finds it afterwards", "[LRUCache]")
+{
+    Cache cache(1000, string_memsize);
+
+    int num_builds = 0;
+    auto build = [&num_builds]() { ++ num_builds; return std::string(10, 'a'); };
+
+    REQUIRE(cache.find(1) == nullptr);
+    Cache::ValuePtr a = cache.find_or_build(1, build);
+    REQUIRE(cache.find_or_build(1, build) == a);
+    REQUIRE(cache.find(1) == a);
+    REQUIRE(num_builds == 1);
+
+    // An inserted value does not replace the cached one.
+    REQUIRE(cache.insert(1, "b") == a);
+
+    Cache::Stats stats = cache.stats();
+    REQUIRE(stats.entries == 1);
+    REQUIRE(stats.memory == 10);
+    REQUIRE(stats.hits == 2);
+    REQUIRE(stats.misses == 2);
+
+    cache.clear();
+    REQUIRE(cache.stats().entries == 0);
+    REQUIRE(cache.stats().memory == 0);
+    REQUIRE(*a == std::string(10, 'a'));
+}
+
+TEST_CASE("LRUCache releases the least recently used values over the memory limit", "[LRUCache]")
+{
+    Cache cache(30, string_memsize);
+
+    for (int i = 0; i < 3; ++ i)
+        cache.insert(i, std::string(10, 'a'));
+    // 1 becomes the least recently used one.
+    cache.find(0);
+
+    cache.insert(3, std::string(10, 'a'));
+    REQUIRE(cache.find(1) == nullptr);
+    REQUIRE(cache.find(0) != nullptr);
+    REQUIRE(cache.stats().evictions == 1);
+
+    cache.set_memory_limit(10);
+    Cache::Stats stats = cache.stats();
+    REQUIRE(stats.entries == 1);
+    REQUIRE(stats.memory == 10);
+    REQUIRE(cache.find(0) != nullptr);
+}
+
+TEST_CASE("LRUCache drops the values of released dependencies", "[LRUCache]")
+{
+    Cache cache(1000, string_memsize);
+
+    auto data = std::make_shared<const int>(1);
+    cache.find_or_build(1, []() { return std::string("a"); }, { data });
+    cache.insert(2, "b");
+    REQUIRE(cache.stats().entries == 2);
+
+    data.reset();
+    REQUIRE(cache.stats().entries == 1);
+    REQUIRE(cache.find(1) == nullptr);
+}
+
+TEST_CASE("LRUCache forgets a value which failed to build", "[LRUCache]")
+{
+    Cache cache(1000, string_memsize);
+
+    REQUIRE_THROWS_AS(cache.find_or_build(1, []() -> std::string { throw std::runtime_error("failed"); }),
+                      std::runtime_error);
+    REQUIRE(cache.stats().entries == 0);
+    REQUIRE(*cache.find_or_build(1, []() { return std::string("a"); }) == "a");
+}
@@ -56,3 +56,30 @@ TEST_CASE("PNG read", "[PNG]") {
         REQUIRE(sum == rstsum);
     }
 }
+
+TEST_CASE("PNG encoded raster should decode to the same pixels", "[PNG]") {
+    // Tall enough to be split into several independently compressed blocks
+    sla::Resolution res{640, 2048};
+    sla::PixelDim   pixdim{1., 1.};
+    sla::RasterGrayscaleAA rst{res, pixdim, {}, agg::gamma_power(1.)};
+
+    ExPolygon poly;
+    poly.contour.points = {{scaled(10.), scaled(10.)}, {scaled(600.), scaled(100.)},
+                           {scaled(300.), scaled(2000.)}, {scaled(50.), scaled(1500.)}};
+    rst.draw(poly);
+
+    auto enc_rst = rst.encode(sla::PNGRasterEncoder{});
+    REQUIRE(Slic3r::png::is_png({enc_rst.data(), enc_rst.size()}));
+
+    png::ImageGreyscale img;
+    REQUIRE(png::decode_png({enc_rst.data(), enc_rst.size()}, img));
+    REQUIRE(img.rows == res.height_px);
+    REQUIRE(img.cols == res.width_px);
+
+    size_t mismatches = 0;
+    for (size_t r = 0; r < img.rows; ++r)
+        for (size_t c = 0; c < img.cols; ++c)
+            mismatches += img.get(r, c) != rst.read_pixel(c, r);
+
+    REQUIRE(mismatches == 0);
+}
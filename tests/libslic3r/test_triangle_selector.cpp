@@ -0,0 +1,133 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <array>
+
+#include <tbb/task_arena.h>
+
+#include "libslic3r/Model.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/TriangleSelector.hpp"
+
+using namespace Slic3r;
+
+// Sphere of 14400 triangles, thus exported and serialized in multiple chunks.
+static TriangleMesh painted_sphere_mesh()
+{
+    return make_sphere(50., 2. * PI / 120.);
+}
+
+// Paint spots of various states over the sphere with a splitting brush, paint some whole facets as well.
+static void paint_sphere(TriangleSelector &selector, const TriangleMesh &mesh)
+{
+    const EnforcerBlockerType states[] { EnforcerBlockerType::ENFORCER, EnforcerBlockerType::BLOCKER, EnforcerBlockerType::Extruder3 };
+    int istate = 0;
+    for (int facet_idx = 0; facet_idx < int(mesh.its.indices.size()); facet_idx += 499, ++ istate) {
+        const stl_triangle_vertex_indices &f = mesh.its.indices[facet_idx];
+        const Vec3f center = (mesh.its.vertices[f(0)] + mesh.its.vertices[f(1)] + mesh.its.vertices[f(2)]) / 3.f;
+        const Vec3f source = 2.f * center;
+        selector.select_patch(facet_idx, std::make_unique<TriangleSelector::Sphere>(center, source, 3.f, Transform3d::Identity(), TriangleSelector::ClippingPlane{}),
+            states[istate % 3], Transform3d::Identity(), true);
+    }
+    for (int facet_idx = 250; facet_idx < int(mesh.its.indices.size()); facet_idx += 997)
+        selector.set_facet(facet_idx, EnforcerBlockerType::BLOCKER);
+}
+
+static double its_area(const indexed_triangle_set &its)
+{
+    double area = 0.;
+    for (const stl_triangle_vertex_indices &f : its.indices)
+        area += 0.5 * (its.vertices[f(1)] - its.vertices[f(0)]).cast<double>().cross((its.vertices[f(2)] - its.vertices[f(0)]).cast<double>()).norm();
+    return area;
+}
+
+static bool its_equal(const indexed_triangle_set &l, const indexed_triangle_set &r)
+{
+    return l.indices == r.indices && l.vertices == r.vertices;
+}
+
+// The triangles of a selector restored by deserialize() are split in a different order than the painted ones,
+// thus the exported meshes hold the same triangles, but in a different order and with different vertex indices.
+static bool its_same_triangles(const indexed_triangle_set &l, const indexed_triangle_set &r)
+{
+    auto sorted_triangles = [](const indexed_triangle_set &its) {
+        std::vector<std::array<float, 9>> triangles;
+        triangles.reserve(its.indices.size());
+        for (const stl_triangle_vertex_indices &f : its.indices) {
+            std::array<float, 9> &t = triangles.emplace_back();
+            for (int i = 0; i < 3; ++ i)
+                for (int j = 0; j < 3; ++ j)
+                    t[3 * i + j] = its.vertices[f(i)](j);
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    };
+    return sorted_triangles(l) == sorted_triangles(r);
+}
+
+static const EnforcerBlockerType all_states[] { EnforcerBlockerType::NONE, EnforcerBlockerType::ENFORCER, EnforcerBlockerType::BLOCKER, EnforcerBlockerType::Extruder3 };
+
+TEST_CASE("TriangleSelector: painting survives serialization", "[TriangleSelector]")
+{
+    const TriangleMesh mesh = painted_sphere_mesh();
+    REQUIRE(mesh.its.indices.size() > 4096 * 3);
+    TriangleSelector selector(mesh);
+    paint_sphere(selector, mesh);
+
+    const auto data = selector.serialize();
+    TriangleSelector deserialized(mesh);
+    deserialized.deserialize(data);
+
+    THEN("Serialization of the deserialized selector gives the same data") {
+        const auto data2 = deserialized.serialize();
+        REQUIRE(data2.first == data.first);
+        REQUIRE(data2.second == data.second);
+    }
+    THEN("The deserialized selector exports the same facets") {
+        for (EnforcerBlockerType state : all_states) {
+            CHECK(TriangleSelector::has_facets(data, state) == selector.has_facets(state));
+            CHECK(deserialized.num_facets(state) == selector.num_facets(state));
+            CHECK(its_same_triangles(deserialized.get_facets(state), selector.get_facets(state)));
+            CHECK(its_same_triangles(deserialized.get_facets_strict(state), selector.get_facets_strict(state)));
+        }
+    }
+}
+
+TEST_CASE("TriangleSelector: exports do not depend on the number of threads", "[TriangleSelector]")
+{
+    const TriangleMesh mesh = painted_sphere_mesh();
+    TriangleSelector selector(mesh);
+    paint_sphere(selector, mesh);
+
+    double area = 0.;
+    double area_strict = 0.;
+    for (EnforcerBlockerType state : all_states) {
+        indexed_triangle_set facets, facets_strict;
+        std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> data;
+        tbb::task_arena serial(1);
+        serial.execute([&selector, state, &facets, &facets_strict, &data]() {
+            facets        = selector.get_facets(state);
+            facets_strict = selector.get_facets_strict(state);
+            data          = selector.serialize();
+        });
+        // All states were painted, some of them onto split facets.
+        REQUIRE(! facets.indices.empty());
+        CHECK(int(facets.indices.size()) == selector.num_facets(state));
+        CHECK(facets_strict.indices.size() >= facets.indices.size());
+        // A single thread takes the serial path, more threads export by chunks, even on a single core machine.
+        tbb::task_arena parallel(4);
+        parallel.execute([&selector, state, &facets, &facets_strict, &data]() {
+            CHECK(its_equal(selector.get_facets(state), facets));
+            CHECK(its_equal(selector.get_facets_strict(state), facets_strict));
+            CHECK(selector.serialize() == data);
+        });
+        area        += its_area(facets);
+        area_strict += its_area(facets_strict);
+    }
+
+    THEN("The facets of all states cover the mesh") {
+        const double mesh_area = its_area(mesh.its);
+        CHECK(area == Approx(mesh_area));
+        CHECK(area_strict == Approx(mesh_area));
+    }
+}
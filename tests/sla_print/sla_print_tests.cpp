@@ -2,12 +2,15 @@
 #include <random>
 #include <numeric>
 #include <cstdint>
+#include <cstring>
 
 #include "sla_test_utils.hpp"
 
 #include <libslic3r/TriangleMeshSlicer.hpp>
 #include <libslic3r/SLA/SupportTreeMesher.hpp>
 #include <libslic3r/BranchingTree/PointCloud.hpp>
+#include <libslic3r/SLA/BranchingTreeSLA.hpp>
+#include <libslic3r/SLA/ScanlineRaster.hpp>
 
 namespace {
 
@@ -186,6 +189,35 @@ TEST_CASE("BranchingSupports::FloorSupportsDoNotPierceModel", "[SLASupportGenera
         test_support_model_collision(fname, supportcfg);
 }
 
+TEST_CASE("BranchingSupports::PartitionedTreeIsDeterministic", "[SLASupportGeneration][Branching]") {
+    TriangleMesh mesh = load_model("extruder_idler.obj");
+
+    sla::SupportTreeConfig supportcfg;
+    supportcfg.tree_type                     = sla::SupportTreeType::Branching;
+    supportcfg.branching_tree_parallel       = true;
+    supportcfg.branching_tree_deterministic  = true;
+    // Small enough to route the support points in several partitions.
+    supportcfg.branching_tree_partition_size = 16;
+
+    sla::SupportableMesh sm{mesh.its, calc_support_pts(mesh), supportcfg};
+    REQUIRE(sm.pts.size() > 2 * supportcfg.branching_tree_partition_size);
+
+    auto build = [&sm]() {
+        sla::SupportTreeBuilder builder;
+        create_branching_tree(builder, sm);
+        return builder.retrieve_mesh(sla::MeshType::Support);
+    };
+
+    indexed_triangle_set first = build();
+    REQUIRE(! first.empty());
+
+    for (int run = 0; run < 3; ++run) {
+        indexed_triangle_set next = build();
+        REQUIRE(next.vertices == first.vertices);
+        REQUIRE(next.indices == first.indices);
+    }
+}
+
 TEST_CASE("InitializedRasterShouldBeNONEmpty", "[SLARasterOutput]") {
     // Default Prusa SL1 display parameters
     sla::Resolution res{2560, 1440};
@@ -251,6 +283,101 @@ TEST_CASE("RasterizedPolygonAreaShouldMatch", "[SLARasterOutput]") {
     REQUIRE(raster_pxsum(raster0) == 0);
 }
 
+TEST_CASE("ScanlineRasterShouldMatchAGG", "[SLARasterOutput]") {
+    double disp_w = 120., disp_h = 68.;
+    sla::Resolution res{2560, 1440};
+    sla::PixelDim pixdim{disp_w / res.width_px, disp_h / res.height_px};
+
+    auto bb = BoundingBox({0, 0}, {scaled(disp_w), scaled(disp_h)});
+    sla::RasterBase::Trafo trafo{sla::RasterBase::roPortrait, sla::RasterBase::MirrorX};
+    trafo.center_x = bb.center().x();
+    trafo.center_y = bb.center().y();
+    std::swap(res.width_px, res.height_px);
+    std::swap(pixdim.w_mm, pixdim.h_mm);
+
+    ExPolygons polys = {square_with_hole(10.), square_with_hole(30.)};
+    polys.front().translate(scaled(-20.), scaled(10.));
+    polys.back().translate(scaled(15.), scaled(-5.));
+
+    sla::RasterGrayscaleAAGammaPower agg(res, pixdim, trafo, 1.);
+    sla::RasterGrayscaleScanline scanline(res, pixdim, trafo, 1., 4);
+    for (const ExPolygon &poly : polys) {
+        agg.draw(poly);
+        scanline.draw(poly);
+    }
+
+    long agg_sum = 0, scanline_sum = 0;
+    for (size_t row = 0; row < res.height_px; ++row)
+        for (size_t col = 0; col < res.width_px; ++col) {
+            uint8_t a = agg.read_pixel(col, row), s = scanline.read_pixel(col, row);
+
+            // The two backends may only differ on the anti-aliased edges
+            REQUIRE(std::abs(int(a) - int(s)) < 128);
+            agg_sum += a;
+            scanline_sum += s;
+        }
+
+    REQUIRE(agg_sum > 0);
+    REQUIRE(std::abs(agg_sum - scanline_sum) < 0.001 * agg_sum);
+
+    SECTION("Even-odd fill rule makes overlapping polygons cancel out") {
+        sla::RasterGrayscaleScanline evenodd(res, pixdim, trafo, 0., 1,
+                                             sla::RasterGrayscaleScanline::frEvenOdd);
+        evenodd.draw(polys.back());
+        evenodd.draw(polys.back());
+
+        long sum = 0;
+        for (size_t row = 0; row < res.height_px; ++row)
+            for (size_t col = 0; col < res.width_px; ++col)
+                sum += evenodd.read_pixel(col, row);
+
+        REQUIRE(sum == 0);
+    }
+}
+
+TEST_CASE("IncrementalLayerDrawingShouldMatchFullDrawing", "[SLARasterOutput]") {
+    double disp_w = 120., disp_h = 68.;
+    sla::Resolution res{2560, 1440};
+    sla::PixelDim pixdim{disp_w / res.width_px, disp_h / res.height_px};
+
+    sla::RasterBase::Trafo trafo{sla::RasterBase::roLandscape, sla::RasterBase::MirrorY};
+    trafo.center_x = scaled(disp_w / 2.);
+    trafo.center_y = scaled(disp_h / 2.);
+
+    ExPolygons prev_polys = {square_with_hole(10.), square_with_hole(30.)};
+    prev_polys.front().translate(scaled(-20.), scaled(10.));
+    prev_polys.back().translate(scaled(15.), scaled(-5.));
+
+    // Only the small square moves
+    ExPolygons polys = prev_polys;
+    polys.front().translate(scaled(0.37), scaled(0.21));
+
+    auto check = [&](auto &&create_raster) {
+        std::unique_ptr<sla::RasterBase> full = create_raster(), prev = create_raster(),
+                                         incr = create_raster(), same = create_raster();
+
+        for (const ExPolygon &poly : polys)
+            full->draw(poly);
+
+        REQUIRE(sla::draw_layer(*prev, prev_polys) == sla::LayerDelta::Full);
+        REQUIRE(sla::draw_layer(*incr, polys, prev.get(), prev_polys) == sla::LayerDelta::Partial);
+        REQUIRE(sla::draw_layer(*same, prev_polys, prev.get(), prev_polys) == sla::LayerDelta::Unchanged);
+
+        sla::EncodedRaster full_enc = full->encode(sla::PPMRasterEncoder{});
+        sla::EncodedRaster incr_enc = incr->encode(sla::PPMRasterEncoder{});
+
+        REQUIRE(full_enc.size() == incr_enc.size());
+        REQUIRE(std::memcmp(full_enc.data(), incr_enc.data(), full_enc.size()) == 0);
+    };
+
+    SECTION("AGG raster") {
+        check([&] { return sla::create_raster_grayscale_aa(res, pixdim, 1., trafo); });
+    }
+
+    SECTION("Scanline raster") {
+        check([&] { return sla::create_raster_grayscale_scanline(res, pixdim, 1., trafo, 4); });
+    }
+}
 
 TEST_CASE("halfcone test", "[halfcone]") {
     sla::DiffBridge br{Vec3d{1., 1., 1.}, Vec3d{10., 10., 10.}, 0.25, 0.5};
@@ -261,6 +388,94 @@ TEST_CASE("halfcone test", "[halfcone]") {
     its_write_obj(m, "Halfcone.obj");
 }
 
+// Tessellation of the support tree elements one by one, as done before the element meshes were instanced from templates.
+static indexed_triangle_set reference_element_mesh(const sla::Head &h, size_t steps)
+{
+    indexed_triangle_set mesh = sla::pinhead(h.r_pin_mm, h.r_back_mm, h.width_mm, steps);
+    for (auto &p : mesh.vertices) p.z() -= (h.fullwidth() - h.r_back_mm);
+    auto quatern = Eigen::Quaternion<float>::FromTwoVectors(Vec3f{0.f, 0.f, -1.f}, h.dir.cast<float>());
+    Vec3f pos = h.pos.cast<float>();
+    for (auto &p : mesh.vertices) p = quatern * p + pos;
+    return mesh;
+}
+
+static indexed_triangle_set reference_element_mesh(const sla::Pillar &p, size_t steps)
+{
+    return p.height > EPSILON ? sla::halfcone(p.height, p.r_end, p.r_start, p.endpt, steps) : indexed_triangle_set{};
+}
+
+static indexed_triangle_set reference_element_mesh(const sla::Pedestal &p, size_t steps)
+{
+    return sla::halfcone(p.height, p.r_bottom, p.r_top, p.pos, steps);
+}
+
+static indexed_triangle_set reference_element_mesh(const sla::Junction &j, size_t steps)
+{
+    indexed_triangle_set mesh = sla::sphere(j.r, sla::make_portion(0, PI), 2 * PI / steps);
+    for (auto &p : mesh.vertices) p += j.pos.cast<float>();
+    return mesh;
+}
+
+static indexed_triangle_set reference_element_mesh(const sla::Bridge &br, size_t steps)
+{
+    Vec3d v = br.endp - br.startp;
+    indexed_triangle_set mesh = sla::cylinder(br.r, v.norm(), steps);
+    auto quater = Eigen::Quaternion<float>::FromTwoVectors(Vec3f{0.f, 0.f, 1.f}, v.normalized().cast<float>());
+    for (auto &p : mesh.vertices) p = quater * p + br.startp.cast<float>();
+    return mesh;
+}
+
+static indexed_triangle_set reference_element_mesh(const sla::DiffBridge &br, size_t steps)
+{
+    indexed_triangle_set mesh = sla::halfcone(br.get_length(), br.r, br.end_r, Vec3d::Zero(), steps);
+    auto quatern = Eigen::Quaternion<float>::FromTwoVectors(Vec3f{0.f, 0.f, 1.f}, br.get_dir().cast<float>());
+    for (auto &p : mesh.vertices) p = quatern * p + br.startp.cast<float>();
+    return mesh;
+}
+
+TEST_CASE("Merged support tree mesh holds all the element meshes", "[SupportTreeMesher]") {
+    const size_t steps = 45;
+    sla::SupportTreeBuilder builder;
+
+    builder.add_head(0, 0.5, 0.2, 1., 0.5, Vec3d{0., 0., -1.}, Vec3d{0., 0., 10.});
+    builder.add_head(1, 0.4, 0.2, 1., 0.5, Vec3d{1., 0., -1.}.normalized(), Vec3d{5., 0., 10.});
+    // Same dimensions as the first head, instanced from the same pinhead.
+    builder.add_head(2, 0.5, 0.2, 1., 0.5, Vec3d{0., 1., -1.}.normalized(), Vec3d{0., 5., 10.});
+    long pid = builder.add_pillar(Vec3d{0., 0., 0.}, 8., 0.5, 0.5);
+    builder.add_pillar_base(pid, 1., 2.);
+    builder.add_junction(Vec3d{0., 0., 8.}, 0.5);
+    builder.add_junction(Vec3d{5., 0., 8.}, 0.3);
+    builder.add_bridge(Vec3d{0., 0., 8.}, Vec3d{5., 0., 8.}, 0.4);
+    builder.add_crossbridge(Vec3d{0., 0., 4.}, Vec3d{0., 5., 6.}, 0.3);
+    builder.add_diffbridge(Vec3d{5., 0., 9.}, Vec3d{0., 0., 8.}, 0.3, 0.5);
+
+    // The elements in the order of SupportTreeBuilder::merged_mesh().
+    const sla::Pillar &pillar = builder.pillars()[size_t(pid)];
+    indexed_triangle_set expected;
+    for (const sla::Head &h : builder.heads())
+        its_merge(expected, reference_element_mesh(h, steps));
+    its_merge(expected, reference_element_mesh(pillar, steps));
+    its_merge(expected, reference_element_mesh(sla::Pedestal{pillar.endpt, 1., 2., pillar.r_start}, steps));
+    its_merge(expected, reference_element_mesh(sla::Junction{Vec3d{0., 0., 8.}, 0.5}, steps));
+    its_merge(expected, reference_element_mesh(sla::Junction{Vec3d{5., 0., 8.}, 0.3}, steps));
+    its_merge(expected, reference_element_mesh(sla::Bridge{Vec3d{0., 0., 8.}, Vec3d{5., 0., 8.}, 0.4}, steps));
+    its_merge(expected, reference_element_mesh(sla::Bridge{Vec3d{0., 0., 4.}, Vec3d{0., 5., 6.}, 0.3}, steps));
+    its_merge(expected, reference_element_mesh(sla::DiffBridge{Vec3d{5., 0., 9.}, Vec3d{0., 0., 8.}, 0.3, 0.5}, steps));
+    // merged_mesh() merges the duplicate vertices of the elements.
+    its_merge_vertices(expected);
+
+    const indexed_triangle_set &merged = builder.merged_mesh(steps);
+
+    REQUIRE(merged.indices.size() == expected.indices.size());
+    REQUIRE(merged.vertices.size() == expected.vertices.size());
+    CHECK(merged.indices == expected.indices);
+    float max_diff = 0.f;
+    for (size_t i = 0; i < merged.vertices.size(); ++i)
+        max_diff = std::max(max_diff, (merged.vertices[i] - expected.vertices[i]).cwiseAbs().maxCoeff());
+    // Only float rounding differences, for example of the scaled unit sphere of the junctions.
+    CHECK(max_diff < 1e-5f);
+}
+
 TEST_CASE("Test concurrency")
 {
     std::vector<double> vals = grid(0., 100., 10.);
@@ -6,6 +6,9 @@
 #include "libslic3r/Execution/ExecutionSeq.hpp"
 #include "libslic3r/SLA/SupportTreeUtils.hpp"
 #include "libslic3r/SLA/SupportTreeUtilsLegacy.hpp"
+#include "libslic3r/SLA/SupportTreeBuilder.hpp"
+#include "libslic3r/BranchingTree/BranchingTree.hpp"
+#include "libslic3r/BranchingTree/PointCloud.hpp"
 
 // Test pair hash for 'nums' random number pairs.
 template <class I, class II> void test_pairhash()
@@ -271,7 +274,7 @@ TEST_CASE("Find ground route just above ground", "[suptreeutils]") {
 
     sla::Junction j{Vec3d{0., 0., 2. * cfg.head_back_radius_mm}, cfg.head_back_radius_mm};
 
-    sla::SupportableMesh sm{{}, sla::SupportPoints{}, cfg};
+    sla::SupportableMesh sm{indexed_triangle_set{}, sla::SupportPoints{}, cfg};
 
     sla::GroundConnection conn =
         sla::deepsearch_ground_connection(ex_seq, sm, j, Geometry::spheric_to_dir(3 * PI/ 4, PI));
@@ -375,3 +378,162 @@ TEST_CASE("BranchingSupports::MergePointFinder", "[suptreeutils]") {
     }
 }
 
+
+// Every leaf is in exactly one group and the leafs of different groups of the
+// same kind are out of the merge reach of each other.
+static void check_leaf_partitions(const std::vector<Slic3r::branchingtree::Node> &leafs,
+                                  const Slic3r::branchingtree::LeafPartitions    &partitions,
+                                  float                                           reach)
+{
+    using namespace Slic3r;
+
+    std::vector<int> count(leafs.size(), 0);
+    for (const auto *groups : { &partitions.parts, &partitions.seams })
+        for (const std::vector<size_t> &group : *groups) {
+            REQUIRE(std::is_sorted(group.begin(), group.end()));
+            for (size_t idx : group)
+                ++ count[idx];
+        }
+
+    REQUIRE(std::all_of(count.begin(), count.end(), [](int c) { return c == 1; }));
+
+    for (const auto *groups : { &partitions.parts, &partitions.seams })
+        for (size_t i = 0; i < groups->size(); ++i)
+            for (size_t j = i + 1; j < groups->size(); ++j)
+                for (size_t a : (*groups)[i])
+                    for (size_t b : (*groups)[j])
+                        REQUIRE((leafs[a].pos.head<2>() - leafs[b].pos.head<2>()).norm() >= reach);
+}
+
+TEST_CASE("Support leafs out of merge reach are partitioned apart", "[suptreeutils][Branching]") {
+    using namespace Slic3r;
+
+    branchingtree::Properties props;
+    props.max_branch_length(5.);
+    const float reach = 2.f * float(props.max_branch_length());
+
+    // Three clusters of 5x5 leafs, 100 mm apart
+    std::vector<branchingtree::Node> leafs;
+    for (int x = 0; x < 15; ++x)
+        for (int y = 0; y < 5; ++y)
+            leafs.emplace_back(Vec3f{float(x / 5 * 100 + x % 5), float(y), 10.f});
+
+    branchingtree::LeafPartitions partitions = branchingtree::partition_leafs(leafs, props, 1000);
+
+    REQUIRE(partitions.parts.size() == 3);
+    REQUIRE(partitions.seams.empty());
+    for (const std::vector<size_t> &part : partitions.parts) {
+        REQUIRE(part.size() == 25);
+        for (size_t idx : part)
+            REQUIRE(int(leafs[idx].pos.x()) / 100 == int(leafs[part.front()].pos.x()) / 100);
+    }
+
+    check_leaf_partitions(leafs, partitions, reach);
+}
+
+TEST_CASE("Large groups of support leafs are split into tiles and seams", "[suptreeutils][Branching]") {
+    using namespace Slic3r;
+
+    branchingtree::Properties props;
+    props.max_branch_length(2.);
+    const float reach = 2.f * float(props.max_branch_length());
+
+    // A single group of 50x50 leafs, 2 mm apart
+    std::vector<branchingtree::Node> leafs;
+    for (int x = 0; x < 50; ++x)
+        for (int y = 0; y < 50; ++y)
+            leafs.emplace_back(Vec3f{2.f * x, 2.f * y, 10.f + 0.1f * float((x * 7 + y * 3) % 10)});
+
+    branchingtree::LeafPartitions partitions = branchingtree::partition_leafs(leafs, props, 100);
+
+    REQUIRE(partitions.parts.size() > 1);
+    REQUIRE(! partitions.seams.empty());
+    check_leaf_partitions(leafs, partitions, reach);
+
+    // The partitions only depend on the input.
+    branchingtree::LeafPartitions again = branchingtree::partition_leafs(leafs, props, 100);
+    REQUIRE(again.parts == partitions.parts);
+    REQUIRE(again.seams == partitions.seams);
+
+    // A partition size above the leaf count keeps the group in one piece.
+    branchingtree::LeafPartitions whole = branchingtree::partition_leafs(leafs, props, leafs.size());
+    REQUIRE(whole.parts.size() == 1);
+    REQUIRE(whole.seams.empty());
+}
+
+TEST_CASE("Seam support leafs end on the branches routed before", "[suptreeutils][Branching]") {
+    using namespace Slic3r;
+
+    branchingtree::Properties props;
+    props.max_branch_length(5.);
+
+    // A leaf above a branch point, another branch point out of reach. There
+    // is no model and no bed to end on.
+    std::vector<branchingtree::Node> leafs = { branchingtree::Node{Vec3f{0.f, 0.f, 10.f}, 0.2f} };
+    std::vector<branchingtree::Node> branchpts = { branchingtree::Node{Vec3f{0.f, 0.f, 8.f}, 0.5f},
+                                                   branchingtree::Node{Vec3f{50.f, 0.f, 8.f}, 0.5f} };
+
+    branchingtree::PointCloud nodes = branchingtree::make_partition_cloud({}, {}, leafs, { 0 }, props, branchpts);
+    REQUIRE(nodes.get_meshpoints().size() == 1);
+    const int branchpt_id = nodes.get_meshpoints().front().id;
+    REQUIRE(nodes.is_branch_point(branchpt_id));
+
+    struct JoinRecorder : public branchingtree::Builder {
+        const branchingtree::PointCloud &cloud;
+        std::vector<int> joined;
+        size_t           unroutable = 0;
+
+        JoinRecorder(const branchingtree::PointCloud &c) : cloud{c} {}
+
+        bool add_bridge(const branchingtree::Node &, const branchingtree::Node &) override { return false; }
+        bool add_merger(const branchingtree::Node &, const branchingtree::Node &, const branchingtree::Node &) override { return false; }
+        bool add_ground_bridge(const branchingtree::Node &, const branchingtree::Node &) override { return false; }
+        bool add_mesh_bridge(const branchingtree::Node &, const branchingtree::Node &to) override
+        {
+            if (cloud.is_branch_point(to.id))
+                joined.emplace_back(to.id);
+            return cloud.is_branch_point(to.id);
+        }
+        void report_unroutable(const branchingtree::Node &) override { ++unroutable; }
+    } recorder{nodes};
+
+    branchingtree::build_tree(nodes, recorder);
+
+    REQUIRE(recorder.joined == std::vector<int>{ branchpt_id });
+    REQUIRE(recorder.unroutable == 0);
+}
+
+TEST_CASE("Merged support tree builders hold the elements of both", "[suptreeutils]") {
+    using namespace Slic3r;
+
+    auto add_elements = [](sla::SupportTreeBuilder &builder, double x) {
+        long pid = builder.add_pillar(Vec3d{x, 0., 0.}, 8., 0.5, 0.5);
+        builder.add_pillar_base(pid, 1., 2.);
+        builder.add_junction(Vec3d{x, 0., 8.}, 0.5);
+        builder.add_bridge(Vec3d{x, 0., 8.}, Vec3d{x + 5., 0., 8.}, 0.4);
+        builder.add_crossbridge(Vec3d{x, 0., 4.}, Vec3d{x + 5., 0., 6.}, 0.3);
+        builder.add_diffbridge(Vec3d{x + 5., 0., 9.}, Vec3d{x, 0., 8.}, 0.3, 0.5);
+    };
+
+    sla::SupportTreeBuilder merged, other, reference;
+    add_elements(merged, 0.);
+    add_elements(other, 20.);
+    add_elements(reference, 0.);
+    add_elements(reference, 20.);
+
+    merged.merge(std::move(other));
+
+    REQUIRE(merged.pillars().size() == reference.pillars().size());
+    REQUIRE(merged.bridges().size() == reference.bridges().size());
+    REQUIRE(merged.crossbridges().size() == reference.crossbridges().size());
+    for (size_t i = 0; i < merged.pillars().size(); ++i)
+        REQUIRE(merged.pillars()[i].id == long(i));
+    for (size_t i = 0; i < merged.bridges().size(); ++i)
+        REQUIRE(merged.bridges()[i].id == long(i));
+
+    const indexed_triangle_set &mesh     = merged.merged_mesh(45);
+    const indexed_triangle_set &ref_mesh = reference.merged_mesh(45);
+    REQUIRE(! mesh.empty());
+    REQUIRE(mesh.vertices == ref_mesh.vertices);
+    REQUIRE(mesh.indices == ref_mesh.indices);
+}
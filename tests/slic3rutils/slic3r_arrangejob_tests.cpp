@@ -29,6 +29,7 @@ public:
         m_v.geom_handling = static_cast<GeometryHandling>(dist(m_rng) % ghCount);
         m_v.arr_strategy  = static_cast<ArrangeStrategy>(dist(m_rng) % asCount);
         m_v.xl_align      = static_cast<XLPivots>(dist(m_rng) % xlpCount);
+        m_v.incremental   = bdist(m_rng);
     }
     explicit RandomArrangeSettings() : m_rng(std::random_device{} ()) {}
 
@@ -38,6 +39,7 @@ public:
     XLPivots get_xl_alignment() const override { return m_v.xl_align; }
     GeometryHandling get_geometry_handling() const override { return m_v.geom_handling; }
     ArrangeStrategy get_arrange_strategy() const override { return m_v.arr_strategy; }
+    bool is_incremental() const override { return m_v.incremental; }
 };
 
 TEMPLATE_TEST_CASE("Arranging empty bed should do nothing",